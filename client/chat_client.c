@@ -59,11 +59,11 @@ void client_set_user_id(ChatClient *client) {
 
     printf("[Client] 닉네임 설정: %s\n", client->user_id);
 
-    // 서버에 ID 패킷 전송
+    // 서버에 ID 패킷 전송 (협상한 프레임 버전/코덱 사용)
     printf("[DEBUG] send_packet: id='%s', len=%zu\n", client->user_id, strlen(client->user_id));
     fflush(stdout);
-    ssize_t sent = send_packet(client->sockfd, REQ_MAGIC, PACKET_TYPE_SET_ID, client->user_id, (uint16_t)strlen(client->user_id));
-    printf("[DEBUG] send_packet return: %zd\n", sent);
+    int sent = client_send_packet(client, PACKET_TYPE_SET_ID, client->user_id, (uint16_t)strlen(client->user_id));
+    printf("[DEBUG] send_packet return: %d\n", sent);
     fflush(stdout);
 }
 
@@ -74,7 +74,57 @@ int client_send_packet(ChatClient *client, uint8_t type, const void *data, uint1
         return 0;
     }
     
-    return send_packet(client->sockfd, REQ_MAGIC, type, data, data_len);
+    if (client->proto_version < 2) {
+        return send_packet(client->sockfd, REQ_MAGIC, type, data, data_len) >= 0;
+    }
+    return send_packet_v2(client->sockfd, REQ_MAGIC, type, data, data_len, client->codec) >= 0;
+}
+
+// 연결 협상 함수 - HELLO로 지원 범위를 보내고 HELLO_ACK를 기다림 (기다리는 동안 받은 공지 등은 그대로 출력)
+// 응답이 없으면 v1/XOR로 계속 진행, 연결이 끊기면 0 반환
+int client_negotiate(ChatClient *client, const HelloInfo *offer) {
+    unsigned char payload[HELLO_PAYLOAD_LEN];
+    hello_encode(offer, payload);
+    if (send_packet(client->sockfd, REQ_MAGIC, PACKET_TYPE_HELLO, payload, sizeof(payload)) < 0) {
+        perror("[Client] HELLO 전송 실패");
+        return 0;
+    }
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (!client->negotiated) {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        long elapsed = (now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000;
+        if (elapsed >= HELLO_TIMEOUT_MS) {
+            printf("[Client] 서버가 협상에 응답하지 않아 v1 프레임으로 계속합니다.\n");
+            return 1;
+        }
+        struct pollfd pfd = { .fd = client->sockfd, .events = POLLIN };
+        int ret = poll(&pfd, 1, (int)(HELLO_TIMEOUT_MS - elapsed));
+        if (ret < 0 && errno == EINTR) continue;
+        if (ret < 0) {
+            perror("[Client] poll 오류");
+            return 0;
+        }
+        if (ret > 0 && !client_receive_message(client)) return 0;
+    }
+    return 1;
+}
+
+// 협상 응답 적용 함수 - 합의한 버전/코덱으로 이후 프레임 송신
+static void client_apply_hello(ChatClient *client, const unsigned char *data, uint32_t data_len) {
+    HelloInfo agreed;
+    if (client->negotiated || hello_decode(data, data_len, &agreed) < 0) {
+        fprintf(stderr, "[Client] 잘못된 협상 응답을 무시합니다.\n");
+        return;
+    }
+    client->negotiated = 1;
+    client->proto_version = agreed.version;
+    client->codec = hello_codec(&agreed);
+    printf("[Client] 협상 완료: v%d 프레임, %s 체크섬, 최대 메시지 %u바이트%s%s\n",
+           agreed.version, agreed.checksums == HELLO_CHECKSUM_CRC32C ? "CRC32C" : "XOR",
+           agreed.max_message, (agreed.features & HELLO_FEATURE_BATCH) ? ", 묶음 전송" : "",
+           agreed.compression == HELLO_COMPRESS_LZ4 ? ", LZ4 압축" : "");
 }
 
 // 서버로 메시지(일반 채팅)를 패킷 전송 함수
@@ -134,29 +184,10 @@ int client_send_message(ChatClient *client, const char *message) {
     return client_send_packet(client, PACKET_TYPE_MESSAGE, message, (uint16_t)msg_len);
 }
 
-// 서버로부터 패킷 수신 및 처리 함수 - 읽기 성공 시 1, 서버가 연결을 종료했거나 오류 시 0을 반환
-int client_receive_message(ChatClient *client) {
-    PacketHeader header;
-    unsigned char data_buffer[BUFFER_SIZE];
-    ssize_t n = recv_all(client->sockfd, &header, sizeof(PacketHeader));
-    if (n <= 0) {
-        perror("[Client] recv_all 오류");
-        return 0;
-    }
-    header.magic = ntohs(header.magic);
-    header.data_len = ntohs(header.data_len);
-    if (header.data_len > 0) {
-        recv_all(client->sockfd, data_buffer, header.data_len);
-        data_buffer[header.data_len] = '\0'; 
-    }
-    unsigned char checksum;
-    if (recv_all(client->sockfd, &checksum, 1) <= 0) {
-        perror("[Client] 체크섬 수신 오류");
-        return 0;
-    }
-
+// 수신한 패킷 1개 처리 함수
+static void client_handle_frame(ChatClient *client, const FrameHeader *hdr, const unsigned char *data_buffer) {
     // 패킷 타입별 처리
-    switch (header.type) {
+    switch (hdr->type) {
         case PACKET_TYPE_MESSAGE: 
         case PACKET_TYPE_HELP:
         case PACKET_TYPE_LIST_USERS:
@@ -213,12 +244,46 @@ int client_receive_message(ChatClient *client) {
         case PACKET_TYPE_ERROR:
             printf("[Server Error] %s\n", data_buffer);
             break;
+        case PACKET_TYPE_PING:
+            client_send_packet(client, PACKET_TYPE_PONG, NULL, 0); // 하트비트 응답 (출력 없음)
+            break;
+        case PACKET_TYPE_HELLO_ACK:
+            client_apply_hello(client, data_buffer, hdr->data_len);
+            break;
         default:
-            fprintf(stderr, "[Client] 알 수 없는 패킷 타입: %d\n", header.type);
+            fprintf(stderr, "[Client] 알 수 없는 패킷 타입: %d\n", hdr->type);
             break;
     }
+}
+
+// 서버로부터 패킷 수신 및 처리 함수 - 읽기 성공 시 1, 서버가 연결을 종료했거나 오류 시 0을 반환
+// 한 번에 최대 FRAME_READ_BUFFER_SIZE 바이트를 읽고, 완성된 패킷을 모두 처리 (나머지는 디코더가 보관)
+int client_receive_message(ChatClient *client) {
+    static unsigned char recv_buf[FRAME_READ_BUFFER_SIZE];
+    ssize_t n;
+    do {
+        n = recv(client->sockfd, recv_buf, sizeof(recv_buf), 0);
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        if (n < 0) perror("[Client] recv 오류");
+        return 0;
+    }
+
+    Frame frame;
+    int ret;
+    frame_decoder_feed(&client->decoder, recv_buf, (size_t)n);
+    while ((ret = frame_decoder_next(&client->decoder, &frame)) > 0) {
+        if (!frame.checksum_ok) {
+            // 깨진 프레임은 처리하지 않고 버림
+            fprintf(stderr, "[Client] 체크섬이 일치하지 않는 패킷을 버렸습니다 (타입 %d, 누적 %lu개).\n",
+                    frame.hdr.type, ++client->checksum_errors);
+            continue;
+        }
+        client_handle_frame(client, &frame.hdr, frame.data);
+        if (client->state != STATE_CONNECTED) break; // 계정 삭제/종료로 소켓이 닫힘
+    }
     fflush(stdout);
-    return 1;
+    return ret >= 0 && client->state == STATE_CONNECTED;
 }
 
 // 이벤트 루프 함수 - 입력(stdin)과 서버 소켓(sockfd)을 select()로 감시 및 사용자 입력이 있으면 서버로 전송, 서버 응답이 있으면 화면에 출력
@@ -282,6 +347,7 @@ void client_cleanup(ChatClient *client) {
         client->state = STATE_DISCONNECTED;
         printf("[Client] 소켓을 닫고 종료합니다.\n");
     }
+    frame_decoder_free(&client->decoder);
 }
 
 // ===== 메인 함수 =====
@@ -304,9 +370,26 @@ int main(int argc, char *argv[]) {
 
     client.state = STATE_DISCONNECTED;
     memset(client.user_id, 0, sizeof(client.user_id));
+    frame_decoder_init(&client.decoder);
+    client.proto_version = 1; // 협상 전에는 모든 서버가 읽을 수 있는 v1 프레임
+    client.codec = 0;
+    client.negotiated = 0;
+    client.checksum_errors = 0;
 
-    // 서버 연결 시도
-    if (!client_connect_to_server(&client, server_ip, server_port)) {
+    // 지원 범위 - CHAT_CHECKSUM=xor이면 CRC32C를, CHAT_COMPRESS=off이면 압축을 제안하지 않음
+    const char *checksum = getenv("CHAT_CHECKSUM");
+    const char *compress = getenv("CHAT_COMPRESS");
+    HelloInfo offer = {
+        .version = PACKET_VERSION_MAX,
+        .checksums = HELLO_CHECKSUM_XOR | ((checksum && strcmp(checksum, "xor") == 0) ? 0 : HELLO_CHECKSUM_CRC32C),
+        .compression = (compress && strcmp(compress, "off") == 0) ? 0 : HELLO_COMPRESS_LZ4,
+        .features = HELLO_FEATURE_BATCH | HELLO_FEATURE_PING,
+        .max_message = PACKET_MAX_MESSAGE,
+    };
+
+    // 서버 연결 및 협상
+    if (!client_connect_to_server(&client, server_ip, server_port) || !client_negotiate(&client, &offer)) {
+        client_cleanup(&client);
         return EXIT_FAILURE;
     }
 
@@ -10,11 +10,14 @@
 #include <sys/types.h>
 #include <sys/select.h>
 #include <errno.h>
+#include <poll.h>
+#include <time.h>
 #include "../common/chat_protocol.h"
 
 #define SERVER_IP   "127.0.0.1"   // 기본 서버 IP (필요에 따라 변경)
 #define SERVER_PORT 9000          // 기본 서버 포트 (필요에 따라 변경)
 #define BUFFER_SIZE 2048          // 송수신 버퍼 크기
+#define HELLO_TIMEOUT_MS 2000     // 연결 협상 응답 대기 시간 (넘으면 v1/XOR로 계속)
 
 // 클라이언트 상태를 나타내는 enum
 typedef enum {
@@ -27,6 +30,11 @@ typedef struct {
     int sockfd;                  // 서버와 연결된 소켓 디스크립터
     ClientState state;           // 현재 연결 상태
     char user_id[20];            // 사용자 ID (닉네임)
+    FrameDecoder decoder;        // 수신 프레임 증분 디코더
+    int proto_version;           // 송신 프레임 버전 (HELLO로 합의, 협상 전/실패 시 1)
+    uint8_t codec;               // 송신 프레임 코덱 플래그 (HELLO로 합의한 체크섬/압축, 서버도 같은 방식으로 응답)
+    int negotiated;              // HELLO_ACK 수신 여부
+    unsigned long checksum_errors; // 체크섬이 틀려 버린 수신 프레임 수
 } ChatClient;
 
 // ===== 함수 프로토타입 =====
@@ -37,6 +45,9 @@ typedef struct {
 // 서버에 연결 시도
 int client_connect_to_server(ChatClient *client, const char *server_ip, int server_port);
 
+// 서버와 프로토콜 버전/체크섬/최대 메시지 길이 협상 (HELLO → HELLO_ACK)
+int client_negotiate(ChatClient *client, const HelloInfo *offer);
+
 // 사용자로부터 닉네임 입력 받아 설정
 void client_set_user_id(ChatClient *client);
 
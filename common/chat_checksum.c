@@ -0,0 +1,276 @@
+#include <string.h>
+#include <pthread.h>
+#include "chat_checksum.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CHECKSUM_HAVE_X86 1
+#endif
+
+#define CRC32C_POLY_REFLECTED 0x82F63B78u // 0x1EDC6F41의 비트 역순
+#define XOR_SIMD_MIN_LEN      64          // 이보다 짧으면 SIMD 레지스터 준비/접기 비용이 커서 8바이트 정수 방식 사용
+
+typedef unsigned char (*XorFn)(const unsigned char *p, size_t len);
+typedef uint32_t (*Crc32cFn)(uint32_t crc, const unsigned char *p, size_t len);
+
+// ================== 전역 변수 ===================
+static uint32_t g_crc32c_table[8][256];  // 8바이트 단위(slicing-by-8) 계산용 테이블
+static XorFn g_xor_fn;                   // 선택된 XOR 구현 (초기화 후 원자적으로 게시)
+static const char *g_xor_name = "scalar";
+static Crc32cFn g_crc32c_fn;             // 선택된 CRC32C 구현 (초기화 후 원자적으로 게시)
+static const char *g_crc32c_name = "table";
+static pthread_once_t g_checksum_once = PTHREAD_ONCE_INIT;
+
+// ============ XOR: 8바이트 정수 방식 ============
+// 64비트 누적값을 1바이트로 접는 함수
+static inline unsigned char xor_fold64(uint64_t v) {
+    v ^= v >> 32;
+    v ^= v >> 16;
+    v ^= v >> 8;
+    return (unsigned char)v;
+}
+
+// 8바이트씩 XOR한 뒤 남은 바이트 처리 (SIMD 구현의 꼬리 처리에도 사용)
+static unsigned char xor_scalar(const unsigned char *p, size_t len) {
+    uint64_t acc = 0;
+    while (len >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        acc ^= v;
+        p += 8;
+        len -= 8;
+    }
+    unsigned char cs = xor_fold64(acc);
+    while (len-- > 0) {
+        cs ^= *p++;
+    }
+    return cs;
+}
+
+#ifdef CHECKSUM_HAVE_X86
+// ============ XOR: SSE2 방식 ============
+// 16바이트 레지스터 4개에 64바이트씩 누적 (의존성 분산), 마지막에 64비트로 접음
+__attribute__((target("sse2")))
+static unsigned char xor_sse2(const unsigned char *p, size_t len) {
+    if (len < XOR_SIMD_MIN_LEN) return xor_scalar(p, len);
+    __m128i a0 = _mm_setzero_si128(), a1 = a0, a2 = a0, a3 = a0;
+    while (len >= 64) {
+        a0 = _mm_xor_si128(a0, _mm_loadu_si128((const __m128i *)p));
+        a1 = _mm_xor_si128(a1, _mm_loadu_si128((const __m128i *)(p + 16)));
+        a2 = _mm_xor_si128(a2, _mm_loadu_si128((const __m128i *)(p + 32)));
+        a3 = _mm_xor_si128(a3, _mm_loadu_si128((const __m128i *)(p + 48)));
+        p += 64;
+        len -= 64;
+    }
+    while (len >= 16) {
+        a0 = _mm_xor_si128(a0, _mm_loadu_si128((const __m128i *)p));
+        p += 16;
+        len -= 16;
+    }
+    __m128i acc = _mm_xor_si128(_mm_xor_si128(a0, a1), _mm_xor_si128(a2, a3));
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, acc);
+    return xor_fold64(lanes[0] ^ lanes[1]) ^ xor_scalar(p, len);
+}
+
+// ============ XOR: AVX2 방식 ============
+// 32바이트 레지스터 4개에 128바이트씩 누적, 마지막에 128 -> 64비트로 접음
+__attribute__((target("avx2")))
+static unsigned char xor_avx2(const unsigned char *p, size_t len) {
+    if (len < XOR_SIMD_MIN_LEN) return xor_scalar(p, len);
+    __m256i a0 = _mm256_setzero_si256(), a1 = a0, a2 = a0, a3 = a0;
+    while (len >= 128) {
+        a0 = _mm256_xor_si256(a0, _mm256_loadu_si256((const __m256i *)p));
+        a1 = _mm256_xor_si256(a1, _mm256_loadu_si256((const __m256i *)(p + 32)));
+        a2 = _mm256_xor_si256(a2, _mm256_loadu_si256((const __m256i *)(p + 64)));
+        a3 = _mm256_xor_si256(a3, _mm256_loadu_si256((const __m256i *)(p + 96)));
+        p += 128;
+        len -= 128;
+    }
+    while (len >= 32) {
+        a0 = _mm256_xor_si256(a0, _mm256_loadu_si256((const __m256i *)p));
+        p += 32;
+        len -= 32;
+    }
+    __m256i acc = _mm256_xor_si256(_mm256_xor_si256(a0, a1), _mm256_xor_si256(a2, a3));
+    __m128i half = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *)lanes, half);
+    return xor_fold64(lanes[0] ^ lanes[1]) ^ xor_scalar(p, len);
+}
+#endif
+
+// ============ CRC32C: 테이블 방식 ============
+// 바이트 단위로 시작/끝을 처리하고 가운데는 8바이트씩 테이블 8개를 조회
+static uint32_t crc32c_table(uint32_t crc, const unsigned char *p, size_t len) {
+    while (len > 0 && ((uintptr_t)p & 7) != 0) {
+        crc = g_crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+        len--;
+    }
+    while (len >= 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        lo = __builtin_bswap32(lo);
+        hi = __builtin_bswap32(hi);
+#endif
+        lo ^= crc;
+        crc = g_crc32c_table[7][lo & 0xff] ^ g_crc32c_table[6][(lo >> 8) & 0xff] ^
+              g_crc32c_table[5][(lo >> 16) & 0xff] ^ g_crc32c_table[4][lo >> 24] ^
+              g_crc32c_table[3][hi & 0xff] ^ g_crc32c_table[2][(hi >> 8) & 0xff] ^
+              g_crc32c_table[1][(hi >> 16) & 0xff] ^ g_crc32c_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len-- > 0) {
+        crc = g_crc32c_table[0][(crc ^ *p++) & 0xff] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef CHECKSUM_HAVE_X86
+// ============ CRC32C: SSE4.2 방식 ============
+// crc32 명령으로 계산 (64비트에서는 8바이트씩, 32비트에서는 4바이트씩)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const unsigned char *p, size_t len) {
+    while (len > 0 && ((uintptr_t)p & 7) != 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+        len--;
+    }
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    while (len >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+        p += 8;
+        len -= 8;
+    }
+    crc = (uint32_t)crc64;
+#endif
+    while (len >= 4) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        len -= 4;
+    }
+    while (len-- > 0) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+#endif
+
+// ============ 구현 선택 ============
+// 이름으로 XOR 구현 선택 함수 (NULL이면 CPU가 지원하는 가장 빠른 구현) - 지원하지 않으면 -1
+static int xor_select(const char *name) {
+    XorFn fn = xor_scalar;
+    const char *chosen = "scalar";
+#ifdef CHECKSUM_HAVE_X86
+    int avx2 = __builtin_cpu_supports("avx2");
+    int sse2 = __builtin_cpu_supports("sse2");
+    if ((!name && avx2) || (name && strcmp(name, "avx2") == 0)) {
+        if (!avx2) return -1;
+        fn = xor_avx2;
+        chosen = "avx2";
+    } else if ((!name && sse2) || (name && strcmp(name, "sse2") == 0)) {
+        if (!sse2) return -1;
+        fn = xor_sse2;
+        chosen = "sse2";
+    }
+#endif
+    if (name && strcmp(name, chosen) != 0) return -1;
+    g_xor_name = chosen;
+    __atomic_store_n(&g_xor_fn, fn, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// 이름으로 CRC32C 구현 선택 함수 (NULL이면 CPU가 지원하는 가장 빠른 구현) - 지원하지 않으면 -1
+static int crc32c_select(const char *name) {
+    Crc32cFn fn = crc32c_table;
+    const char *chosen = "table";
+#ifdef CHECKSUM_HAVE_X86
+    int sse42 = __builtin_cpu_supports("sse4.2");
+    if ((!name && sse42) || (name && strcmp(name, "sse4.2") == 0)) {
+        if (!sse42) return -1;
+        fn = crc32c_sse42;
+        chosen = "sse4.2";
+    }
+#endif
+    if (name && strcmp(name, chosen) != 0) return -1;
+    g_crc32c_name = chosen;
+    __atomic_store_n(&g_crc32c_fn, fn, __ATOMIC_RELEASE);
+    return 0;
+}
+
+// 테이블 생성 및 구현 선택 함수 (pthread_once로 한 번만 실행)
+static void checksum_init(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) {
+            c = (c & 1) ? (c >> 1) ^ CRC32C_POLY_REFLECTED : c >> 1;
+        }
+        g_crc32c_table[0][i] = c;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int t = 1; t < 8; t++) {
+            uint32_t prev = g_crc32c_table[t - 1][i];
+            g_crc32c_table[t][i] = g_crc32c_table[0][prev & 0xff] ^ (prev >> 8);
+        }
+    }
+
+#ifdef CHECKSUM_HAVE_X86
+    __builtin_cpu_init();
+#endif
+    xor_select(NULL);
+    crc32c_select(NULL);
+}
+
+// ============ 외부 인터페이스 ============
+// XOR 체크섬 계산 함수 - 프레임마다 호출되므로 초기화 후에는 함수 포인터 읽기만 수행
+unsigned char xor_checksum(const void *data, size_t len) {
+    XorFn fn = __atomic_load_n(&g_xor_fn, __ATOMIC_ACQUIRE);
+    if (!fn) {
+        pthread_once(&g_checksum_once, checksum_init);
+        fn = __atomic_load_n(&g_xor_fn, __ATOMIC_ACQUIRE);
+    }
+    if (!data) return 0;
+    return fn((const unsigned char *)data, len);
+}
+
+// 사용 중인 XOR 구현 이름 반환 함수
+const char *xor_checksum_impl(void) {
+    pthread_once(&g_checksum_once, checksum_init);
+    return g_xor_name;
+}
+
+// XOR 구현 강제 선택 함수 (다른 스레드가 계산 중이지 않을 때 호출)
+int xor_checksum_force(const char *name) {
+    pthread_once(&g_checksum_once, checksum_init);
+    return xor_select(name);
+}
+
+// CRC32C 계산 함수 - crc는 이전 결과 (처음은 0)
+uint32_t crc32c(uint32_t crc, const void *data, size_t len) {
+    Crc32cFn fn = __atomic_load_n(&g_crc32c_fn, __ATOMIC_ACQUIRE);
+    if (!fn) {
+        pthread_once(&g_checksum_once, checksum_init);
+        fn = __atomic_load_n(&g_crc32c_fn, __ATOMIC_ACQUIRE);
+    }
+    if (!data) len = 0;
+    return ~fn(~crc, (const unsigned char *)data, len);
+}
+
+// 사용 중인 CRC32C 구현 이름 반환 함수
+const char *crc32c_impl(void) {
+    pthread_once(&g_checksum_once, checksum_init);
+    return g_crc32c_name;
+}
+
+// CRC32C 구현 강제 선택 함수 (다른 스레드가 계산 중이지 않을 때 호출)
+int crc32c_force(const char *name) {
+    pthread_once(&g_checksum_once, checksum_init);
+    return crc32c_select(name);
+}
@@ -0,0 +1,25 @@
+// common/chat_checksum.h - 프레임 체크섬 (XOR, CRC32C) 정의 헤더
+#ifndef CHAT_CHECKSUM_H
+#define CHAT_CHECKSUM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ======== XOR 체크섬 (v1/v2 기본 체크섬) ========
+// 모든 바이트를 XOR한 1바이트 - 묶는 순서와 관계없이 같은 값이므로 8/16/32바이트 단위로 XOR한 뒤 접어서 계산
+// 실행 시점에 AVX2 > SSE2 > 8바이트 정수 순으로 선택하며 결과는 바이트 단위 계산과 같음
+
+// ======== CRC32C (Castagnoli, 다항식 0x1EDC6F41) ========
+// x86의 SSE4.2 crc32 명령을 실행 시점에 확인해 사용하고, 지원하지 않으면 8바이트 단위 테이블 방식으로 계산
+// 결과는 두 구현이 같음 (iSCSI/ext4와 같은 정의: 초기값과 최종 XOR 0xFFFFFFFF)
+
+// ======== 함수 프로토타입 ========
+unsigned char xor_checksum(const void *data, size_t len); // 모든 바이트의 XOR
+const char *xor_checksum_impl(void);    // 사용 중인 구현 이름 ("avx2", "sse2" 또는 "scalar")
+int xor_checksum_force(const char *name); // 구현 강제 선택 (벤치마크/검증용, NULL이면 자동 선택) - 지원하지 않으면 -1
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t len); // CRC32C 계산 - 처음은 crc = 0, 나누어 계산하면 이전 결과를 crc로 전달
+const char *crc32c_impl(void);          // 사용 중인 구현 이름 ("sse4.2" 또는 "table")
+int crc32c_force(const char *name);     // 구현 강제 선택 (벤치마크/검증용, NULL이면 자동 선택) - 지원하지 않으면 -1
+
+#endif // CHAT_CHECKSUM_H
@@ -0,0 +1,200 @@
+#include <string.h>
+#include <pthread.h>
+#include "chat_compress.h"
+
+#define LZ4_HASH_BITS 12 // 해시 테이블 최대 크기 (4096개, 스택 16KB)
+
+// ================== 전역 변수 ===================
+CompressStats g_compress_stats;          // 압축 누적 카운터
+
+// 내장 공유 사전 - 서버 응답/공지 문구와 대화 기록 형식 (자주 쓰이는 문구일수록 뒤쪽, 같은 해시면 뒤 위치가 남음)
+// 내용을 바꾸면 HELLO_COMPRESS_* 비트를 새로 정의해야 함 (이전 클라이언트와 해제 결과가 달라짐)
+static const char g_lz4_dict[] =
+    "Available Commands: \n/create <room_name> - Create a new room\n/join <room_no> - Join an existing room\n"
+    "/leave - Leave the current room\n/kick <user_id> - Kick a user from the current room\n"
+    "/change <room_name> - Change current room name\n/manager <user_id> - Change room manager\n"
+    " Only the room manager can change the room name.\n Only the room manager can change the manager.\n"
+    " Only the sender or the room manager can delete this message.\n"
+    " Room name '%s' already exists. Please choose a different name.\n Room with ID not found.\n"
+    " You are not in a chatroom. Please join or create a room first.\n"
+    " You are already in a room. Please /leave first.\n You have been kicked from the room.\n"
+    " Rate limit exceeded. Messages are being dropped, please slow down.\n"
+    " Invalid ID length. Please enter 2 to 20 characters.\n"
+    " Welcome, ! You can now join a chatroom or create one.\n"
+    "[Server] No chat history found for you in this room.\n"
+    " Available rooms: No rooms available.\n Connected users: \n Users in room : "
+    " Room '' (ID: ) created and joined.\n You have joined room '' (ID: ).\n You left the room.\n"
+    " User '' is now the manager of room ''.\n User '' has been kicked from the room by .\n"
+    "hello everyone, how are you? thanks, what do you think about this? I don't know, yes, okay. "
+    "[2026-01-01 12:00:00] User: \n[2026-10-17 23:59:59] "
+    " has left the room.\n has joined the room.\n[Server] [Server] ";
+
+static uint32_t g_lz4_dict_table[1 << LZ4_HASH_BITS]; // 사전 위치 해시 테이블 (위치 + 1, 0은 비어 있음)
+static pthread_once_t g_lz4_once = PTHREAD_ONCE_INIT;
+
+#define LZ4_DICT_LEN (sizeof(g_lz4_dict) - 1)
+
+// 4바이트 읽기 (정렬 무관)
+static inline uint32_t lz4_read32(const unsigned char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+// 4바이트 시퀀스 해시 (곱셈 해시의 상위 비트)
+static inline uint32_t lz4_hash(uint32_t v) {
+    return (v * 2654435761u) >> (32 - LZ4_HASH_BITS);
+}
+
+// 사전 해시 테이블 초기화 함수 (한 번만 실행, 이후 읽기 전용)
+static void lz4_dict_init(void) {
+    for (size_t i = 0; i + LZ4_MIN_MATCH <= LZ4_DICT_LEN; i++) {
+        g_lz4_dict_table[lz4_hash(lz4_read32((const unsigned char *)g_lz4_dict + i))] = (uint32_t)i + 1;
+    }
+}
+
+// 내장 사전 크기 반환 함수
+size_t lz4_dict_size(void) {
+    return LZ4_DICT_LEN;
+}
+
+// 길이 필드 확장 바이트 기록 함수 (15 이상이면 255 단위로 이어 씀), 기록 후 위치 반환
+static unsigned char *lz4_write_len(unsigned char *op, size_t len) {
+    while (len >= 255) {
+        *op++ = 255;
+        len -= 255;
+    }
+    *op++ = (unsigned char)len;
+    return op;
+}
+
+// 시퀀스(리터럴 + 일치) 1개 기록 함수 - match_len이 0이면 마지막 리터럴만 기록, 공간이 부족하면 NULL 반환
+static unsigned char *lz4_write_sequence(unsigned char *op, unsigned char *oend, const unsigned char *lit, size_t lit_len,
+                                         size_t offset, size_t match_len) {
+    size_t ml = match_len ? match_len - LZ4_MIN_MATCH : 0;
+    size_t need = 1 + lit_len / 255 + 1 + lit_len + (match_len ? 2 + ml / 255 + 1 : 0);
+    if ((size_t)(oend - op) < need) return NULL;
+
+    unsigned char *token = op++;
+    *token = (unsigned char)((lit_len < 15 ? lit_len : 15) << 4);
+    if (lit_len >= 15) op = lz4_write_len(op, lit_len - 15);
+    memcpy(op, lit, lit_len);
+    op += lit_len;
+    if (!match_len) return op;
+
+    *op++ = (unsigned char)(offset & 0xff);
+    *op++ = (unsigned char)(offset >> 8);
+    *token |= (unsigned char)(ml < 15 ? ml : 15);
+    if (ml >= 15) op = lz4_write_len(op, ml - 15);
+    return op;
+}
+
+// LZ4 블록 압축 함수 - 사전이 입력 바로 앞에 있는 것으로 보고 탐욕적으로 일치 탐색
+// 입력 위치는 입력 길이에 맞춘 작은 테이블에 새로 등록하고, 없으면 미리 만든 사전 테이블(읽기 전용)에서 찾음
+// 사전에서 시작한 일치는 사전 끝까지만 연장
+size_t lz4_compress_dict(const unsigned char *src, size_t len, unsigned char *dst, size_t cap) {
+    pthread_once(&g_lz4_once, lz4_dict_init);
+    const unsigned char *dict = (const unsigned char *)g_lz4_dict;
+    const size_t dict_len = LZ4_DICT_LEN;
+    uint32_t table[1 << LZ4_HASH_BITS]; // 입력 위치 + 1 (0은 비어 있음)
+    int bits = len < 1024 ? LZ4_HASH_BITS - 4 : (len < 16384 ? LZ4_HASH_BITS - 2 : LZ4_HASH_BITS); // 짧은 입력은 초기화 비용을 줄임
+    memset(table, 0, sizeof(table[0]) << bits);
+
+    unsigned char *op = dst;
+    unsigned char *oend = dst + cap;
+    size_t ip = 0, anchor = 0;
+    size_t mf_limit = len > LZ4_MF_LIMIT ? len - LZ4_MF_LIMIT : 0;
+    while (ip < mf_limit) {
+        uint32_t seq = lz4_read32(src + ip);
+        uint32_t h = lz4_hash(seq) >> (LZ4_HASH_BITS - bits);
+        size_t ref = table[h];
+        table[h] = (uint32_t)ip + 1;
+
+        const unsigned char *rp = NULL;
+        size_t offset = 0;
+        size_t max_len = len - LZ4_LAST_LITERALS - ip;
+        if (ref > 0 && ip - (ref - 1) <= LZ4_MAX_OFFSET && lz4_read32(src + ref - 1) == seq) {
+            rp = src + ref - 1;
+            offset = ip - (ref - 1);
+        } else if ((ref = g_lz4_dict_table[lz4_hash(seq)]) > 0 && dict_len - (ref - 1) >= LZ4_MIN_MATCH &&
+                   lz4_read32(dict + ref - 1) == seq) {
+            rp = dict + ref - 1;
+            offset = dict_len - (ref - 1) + ip;
+            if (offset > LZ4_MAX_OFFSET) rp = NULL;
+            if (max_len > dict_len - (ref - 1)) max_len = dict_len - (ref - 1);
+        }
+        if (!rp) {
+            ip++;
+            continue;
+        }
+
+        size_t match_len = LZ4_MIN_MATCH;
+        while (match_len < max_len && rp[match_len] == src[ip + match_len]) match_len++;
+        op = lz4_write_sequence(op, oend, src + anchor, ip - anchor, offset, match_len);
+        if (!op) return 0;
+        ip += match_len;
+        anchor = ip;
+        if (ip - 2 < mf_limit) table[lz4_hash(lz4_read32(src + ip - 2)) >> (LZ4_HASH_BITS - bits)] = (uint32_t)(ip - 2) + 1; // 일치 끝 부근도 등록
+    }
+    op = lz4_write_sequence(op, oend, src + anchor, len - anchor, 0, 0);
+    return op ? (size_t)(op - dst) : 0;
+}
+
+// 길이 필드 확장 바이트 읽기 함수 - 입력 범위를 넘으면 -1
+static int lz4_read_len(const unsigned char **ip, const unsigned char *iend, size_t *len) {
+    unsigned char b;
+    do {
+        if (*ip >= iend) return -1;
+        b = *(*ip)++;
+        *len += b;
+    } while (b == 255);
+    return 0;
+}
+
+// LZ4 블록 해제 함수 - 출력 앞에 사전이 있는 것으로 보고 일치 복사, 모든 길이/거리를 확인
+long lz4_decompress_dict(const unsigned char *src, size_t len, unsigned char *dst, size_t out_len) {
+    const unsigned char *dict = (const unsigned char *)g_lz4_dict;
+    const size_t dict_len = LZ4_DICT_LEN;
+    const unsigned char *ip = src;
+    const unsigned char *iend = src + len;
+    size_t op = 0;
+
+    while (ip < iend) {
+        unsigned char token = *ip++;
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && lz4_read_len(&ip, iend, &lit_len) < 0) return -1;
+        if ((size_t)(iend - ip) < lit_len || out_len - op < lit_len) return -1;
+        memcpy(dst + op, ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == iend) break; // 마지막 시퀀스는 리터럴만
+
+        if (iend - ip < 2) return -1;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        size_t match_len = token & 15;
+        if (match_len == 15 && lz4_read_len(&ip, iend, &match_len) < 0) return -1;
+        match_len += LZ4_MIN_MATCH;
+        if (offset == 0 || offset > op + dict_len || out_len - op < match_len) return -1;
+
+        if (offset <= op) {
+            // 출력 안의 일치 - 겹치면(offset < 길이) 반복 패턴이므로 offset 바이트씩 나누어 복사
+            unsigned char *d = dst + op;
+            size_t left = match_len;
+            while (left > 0) {
+                size_t n = left < offset ? left : offset;
+                memcpy(d, d - offset, n);
+                d += n;
+                left -= n;
+            }
+        } else {
+            // 사전에서 시작한 일치 - 사전 끝을 넘으면 출력 앞부분으로 이어짐
+            size_t pos = dict_len + op - offset;
+            for (size_t k = 0; k < match_len; k++, pos++) {
+                dst[op + k] = pos < dict_len ? dict[pos] : dst[pos - dict_len];
+            }
+        }
+        op += match_len;
+    }
+    return op == out_len ? (long)out_len : -1;
+}
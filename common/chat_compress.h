@@ -0,0 +1,33 @@
+// common/chat_compress.h - 공유 사전 LZ4 블록 압축 정의 헤더
+#ifndef CHAT_COMPRESS_H
+#define CHAT_COMPRESS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ======== LZ4 블록 + 내장 공유 사전 ========
+// 채팅 응답은 짧고 같은 문구("[Server] ", " has joined the room." 등)가 반복되므로
+// 서버/클라이언트가 같은 사전을 출력 바로 앞에 있는 것으로 보고 압축 (LZ4 블록 형식을 직접 구현, 외부 라이브러리 없음)
+// 사전 내용을 바꾸면 이전 구현과 해제 결과가 달라지므로 협상 비트(HELLO_COMPRESS_*)도 새로 정의해야 함
+#define LZ4_MIN_MATCH     4       // 최소 일치 길이
+#define LZ4_LAST_LITERALS 5       // 블록 끝 리터럴 최소 길이 (LZ4 형식 규칙)
+#define LZ4_MF_LIMIT      12      // 블록 끝에서 이 거리 안에서는 일치를 시작하지 않음 (LZ4 형식 규칙)
+#define LZ4_MAX_OFFSET    65535   // 최대 일치 거리 (사전 포함)
+
+// 압축 누적 카운터 (모든 스레드가 원자적으로 증가)
+typedef struct {
+    unsigned long frames;           // 압축해 보낸 메시지 수
+    unsigned long skipped;          // 압축해도 줄지 않아 그대로 보낸 메시지 수
+    unsigned long bytes_in;         // 압축한 메시지의 원래 크기 합
+    unsigned long bytes_out;        // 압축 결과 크기 합
+} CompressStats;
+
+// ======== 전역 변수 ========
+extern CompressStats g_compress_stats;  // 압축 누적 카운터
+
+// ======== 함수 프로토타입 ========
+size_t lz4_compress_dict(const unsigned char *src, size_t len, unsigned char *dst, size_t cap); // 압축 - 결과 길이, cap 안에 담지 못하면 0
+long lz4_decompress_dict(const unsigned char *src, size_t len, unsigned char *dst, size_t out_len); // 해제 - 결과가 정확히 out_len 바이트이면 out_len, 형식 오류면 -1
+size_t lz4_dict_size(void);            // 내장 사전 크기 (바이트)
+
+#endif // CHAT_COMPRESS_H
@@ -5,7 +5,11 @@
 #include <signal.h>
 #include <stdio.h>
 #include <arpa/inet.h>
+#include <poll.h>
+#include <sys/uio.h>
 #include "chat_protocol.h"
+#include "chat_checksum.h"
+#include "chat_compress.h"
 
 // ============ 공통 유틸리티 함수 구현 ============
 // 패킷 수신 함수 - 소켓 번호, 매직 넘버, 패킷 타입, 데이터 포인터, 데이터 길이를 인자로 받음
@@ -22,30 +26,19 @@ ssize_t recv_all(int sock, void *buf, size_t len) {
 }
 
 // 패킷 헤더 체크섬 계산 함수 - 패킷 헤더와 데이터를 XOR 연산으로 체크섬 계산
+// 바이트 단위 루프 대신 CPU에 맞는 SIMD 구현 사용 (결과는 같음, chat_checksum.c)
 unsigned char calculate_checksum(const unsigned char *header_and_data, size_t length) {
-    unsigned char cs = 0; // 체크섬 초기화
-    for (size_t i = 0; i < length; i++) {
-        cs ^= header_and_data[i]; // XOR 연산으로 체크섬 계산
-    }
-    return cs; // 계산된 체크섬 반환
+    return xor_checksum(header_and_data, length);
 }
 
-// 패킷 전송 함수 - 소켓 번호, 매직 넘버, 패킷 타입, 데이터 포인터, 데이터 길이를 인자로 받음
-ssize_t send_packet(int sock, uint16_t magic, uint8_t type, const void *data, uint16_t data_len) {
+// 패킷을 주어진 버퍼에 인코딩하는 함수 - 버퍼는 sizeof(PacketHeader) + data_len + 1 바이트 이상
+static void encode_packet_into(unsigned char *packet_buffer, uint16_t magic, uint8_t type, const void *data, uint16_t data_len) {
     PacketHeader header;
     header.magic = htons(magic); // 네트워크 바이트 순서로 변환
     header.type = type;
     header.data_len = htons(data_len); // 네트워크 바이트 순서로 변환
-    if (sock < 0) return -1; // 유효하지 않은 소켓 번호
 
     size_t packet_payload_size = sizeof(PacketHeader) + data_len; // 패킷 페이로드 크기
-    size_t total_packet_size = packet_payload_size + 1; // 체크섬을 위한 추가 바이트
-
-    unsigned char *packet_buffer = malloc(total_packet_size); // 패킷 버퍼 할당
-    if (!packet_buffer) {
-        fprintf(stderr, "malloc for send_packet buffer failed");
-        return -1;
-    }
     memcpy(packet_buffer, &header, sizeof(PacketHeader));
     // 데이터 복사
     if (data && data_len > 0) {
@@ -54,22 +47,628 @@ ssize_t send_packet(int sock, uint16_t magic, uint8_t type, const void *data, ui
 
     // 체크섬 계산 및 추가
     packet_buffer[packet_payload_size] = calculate_checksum(packet_buffer, packet_payload_size);
+}
+
+// 패킷 인코딩 함수 - 헤더(네트워크 바이트 순서) + 데이터 + 체크섬을 하나의 버퍼로 만들어 반환
+unsigned char *encode_packet(uint16_t magic, uint8_t type, const void *data, uint16_t data_len, size_t *packet_len) {
+    size_t total_packet_size = sizeof(PacketHeader) + data_len + 1; // 체크섬을 위한 추가 바이트
+
+    unsigned char *packet_buffer = malloc(total_packet_size); // 패킷 버퍼 할당
+    if (!packet_buffer) {
+        fprintf(stderr, "malloc for send_packet buffer failed");
+        return NULL;
+    }
+    encode_packet_into(packet_buffer, magic, type, data, data_len);
+
+    *packet_len = total_packet_size;
+    return packet_buffer;
+}
+
+// 공유 프레임 인코딩 함수 - 구조체와 패킷을 한 번에 할당, 참조 수 1로 반환
+SharedFrame *shared_frame_encode(uint16_t magic, uint8_t type, const void *data, uint16_t data_len) {
+    size_t total_packet_size = sizeof(PacketHeader) + data_len + 1;
+
+    SharedFrame *frame = malloc(sizeof(SharedFrame) + total_packet_size);
+    if (!frame) {
+        fprintf(stderr, "malloc for SharedFrame failed");
+        return NULL;
+    }
+    frame->refcount = 1;
+    frame->codec = 0;
+    frame->variants = NULL;
+    frame->next_variant = NULL;
+    frame->len = total_packet_size;
+    encode_packet_into(frame->data, magic, type, data, data_len);
+    return frame;
+}
+
+// ============ v2 프레임 ============
+// v2 조각 헤더 구성 함수 (magic은 v1 상수로 받아 v2 매직 넘버로 변환, 네트워크 바이트 순서)
+static void packet_v2_header(PacketHeaderV2 *hdr, uint16_t magic, uint8_t type, uint8_t flags, uint32_t data_len) {
+    hdr->magic = htons(magic == REQ_MAGIC ? REQ_MAGIC_V2 : RES_MAGIC_V2);
+    hdr->type = type;
+    hdr->flags = flags;
+    hdr->data_len = htonl(data_len);
+}
+
+// 조각 뒤 체크섬 길이 (CRC32C 4바이트, 그 외 XOR 1바이트)
+static size_t packet_v2_trailer_len(uint8_t flags) {
+    return (flags & PACKET_FLAG_CRC32C) ? 4 : 1;
+}
+
+// 조각 체크섬을 trailer에 기록하는 함수 - 헤더와 데이터를 이어 붙이지 않고 계산, 기록한 길이 반환
+static size_t packet_v2_trailer(unsigned char *trailer, const PacketHeaderV2 *hdr, const void *data, size_t n) {
+    if (hdr->flags & PACKET_FLAG_CRC32C) {
+        uint32_t crc = htonl(crc32c(crc32c(0, hdr, sizeof(*hdr)), data, n));
+        memcpy(trailer, &crc, sizeof(crc));
+        return sizeof(crc);
+    }
+    trailer[0] = calculate_checksum((const unsigned char *)hdr, sizeof(*hdr))
+               ^ calculate_checksum((const unsigned char *)data, n);
+    return 1;
+}
+
+// 조각 수 계산 함수 (데이터가 없어도 조각 1개)
+static size_t packet_v2_fragments(size_t data_len) {
+    return data_len == 0 ? 1 : (data_len + PACKET_V2_FRAGMENT_SIZE - 1) / PACKET_V2_FRAGMENT_SIZE;
+}
+
+static size_t g_compress_min = PACKET_COMPRESS_MIN; // 압축 최소 길이
+
+// 압축 최소 길이 설정 함수 (시작 시 한 번)
+void packet_set_compress_min(size_t len) {
+    g_compress_min = len;
+}
+
+// 메시지 압축 함수 - 원래 길이(4바이트) + LZ4 블록을 새 버퍼에 만들어 반환
+// 최소 길이보다 짧거나 압축해도 줄지 않으면 NULL (원본을 그대로 전송)
+static unsigned char *packet_v2_compress(const void *data, size_t data_len, size_t *packed_len) {
+    if (!data || data_len < g_compress_min || data_len <= sizeof(uint32_t) + 1) return NULL;
+    unsigned char *packed = malloc(data_len);
+    if (!packed) return NULL;
+    size_t n = lz4_compress_dict(data, data_len, packed + sizeof(uint32_t), data_len - sizeof(uint32_t) - 1);
+    if (n == 0) {
+        __atomic_fetch_add(&g_compress_stats.skipped, 1, __ATOMIC_RELAXED);
+        free(packed);
+        return NULL;
+    }
+    uint32_t original = htonl((uint32_t)data_len);
+    memcpy(packed, &original, sizeof(original));
+    *packed_len = sizeof(original) + n;
+    __atomic_fetch_add(&g_compress_stats.frames, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_compress_stats.bytes_in, data_len, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_compress_stats.bytes_out, *packed_len, __ATOMIC_RELAXED);
+    return packed;
+}
+
+// v2 공유 프레임 인코딩 함수 - 모든 조각을 버퍼 하나에 이어 붙임
+// (송신 큐에 청크 하나로 들어가므로 다른 패킷이 조각 사이에 끼어들지 않음)
+// LZ4 코덱이면 조각으로 나누기 전에 메시지 전체를 압축 (이득이 없으면 LZ4 플래그 없이 원본 전송)
+SharedFrame *shared_frame_encode_v2(uint16_t magic, uint8_t type, const void *data, size_t data_len, uint8_t codec) {
+    if (data_len > PACKET_MAX_MESSAGE) return NULL;
+    if (!data) data_len = 0;
+    codec &= PACKET_CODEC_MASK;
+    uint8_t flags = codec & (uint8_t)~PACKET_FLAG_LZ4;
+    size_t packed_len = 0;
+    unsigned char *packed = (codec & PACKET_FLAG_LZ4) ? packet_v2_compress(data, data_len, &packed_len) : NULL;
+    if (packed) {
+        data = packed;
+        data_len = packed_len;
+        flags |= PACKET_FLAG_LZ4;
+    }
+    size_t fragments = packet_v2_fragments(data_len);
+    size_t total_packet_size = fragments * (sizeof(PacketHeaderV2) + packet_v2_trailer_len(flags)) + data_len;
+
+    SharedFrame *frame = malloc(sizeof(SharedFrame) + total_packet_size);
+    if (!frame) {
+        fprintf(stderr, "malloc for SharedFrame failed");
+        free(packed);
+        return NULL;
+    }
+    frame->refcount = 1;
+    frame->codec = codec;
+    frame->variants = NULL;
+    frame->next_variant = NULL;
+    frame->len = total_packet_size;
+
+    unsigned char *p = frame->data;
+    size_t off = 0;
+    for (size_t i = 0; i < fragments; i++) {
+        size_t n = data_len - off < PACKET_V2_FRAGMENT_SIZE ? data_len - off : PACKET_V2_FRAGMENT_SIZE;
+        PacketHeaderV2 hdr;
+        packet_v2_header(&hdr, magic, type, flags | (i + 1 < fragments ? PACKET_FLAG_MORE : 0), (uint32_t)n);
+        memcpy(p, &hdr, sizeof(hdr));
+        if (n > 0) memcpy(p + sizeof(hdr), (const unsigned char *)data + off, n);
+        p += sizeof(hdr) + n;
+        p += packet_v2_trailer(p, &hdr, p - n, n);
+        off += n;
+    }
+    free(packed);
+    return frame;
+}
+
+// v2 패킷 전송 함수 - 조각마다 헤더/데이터/체크섬을 writev() 한 번으로 전송 (데이터 복사 없음)
+ssize_t send_packet_v2(int sock, uint16_t magic, uint8_t type, const void *data, size_t data_len, uint8_t codec) {
+    if (sock < 0 || data_len > PACKET_MAX_MESSAGE) return -1;
+    if (!data) data_len = 0;
+    codec &= PACKET_CODEC_MASK;
+    uint8_t flags = codec & (uint8_t)~PACKET_FLAG_LZ4;
+    size_t packed_len = 0;
+    unsigned char *packed = (codec & PACKET_FLAG_LZ4) ? packet_v2_compress(data, data_len, &packed_len) : NULL;
+    if (packed) {
+        data = packed;
+        data_len = packed_len;
+        flags |= PACKET_FLAG_LZ4;
+    }
 
+    size_t fragments = packet_v2_fragments(data_len);
+    size_t off = 0;
     ssize_t total_sent = 0;
-    ssize_t bytes_left = (ssize_t)total_packet_size;
+    for (size_t i = 0; i < fragments; i++) {
+        size_t n = data_len - off < PACKET_V2_FRAGMENT_SIZE ? data_len - off : PACKET_V2_FRAGMENT_SIZE;
+        PacketHeaderV2 hdr;
+        packet_v2_header(&hdr, magic, type, flags | (i + 1 < fragments ? PACKET_FLAG_MORE : 0), (uint32_t)n);
+        unsigned char trailer[4];
+        size_t trailer_len = packet_v2_trailer(trailer, &hdr, (const unsigned char *)data + off, n);
+
+        struct iovec iov[PACKET_IOV_COUNT];
+        int iovcnt = 0;
+        iov[iovcnt].iov_base = &hdr;
+        iov[iovcnt++].iov_len = sizeof(hdr);
+        if (n > 0) {
+            iov[iovcnt].iov_base = (unsigned char *)data + off;
+            iov[iovcnt++].iov_len = n;
+        }
+        iov[iovcnt].iov_base = trailer;
+        iov[iovcnt++].iov_len = trailer_len;
+
+        ssize_t sent = send_iov_all(sock, iov, iovcnt);
+        if (sent < 0) {
+            free(packed);
+            return -1;
+        }
+        total_sent += sent;
+        off += n;
+    }
+    free(packed);
+    return total_sent;
+}
+
+// 같은 패킷의 다른 코덱 인코딩 반환 함수 - 브로드캐스트 프레임을 수신자 코덱마다 한 번만 다시 인코딩
+// 원본이 v1 프레임일 때만 새로 만들 수 있음 (조각난 v2 프레임은 NULL), 반환한 참조는 호출자가 해제
+SharedFrame *shared_frame_variant(SharedFrame *frame, uint8_t codec) {
+    codec &= PACKET_CODEC_MASK;
+    if (frame->codec == codec) return shared_frame_ref(frame);
+
+    SharedFrame *head = __atomic_load_n(&frame->variants, __ATOMIC_ACQUIRE);
+    for (SharedFrame *v = head; v; v = v->next_variant) {
+        if (v->codec == codec) return shared_frame_ref(v);
+    }
+
+    PacketHeader hdr;
+    if (frame->len < sizeof(hdr) + 1) return NULL;
+    memcpy(&hdr, frame->data, sizeof(hdr));
+    uint16_t magic = ntohs(hdr.magic);
+    if ((magic != REQ_MAGIC && magic != RES_MAGIC) || frame->len != sizeof(hdr) + ntohs(hdr.data_len) + 1) return NULL;
+
+    SharedFrame *created = shared_frame_encode_v2(magic, hdr.type, frame->data + sizeof(hdr), ntohs(hdr.data_len), codec);
+    if (!created) return NULL;
+
+    // 다른 스레드가 먼저 추가했으면 그 인코딩을 사용 (목록은 추가만 되므로 앞부분만 다시 확인)
+    do {
+        for (SharedFrame *v = head; v; v = v->next_variant) {
+            if (v->codec == codec) {
+                shared_frame_release(created);
+                return shared_frame_ref(v);
+            }
+        }
+        created->next_variant = head;
+    } while (!__atomic_compare_exchange_n(&frame->variants, &head, created, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    return shared_frame_ref(created);
+}
+
+// 공유 프레임 참조 추가 함수
+SharedFrame *shared_frame_ref(SharedFrame *frame) {
+    __sync_fetch_and_add(&frame->refcount, 1);
+    return frame;
+}
+
+// 공유 프레임 참조 해제 함수 - 마지막 참조이면 메모리 해제
+void shared_frame_release(SharedFrame *frame) {
+    if (!frame) return;
+    if (__sync_sub_and_fetch(&frame->refcount, 1) != 0) return;
+    SharedFrame *v = frame->variants;
+    while (v) {
+        SharedFrame *next = v->next_variant;
+        shared_frame_release(v);
+        v = next;
+    }
+    free(frame);
+}
+
+// 패킷 1개를 iovec로 구성하는 함수 - 헤더/체크섬은 framing에, 데이터는 호출자 버퍼를 그대로 참조 (복사 없음)
+// framing과 data는 전송이 끝날 때까지 유지되어야 함, 사용한 iovec 수(2 또는 3) 반환
+int packet_iov_init(PacketFraming *framing, struct iovec *iov, uint16_t magic, uint8_t type, const void *data, uint16_t data_len) {
+    if (!data) data_len = 0;
+    framing->hdr.magic = htons(magic); // 네트워크 바이트 순서로 변환
+    framing->hdr.type = type;
+    framing->hdr.data_len = htons(data_len); // 네트워크 바이트 순서로 변환
+    // 헤더와 데이터를 이어 붙이지 않고 XOR 체크섬 계산
+    framing->checksum = calculate_checksum((const unsigned char *)&framing->hdr, sizeof(PacketHeader))
+                      ^ calculate_checksum((const unsigned char *)data, data_len);
+
+    int n = 0;
+    iov[n].iov_base = &framing->hdr;
+    iov[n++].iov_len = sizeof(PacketHeader);
+    if (data_len > 0) {
+        iov[n].iov_base = (void *)data;
+        iov[n++].iov_len = data_len;
+    }
+    iov[n].iov_base = &framing->checksum;
+    iov[n++].iov_len = 1;
+    return n;
+}
 
-    while (bytes_left > 0) {
-        ssize_t sent = send(sock, packet_buffer + total_sent, (size_t)bytes_left, 0); // 패킷 전송
+// iovec 배열 전체를 전송하는 함수 - 여러 패킷을 writev() 한 번으로 전송, 부분 전송 시 남은 부분부터 재시도
+// 전송된 바이트 수 반환, 에러 시 -1
+ssize_t send_iov_all(int sock, struct iovec *iov, int iovcnt) {
+    if (sock < 0) return -1; // 유효하지 않은 소켓 번호
+
+    ssize_t total_sent = 0;
+    while (iovcnt > 0) {
+        ssize_t sent = writev(sock, iov, iovcnt < PACKET_IOV_MAX ? iovcnt : PACKET_IOV_MAX);
         if (sent < 0) {
             if (errno == EINTR) continue; // 인터럽트된 경우 재시도
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // 논블로킹 소켓의 송신 버퍼가 가득 찬 경우 쓰기 가능해질 때까지 대기
+                struct pollfd pfd = { .fd = sock, .events = POLLOUT, .revents = 0 };
+                poll(&pfd, 1, -1);
+                continue;
+            }
             perror("send error");
-            free(packet_buffer);
             return -1;
         }
         total_sent += sent;
-        bytes_left -= sent;
+
+        // 전송 완료된 iovec 건너뛰고 부분 전송된 iovec 조정
+        while (iovcnt > 0 && (size_t)sent >= iov->iov_len) {
+            sent -= (ssize_t)iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + sent;
+            iov->iov_len -= (size_t)sent;
+        }
+    }
+    return total_sent;
+}
+
+// 패킷 전송 함수 - 소켓 번호, 매직 넘버, 패킷 타입, 데이터 포인터, 데이터 길이를 인자로 받음
+// 헤더, 데이터, 체크섬을 writev() 한 번으로 전송 (버퍼 할당/복사 없음)
+ssize_t send_packet(int sock, uint16_t magic, uint8_t type, const void *data, uint16_t data_len) {
+    if (sock < 0) return -1; // 유효하지 않은 소켓 번호
+
+    PacketFraming framing;
+    struct iovec iov[PACKET_IOV_COUNT];
+    int iovcnt = packet_iov_init(&framing, iov, magic, type, data, data_len);
+    return send_iov_all(sock, iov, iovcnt);
+}
+
+// ============ 증분 프레임 디코더 구현 ============
+#define FRAME_MSG_KEEP_CAP (64 * 1024) // 조립이 끝난 뒤에도 유지할 조립 버퍼 최대 용량 (큰 메시지 이후 메모리 반환)
+
+// 디코더 초기화 함수
+void frame_decoder_init(FrameDecoder *dec) {
+    memset(dec, 0, sizeof(*dec));
+    dec->state = FRAME_STATE_HEADER;
+    dec->need = sizeof(PacketHeader);
+}
+
+// 조립 중인 프레임 폐기 함수 - 조립 버퍼는 다음 프레임을 위해 유지
+void frame_decoder_reset(FrameDecoder *dec) {
+    dec->state = FRAME_STATE_HEADER;
+    dec->need = sizeof(PacketHeader);
+    dec->len = 0;
+    dec->in = NULL;
+    dec->in_len = 0;
+    dec->in_off = 0;
+    dec->msg_active = 0;
+    dec->msg_len = 0;
+}
+
+// 조립 버퍼 해제 함수
+void frame_decoder_free(FrameDecoder *dec) {
+    free(dec->buf);
+    dec->buf = NULL;
+    dec->cap = 0;
+    free(dec->msg);
+    dec->msg = NULL;
+    dec->msg_cap = 0;
+    free(dec->plain);
+    dec->plain = NULL;
+    dec->plain_cap = 0;
+    frame_decoder_reset(dec);
+}
+
+// 새 입력 설정 함수 - buf는 frame_decoder_next가 0을 반환할 때까지 유지되어야 함
+void frame_decoder_feed(FrameDecoder *dec, unsigned char *buf, size_t len) {
+    dec->in = buf;
+    dec->in_len = len;
+    dec->in_off = 0;
+}
+
+// 헤더 길이 계산 함수 - 앞 2바이트(매직 넘버)로 v1/v2 구분
+static size_t frame_header_size(const unsigned char *raw) {
+    uint16_t magic = (uint16_t)((raw[0] << 8) | raw[1]);
+    return (magic == REQ_MAGIC_V2 || magic == RES_MAGIC_V2) ? sizeof(PacketHeaderV2) : sizeof(PacketHeader);
+}
+
+// 네트워크 바이트 순서 헤더를 호스트 바이트 순서로 읽는 함수 - 너무 큰 v2 조각이면 -1 반환
+static int frame_parse_header(FrameHeader *hdr, const unsigned char *raw) {
+    if (frame_header_size(raw) == sizeof(PacketHeaderV2)) {
+        PacketHeaderV2 v2;
+        memcpy(&v2, raw, sizeof(v2));
+        hdr->magic = ntohs(v2.magic) == REQ_MAGIC_V2 ? REQ_MAGIC : RES_MAGIC;
+        hdr->type = v2.type;
+        hdr->flags = v2.flags;
+        hdr->version = 2;
+        hdr->data_len = ntohl(v2.data_len);
+        return hdr->data_len > PACKET_V2_MAX_FRAGMENT ? -1 : 0;
+    }
+    PacketHeader v1;
+    memcpy(&v1, raw, sizeof(v1));
+    hdr->magic = ntohs(v1.magic);
+    hdr->type = v1.type;
+    hdr->flags = 0;
+    hdr->version = 1;
+    hdr->data_len = ntohs(v1.data_len);
+    return 0;
+}
+
+// 헤더 길이 반환 함수 (파싱된 헤더 기준)
+static size_t frame_header_len(const FrameHeader *hdr) {
+    return hdr->version == 2 ? sizeof(PacketHeaderV2) : sizeof(PacketHeader);
+}
+
+// 체크섬 길이 반환 함수 (파싱된 헤더 기준)
+static size_t frame_trailer_len(const FrameHeader *hdr) {
+    return hdr->version == 2 ? packet_v2_trailer_len(hdr->flags) : 1;
+}
+
+// 프레임 전체(헤더 + 데이터 + 체크섬)의 체크섬 확인 함수 - 수신한 체크섬을 received에 저장, 일치하면 1 반환
+static int frame_verify(const FrameHeader *hdr, const unsigned char *raw, uint32_t *received) {
+    size_t covered = frame_header_len(hdr) + hdr->data_len;
+    if (frame_trailer_len(hdr) == 4) {
+        uint32_t crc;
+        memcpy(&crc, raw + covered, sizeof(crc));
+        *received = ntohl(crc);
+        return crc32c(0, raw, covered) == *received;
+    }
+    *received = raw[covered];
+    return calculate_checksum(raw, covered) == raw[covered];
+}
+
+// 데이터+체크섬 영역으로 Frame 완성 - 체크섬 자리를 NUL로 덮어 데이터를 문자열로 사용 가능하게 함
+static void frame_emit(const FrameHeader *hdr, unsigned char *body, uint32_t checksum, int ok, Frame *frame) {
+    frame->hdr = *hdr;
+    frame->checksum = checksum;
+    frame->checksum_ok = ok;
+    body[hdr->data_len] = '\0';
+    frame->data = body;
+}
+
+// 압축된 메시지 해제 함수 - frame의 데이터를 디코더의 해제 버퍼로 바꿈 (코덱 플래그는 유지), 형식 오류/메모리 부족 시 -1
+// 체크섬이 틀린 프레임은 내용을 믿을 수 없으므로 해제하지 않고 그대로 반환
+static int frame_inflate(FrameDecoder *dec, Frame *frame) {
+    if (!(frame->hdr.flags & PACKET_FLAG_LZ4) || !frame->checksum_ok) return 1;
+    uint32_t original;
+    if (frame->hdr.data_len < sizeof(original)) return -1;
+    memcpy(&original, frame->data, sizeof(original));
+    original = ntohl(original);
+    if (original > PACKET_MAX_MESSAGE) return -1; // 조립 메모리 상한 초과
+    if (dec->plain_cap < (size_t)original + 1) {
+        size_t new_cap = dec->plain_cap ? dec->plain_cap : 4096;
+        while (new_cap < (size_t)original + 1) new_cap *= 2;
+        unsigned char *new_plain = realloc(dec->plain, new_cap);
+        if (!new_plain) {
+            perror("realloc for frame decompression failed");
+            return -1;
+        }
+        dec->plain = new_plain;
+        dec->plain_cap = new_cap;
+    }
+    if (lz4_decompress_dict(frame->data + sizeof(original), frame->hdr.data_len - sizeof(original), dec->plain, original) < 0) {
+        return -1; // 체크섬은 맞는데 해제할 수 없으면 상대 구현 오류
+    }
+    dec->plain[original] = '\0';
+    frame->data = dec->plain;
+    frame->hdr.data_len = original;
+    return 1;
+}
+
+// 수신 완료된 프레임 처리 함수 (raw: 헤더 시작) - 1: frame에 꺼낼 프레임 있음, 0: 조각을 조립 버퍼에 넣음, -1: 메모리 부족/프로토콜 위반
+// 조립 중에도 다른 타입 프레임이나 v1 프레임(PING, 브로드캐스트 등)은 그대로 통과
+static int frame_complete(FrameDecoder *dec, const FrameHeader *hdr, unsigned char *raw, Frame *frame) {
+    unsigned char *body = raw + frame_header_len(hdr);
+    uint32_t checksum;
+    int ok = frame_verify(hdr, raw, &checksum);
+    int continues = dec->msg_active && hdr->version == 2 &&
+                    hdr->type == dec->msg_hdr.type && hdr->magic == dec->msg_hdr.magic;
+    if (!continues && !(hdr->flags & PACKET_FLAG_MORE)) {
+        frame_emit(hdr, body, checksum, ok, frame);
+        return frame_inflate(dec, frame);
+    }
+    if (!continues) {
+        if (dec->msg_active) return -1; // 다른 메시지를 조립하는 중에 새 조각 메시지 시작
+        dec->msg_hdr = *hdr;
+        dec->msg_active = 1;
+        dec->msg_len = 0;
+        dec->msg_bad = 0;
+    }
+    if (!ok) dec->msg_bad = 1;
+
+    if (dec->msg_len + hdr->data_len > PACKET_MAX_MESSAGE) return -1; // 조립 메모리 상한 초과
+    if (dec->msg_cap < dec->msg_len + hdr->data_len + 1) {
+        size_t new_cap = dec->msg_cap ? dec->msg_cap : PACKET_V2_FRAGMENT_SIZE;
+        while (new_cap < dec->msg_len + hdr->data_len + 1) new_cap *= 2;
+        unsigned char *new_msg = realloc(dec->msg, new_cap);
+        if (!new_msg) {
+            perror("realloc for frame reassembly failed");
+            return -1;
+        }
+        dec->msg = new_msg;
+        dec->msg_cap = new_cap;
+    }
+    memcpy(dec->msg + dec->msg_len, body, hdr->data_len);
+    dec->msg_len += hdr->data_len;
+    if (hdr->flags & PACKET_FLAG_MORE) return 0;
+
+    // 마지막 조각 - 조립된 메시지를 하나의 프레임으로 반환 (코덱 플래그는 유지)
+    frame->hdr = dec->msg_hdr;
+    frame->hdr.flags &= (uint8_t)~PACKET_FLAG_MORE;
+    frame->hdr.data_len = (uint32_t)dec->msg_len;
+    frame->checksum = checksum;
+    frame->checksum_ok = !dec->msg_bad;
+    dec->msg[dec->msg_len] = '\0';
+    frame->data = dec->msg;
+    dec->msg_active = 0;
+    return frame_inflate(dec, frame);
+}
+
+// 완성된 프레임 1개를 꺼내는 함수 - 프레임이 있으면 1, 입력을 모두 소비했으면 0, 메모리 부족/프로토콜 위반 시 -1 반환
+int frame_decoder_next(FrameDecoder *dec, Frame *frame) {
+    // 큰 메시지를 조립했던 버퍼는 반환된 데이터를 더 쓰지 않는 시점(다음 호출)에 해제
+    if (!dec->msg_active && dec->msg_cap > FRAME_MSG_KEEP_CAP) {
+        free(dec->msg);
+        dec->msg = NULL;
+        dec->msg_cap = 0;
+    }
+    if (dec->plain_cap > FRAME_MSG_KEEP_CAP) {
+        free(dec->plain);
+        dec->plain = NULL;
+        dec->plain_cap = 0;
     }
 
-    free(packet_buffer); // 패킷 버퍼 해제
-    return total_sent; // 전송된 바이트 수 반환
+    while (1) {
+        // 빠른 경로: 조립 중인 프레임이 없고 입력에 프레임 전체가 있으면 복사 없이 제자리에서 처리
+        if (dec->state == FRAME_STATE_HEADER && dec->len == 0) {
+            size_t avail = dec->in_len - dec->in_off;
+            unsigned char *p = dec->in + dec->in_off;
+            if (avail >= 2 && avail >= frame_header_size(p)) {
+                FrameHeader hdr;
+                if (frame_parse_header(&hdr, p) < 0) return -1;
+                size_t frame_len = frame_header_len(&hdr) + hdr.data_len + frame_trailer_len(&hdr); // 헤더 + 데이터 + 체크섬
+                if (avail >= frame_len) {
+                    dec->in_off += frame_len;
+                    int ret = frame_complete(dec, &hdr, p, frame);
+                    if (ret != 0) return ret;
+                    continue; // 조각을 조립 버퍼에 넣었으면 다음 프레임
+                }
+            }
+        }
+
+        // 느린 경로: 여러 번의 recv()에 걸친 프레임을 조립 버퍼에 모음
+        int ret = 0;
+        while (dec->in_off < dec->in_len) {
+            if (dec->cap < dec->need) {
+                // 최대 프레임 크기(약 64KB)까지만 커지며 이후에는 재사용
+                size_t new_cap = dec->cap ? dec->cap : 256;
+                while (new_cap < dec->need) new_cap *= 2;
+                unsigned char *new_buf = realloc(dec->buf, new_cap);
+                if (!new_buf) {
+                    perror("realloc for frame decoder failed");
+                    return -1;
+                }
+                dec->buf = new_buf;
+                dec->cap = new_cap;
+            }
+
+            size_t take = dec->need - dec->len;
+            size_t avail = dec->in_len - dec->in_off;
+            if (take > avail) take = avail;
+            memcpy(dec->buf + dec->len, dec->in + dec->in_off, take);
+            dec->len += take;
+            dec->in_off += take;
+            if (dec->len < dec->need) break; // 입력 부족
+
+            if (dec->state == FRAME_STATE_HEADER) {
+                // v1 헤더 길이만큼 모은 뒤 v2이면 나머지 헤더를 더 모음
+                size_t header_len = frame_header_size(dec->buf);
+                if (dec->len < header_len) {
+                    dec->need = header_len;
+                    continue;
+                }
+                // 헤더 완성 -> 데이터 + 체크섬 수집 단계로 전환
+                if (frame_parse_header(&dec->hdr, dec->buf) < 0) return -1;
+                dec->state = FRAME_STATE_BODY;
+                dec->need = header_len + dec->hdr.data_len + frame_trailer_len(&dec->hdr);
+                continue;
+            }
+
+            // 프레임 완성 - 다음 호출에서 새 프레임을 조립하도록 상태 초기화 (버퍼 내용은 그대로 유효)
+            dec->state = FRAME_STATE_HEADER;
+            dec->need = sizeof(PacketHeader);
+            dec->len = 0;
+            ret = frame_complete(dec, &dec->hdr, dec->buf, frame);
+            if (ret != 0) return ret;
+            break; // 조각을 조립 버퍼에 넣었으면 빠른 경로부터 다시
+        }
+        if (dec->in_off >= dec->in_len && dec->len < dec->need) return 0; // 입력을 모두 소비
+    }
+}
+
+// ============ 연결 협상 ============
+
+// HELLO/HELLO_ACK 데이터 인코딩 함수
+void hello_encode(const HelloInfo *info, unsigned char *buf) {
+    uint32_t max_message = htonl(info->max_message);
+    buf[0] = info->version;
+    buf[1] = info->checksums;
+    buf[2] = info->compression;
+    buf[3] = info->features;
+    memcpy(buf + 4, &max_message, sizeof(max_message));
+}
+
+// HELLO/HELLO_ACK 데이터 디코딩 함수 - 이후 버전이 뒤에 필드를 붙여도 앞부분만 읽음
+int hello_decode(const unsigned char *buf, size_t len, HelloInfo *info) {
+    uint32_t max_message;
+    if (!buf || len < HELLO_PAYLOAD_LEN) return -1;
+    info->version = buf[0];
+    info->checksums = buf[1];
+    info->compression = buf[2];
+    info->features = buf[3];
+    memcpy(&max_message, buf + 4, sizeof(max_message));
+    info->max_message = ntohl(max_message);
+    return 0;
+}
+
+// 합의 결과 계산 함수 - 양쪽이 같은 함수를 쓰므로 결과가 어느 쪽에서 계산해도 같음
+void hello_negotiate(const HelloInfo *offer, const HelloInfo *local, HelloInfo *agreed) {
+    uint8_t version = offer->version < local->version ? offer->version : local->version;
+    uint8_t checksums = offer->checksums & local->checksums;
+    uint8_t compression = offer->compression & local->compression;
+
+    memset(agreed, 0, sizeof(*agreed));
+    agreed->version = version < 1 ? 1 : version;
+    agreed->max_message = offer->max_message < local->max_message ? offer->max_message : local->max_message;
+    if (agreed->max_message < HELLO_MIN_MESSAGE) agreed->max_message = HELLO_MIN_MESSAGE;
+    agreed->checksums = HELLO_CHECKSUM_XOR; // 모든 구현이 지원하는 기본값
+    agreed->features = offer->features & local->features & HELLO_FEATURE_PING; // 하트비트는 프레임 버전과 무관
+    if (agreed->version < 2) {
+        // v1 프레임은 16비트 길이와 XOR 체크섬만 표현 가능
+        if (agreed->max_message > UINT16_MAX) agreed->max_message = UINT16_MAX;
+        return;
+    }
+    if (checksums & HELLO_CHECKSUM_CRC32C) agreed->checksums = HELLO_CHECKSUM_CRC32C;
+    agreed->compression = compression & (uint8_t)-compression; // 양쪽이 지원하는 것 중 가장 낮은 비트
+    agreed->features = offer->features & local->features;
+}
+
+// 합의 결과의 프레임 코덱 플래그 계산 함수
+uint8_t hello_codec(const HelloInfo *agreed) {
+    uint8_t codec = 0;
+    if (agreed->version >= 2 && agreed->checksums == HELLO_CHECKSUM_CRC32C) codec |= PACKET_FLAG_CRC32C;
+    if (agreed->version >= 2 && agreed->compression == HELLO_COMPRESS_LZ4) codec |= PACKET_FLAG_LZ4;
+    return codec;
 }
@@ -4,6 +4,7 @@
 
 #include <stdint.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 // ======== 패킷 헤더 구조체 정의 ========
 #pragma pack(push, 1) // 패딩 없이 구조체 정렬
@@ -18,6 +19,30 @@ typedef struct {
 #define REQ_MAGIC 0x5a5a
 #define RES_MAGIC 0xa5a5
 
+// ======== v2 패킷 헤더 (32비트 길이 + 플래그) ========
+// 같은 포트에서 v1과 함께 사용 - 프레임마다 매직 넘버로 버전을 구분 (헤더 뒤 데이터 + 1바이트 체크섬은 v1과 동일)
+// 큰 데이터는 PACKET_FLAG_MORE가 붙은 조각 여러 개로 나누어 보내고, 수신 측 디코더가 하나의 메시지로 조립
+#pragma pack(push, 1)
+typedef struct {
+    uint16_t magic;        // 패킷 매직 넘버 (REQ_MAGIC_V2 / RES_MAGIC_V2)
+    uint8_t type;          // 패킷 타입 (v1과 동일)
+    uint8_t flags;         // PACKET_FLAG_*
+    uint32_t data_len;     // 이 조각의 데이터 길이
+} PacketHeaderV2;
+#pragma pack(pop)
+
+#define REQ_MAGIC_V2 0x5b5b
+#define RES_MAGIC_V2 0xb5b5
+
+#define PACKET_FLAG_MORE         0x01          // 같은 타입의 조각이 이어짐 (마지막 조각에는 없음)
+#define PACKET_FLAG_CRC32C       0x02          // 체크섬 자리에 헤더 + 데이터의 CRC32C 4바이트 (네트워크 바이트 순서)
+#define PACKET_FLAG_LZ4          0x04          // 메시지 전체가 원래 길이(4바이트, 네트워크 바이트 순서) + 공유 사전 LZ4 블록으로 압축됨
+#define PACKET_CODEC_MASK        (PACKET_FLAG_CRC32C | PACKET_FLAG_LZ4) // 세션 코덱으로 협상되는 플래그 (조각마다 같은 값)
+#define PACKET_COMPRESS_MIN      64            // 기본 압축 최소 길이 (더 짧으면 압축 결과가 거의 줄지 않음)
+#define PACKET_V2_FRAGMENT_SIZE  16384         // 송신 시 조각 데이터 크기
+#define PACKET_V2_MAX_FRAGMENT   65536         // 수신 시 허용하는 조각 데이터 최대 길이 (넘으면 프로토콜 위반)
+#define PACKET_MAX_MESSAGE       (1024 * 1024) // 조립된 메시지 최대 길이 (조립 메모리 상한)
+
 // ======== 패킷 타입 열거형 정의 ========
 typedef enum {
     //— 요청 패킷 타입 —
@@ -36,14 +61,109 @@ typedef enum {
     PACKET_TYPE_HELP               = 13, // 도움말 요청
     PACKET_TYPE_USAGE              = 14, // 명령 사용법 요청
     PACKET_TYPE_QUIT               = 15, // 클라이언트 종료 요청
+    PACKET_TYPE_PONG               = 16, // 하트비트 응답 (PING 수신 시 전송)
+    PACKET_TYPE_HELLO              = 17, // 연결 협상 요청 (SET_ID 전에 지원 기능 전달)
 
     //— 응답 패킷 타입 —
     PACKET_TYPE_ERROR              = 100, // 에러 응답
     PACKET_TYPE_SET_ID             = 101, // ID 변경 완료 응답
     PACKET_TYPE_SERVER_NOTICE      = 102, // 서버 공지
+    PACKET_TYPE_PING               = 103, // 서버 하트비트 (유휴 연결 생존 확인, 클라이언트는 PONG으로 응답)
+    PACKET_TYPE_HELLO_ACK          = 104, // 연결 협상 응답 (합의한 기능 전달)
     // (필요 시 기능 추가 가능)
 } PacketType;
 
+// ======== 연결 협상 (HELLO / HELLO_ACK) ========
+// 클라이언트가 SET_ID 전에 HELLO로 지원 범위를 알리면 서버가 양쪽이 지원하는 조합을 골라 HELLO_ACK로 응답
+// 두 패킷은 항상 v1 프레임으로 보내고, 합의 결과는 양쪽 모두 HELLO_ACK 다음 프레임부터 적용
+// HELLO를 보내지 않은 클라이언트에는 기존과 같이 수신 프레임의 버전/플래그를 보고 응답 방식을 정함
+#define PACKET_VERSION_MAX     2     // 지원하는 최고 프레임 버전
+#define HELLO_PAYLOAD_LEN      8     // 버전, 체크섬, 압축, 기능 각 1바이트 + 최대 메시지 길이 4바이트 (네트워크 바이트 순서)
+#define HELLO_CHECKSUM_XOR     0x01  // 1바이트 XOR (모든 버전)
+#define HELLO_CHECKSUM_CRC32C  0x02  // CRC32C (v2 전용, PACKET_FLAG_CRC32C)
+#define HELLO_COMPRESS_LZ4     0x01  // 내장 사전 1판을 쓰는 LZ4 블록 (v2 전용, PACKET_FLAG_LZ4)
+#define HELLO_FEATURE_BATCH    0x01  // 대화 기록 등 여러 줄 응답을 큰 메시지 하나로 묶어 전송 (v2 전용)
+#define HELLO_FEATURE_PING     0x02  // 서버 PING에 PONG으로 응답 (이 세션만 하트비트/유휴 종료 대상, 모든 버전)
+#define HELLO_MIN_MESSAGE      4096  // 합의하는 최대 메시지 길이의 하한 (한 줄 응답은 항상 담을 수 있어야 함)
+
+// 협상 내용 (호스트 바이트 순서) - HELLO는 지원 범위, HELLO_ACK는 합의 결과
+typedef struct {
+    uint8_t version;       // HELLO: 지원하는 최고 버전 / ACK: 합의한 버전
+    uint8_t checksums;     // HELLO: 지원하는 HELLO_CHECKSUM_* 비트 / ACK: 선택한 1개
+    uint8_t compression;   // HELLO: 지원하는 압축 비트 / ACK: 선택한 1개 (0이면 압축 없음)
+    uint8_t features;      // HELLO: 지원하는 HELLO_FEATURE_* 비트 / ACK: 양쪽 모두 지원하는 비트
+    uint32_t max_message;  // HELLO: 받을 수 있는 메시지 최대 길이 / ACK: 양쪽 한도 중 작은 값
+} HelloInfo;
+
+// ======== 증분 프레임 디코더 ========
+#define FRAME_READ_BUFFER_SIZE 65536 // recv() 한 번에 읽을 권장 크기
+
+// 디코더 상태 - 헤더 수집 중 / 데이터+체크섬 수집 중
+typedef enum {
+    FRAME_STATE_HEADER,
+    FRAME_STATE_BODY
+} FrameState;
+
+// 디코딩된 헤더 (호스트 바이트 순서) - v1/v2 공통 표현
+typedef struct {
+    uint16_t magic;        // 매직 넘버 (v2도 REQ_MAGIC/RES_MAGIC으로 통일)
+    uint8_t type;          // 패킷 타입
+    uint8_t flags;         // PACKET_FLAG_* (v1은 0, 조립된 메시지는 MORE를 뺀 코덱 플래그)
+    uint8_t version;       // 프레임 버전 (1 또는 2)
+    uint32_t data_len;     // 데이터 길이 (조립된 메시지는 전체 길이, 압축된 메시지는 해제한 길이)
+} FrameHeader;
+
+// 디코딩된 프레임 (data는 다음 frame_decoder_next/feed 호출 전까지만 유효)
+typedef struct {
+    FrameHeader hdr;       // 호스트 바이트 순서로 변환된 헤더
+    unsigned char *data;   // NUL 종료된 데이터 (data_len == 0 이면 빈 문자열)
+    uint32_t checksum;     // 수신한 체크섬 (XOR 1바이트 또는 CRC32C, 조립된 메시지는 마지막 조각의 값)
+    int checksum_ok;       // 체크섬 일치 여부 (조립된 메시지는 모든 조각이 일치해야 1)
+} Frame;
+
+// 증분 프레임 디코더 - recv()가 돌려준 만큼 넣으면 완성된 프레임을 0개 이상 꺼냄
+typedef struct {
+    FrameState state;      // 현재 상태
+    FrameHeader hdr;       // 수집 완료된 헤더 (호스트 바이트 순서, BODY 상태에서 유효)
+    unsigned char *buf;    // 여러 번의 recv()에 걸친 프레임 조립 버퍼 (재사용)
+    size_t len;            // 조립 버퍼에 모인 바이트 수
+    size_t cap;            // 조립 버퍼 용량
+    size_t need;           // 현재 상태를 끝내기 위해 모아야 할 바이트 수
+    unsigned char *in;     // 현재 입력 (frame_decoder_feed로 설정, 제자리 NUL 종료를 위해 쓰기 가능)
+    size_t in_len;         // 입력 길이
+    size_t in_off;         // 입력에서 소비한 바이트 수
+    FrameHeader msg_hdr;   // 조립 중인 v2 메시지의 첫 조각 헤더
+    int msg_active;        // 조립 중인 메시지 여부
+    unsigned char *msg;    // 조각 조립 버퍼 (PACKET_MAX_MESSAGE + 1 바이트까지)
+    size_t msg_len;        // 조립된 바이트 수
+    size_t msg_cap;        // 조립 버퍼 용량
+    int msg_bad;           // 조립 중인 메시지에 체크섬이 틀린 조각이 있었는지 여부
+    unsigned char *plain;  // 압축 해제 버퍼 (PACKET_MAX_MESSAGE + 1 바이트까지)
+    size_t plain_cap;      // 압축 해제 버퍼 용량
+} FrameDecoder;
+
+// ======== scatter/gather 전송 ========
+#define PACKET_IOV_COUNT 3    // 패킷 1개당 iovec 수 (헤더, 데이터, 체크섬)
+#define PACKET_IOV_MAX   1024 // writev() 한 번에 넘길 최대 iovec 수 (리눅스 UIO_MAXIOV)
+
+// 패킷 앞뒤 프레이밍 저장소 - 데이터는 복사하지 않고 호출자 버퍼를 iovec로 직접 참조
+typedef struct {
+    PacketHeader hdr;          // 네트워크 바이트 순서 헤더
+    unsigned char checksum;    // 헤더 + 데이터 체크섬
+} PacketFraming;
+
+// ======== 공유 프레임 ========
+// 한 번 인코딩해 여러 수신자의 송신 경로가 함께 참조하는 불변 패킷 (참조 카운트로 해제)
+// 세션마다 코덱(체크섬 방식 등)이 다르면 같은 패킷의 다른 인코딩을 처음 필요할 때 한 번 만들어 원본에 매달아 공유
+typedef struct SharedFrame {
+    int refcount;          // 참조 수 (원자적으로 증감)
+    uint8_t codec;         // 인코딩에 사용한 코덱 플래그 (PACKET_CODEC_MASK 범위, v1 프레임은 0)
+    struct SharedFrame *variants;     // 다른 코덱 인코딩 목록 (원본이 참조 1개씩 보유, 추가만 가능)
+    struct SharedFrame *next_variant; // 같은 원본의 다음 인코딩
+    size_t len;            // 패킷 전체 길이 (헤더 + 데이터 + 체크섬)
+    unsigned char data[];  // 인코딩된 패킷
+} SharedFrame;
+
 // ======== 함수 프로토타입 ========
 ssize_t recv_all(int sock, void *buf, size_t len); // 지정된 길이만큼 정확히 recv()하도록 보장하는 함수
 ssize_t send_packet(int sock, 
@@ -54,5 +174,54 @@ ssize_t send_packet(int sock,
                 ); // 패킷 전송 함수
 
 unsigned char calculate_checksum(const unsigned char *header_and_data, size_t length); // 체크섬 계산 함수
+int packet_iov_init(PacketFraming *framing,
+                    struct iovec *iov,
+                    uint16_t magic,
+                    uint8_t type,
+                    const void *data,
+                    uint16_t data_len
+                ); // 패킷 1개를 iovec로 구성 (iov는 PACKET_IOV_COUNT개 이상, 사용한 iovec 수 반환)
+ssize_t send_iov_all(int sock, struct iovec *iov, int iovcnt); // iovec 배열 전체를 writev()로 전송 (iov는 전송 중 수정됨)
+unsigned char *encode_packet(uint16_t magic,
+                             uint8_t type,
+                             const void *data,
+                             uint16_t data_len,
+                             size_t *packet_len
+                ); // 패킷 인코딩 함수 (헤더 + 데이터 + 체크섬, 호출자가 free)
+
+
+SharedFrame *shared_frame_encode(uint16_t magic,
+                                 uint8_t type,
+                                 const void *data,
+                                 uint16_t data_len
+                ); // 공유 프레임 인코딩 (참조 수 1로 생성)
+SharedFrame *shared_frame_encode_v2(uint16_t magic,
+                                    uint8_t type,
+                                    const void *data,
+                                    size_t data_len,
+                                    uint8_t codec
+                ); // v2 공유 프레임 인코딩 (PACKET_V2_FRAGMENT_SIZE 조각들을 이어 붙인 버퍼 하나, magic은 REQ_MAGIC/RES_MAGIC)
+ssize_t send_packet_v2(int sock,
+                       uint16_t magic,
+                       uint8_t type,
+                       const void *data,
+                       size_t data_len,
+                       uint8_t codec
+                ); // v2 패킷 전송 (조각으로 나누어 전송, magic은 REQ_MAGIC/RES_MAGIC, codec은 PACKET_CODEC_MASK 범위 플래그)
+void packet_set_compress_min(size_t len); // 압축 최소 길이 설정 (PACKET_FLAG_LZ4 코덱 인코딩에 적용)
+SharedFrame *shared_frame_variant(SharedFrame *frame, uint8_t codec); // 같은 패킷의 codec 인코딩 참조 반환 (없으면 v1 원본에서 만들어 공유, 실패 시 NULL)
+SharedFrame *shared_frame_ref(SharedFrame *frame);   // 참조 추가
+void shared_frame_release(SharedFrame *frame);       // 참조 해제 (마지막 참조이면 메모리 해제)
+
+void frame_decoder_init(FrameDecoder *dec);  // 디코더 초기화
+void frame_decoder_reset(FrameDecoder *dec); // 조립 중인 프레임 폐기 (버퍼는 유지)
+void frame_decoder_free(FrameDecoder *dec);  // 조립 버퍼 해제
+void frame_decoder_feed(FrameDecoder *dec, unsigned char *buf, size_t len); // 새 입력 설정 (이전 입력은 모두 소비되어야 함)
+int frame_decoder_next(FrameDecoder *dec, Frame *frame); // 완성된 프레임 1개 꺼내기 (v2 조각은 조립 후) - 1: 프레임, 0: 입력 부족, -1: 메모리 부족/프로토콜 위반
+
+void hello_encode(const HelloInfo *info, unsigned char *buf); // HELLO/HELLO_ACK 데이터 인코딩 (buf는 HELLO_PAYLOAD_LEN 바이트)
+int hello_decode(const unsigned char *buf, size_t len, HelloInfo *info); // 디코딩 (뒤에 붙은 바이트는 무시, 짧으면 -1)
+void hello_negotiate(const HelloInfo *offer, const HelloInfo *local, HelloInfo *agreed); // 양쪽 지원 범위로 합의 결과 계산
+uint8_t hello_codec(const HelloInfo *agreed); // 합의 결과에 해당하는 프레임 코덱 플래그 (PACKET_CODEC_MASK 범위)
 
 #endif // CHAT_PROTOCOL_H
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include <string.h>
+#include "chat_shm.h"
+
+// ============ 공유 메모리 영역 ============
+// 영역 전체 크기 계산 함수 - 헤더 + 방향별 링 데이터 2개
+size_t shm_region_size(uint32_t ring_size) {
+    return sizeof(ShmRegion) + 2 * (size_t)ring_size;
+}
+
+// 영역 헤더 초기화 함수 - 영역을 만든 쪽(서버)이 상대에게 넘기기 전에 한 번 호출
+void shm_region_init(ShmRegion *region, uint32_t ring_size) {
+    memset(region, 0, sizeof(*region));
+    region->magic = SHM_REGION_MAGIC;
+    region->version = SHM_REGION_VERSION;
+    region->ring_size = ring_size;
+}
+
+// 링 데이터 시작 주소 반환 함수
+unsigned char *shm_ring_data(ShmRegion *region, int rx) {
+    return (unsigned char *)region + sizeof(ShmRegion) + (rx ? region->ring_size : 0);
+}
+
+// ============ SPSC 링 ============
+// 레코드 하나가 차지하는 크기 (레코드 헤더 + 패킷, 정렬 단위로 올림)
+static uint64_t shm_record_size(uint32_t len) {
+    return ((uint64_t)sizeof(ShmRecordHdr) + len + SHM_RECORD_ALIGN - 1) & ~(uint64_t)(SHM_RECORD_ALIGN - 1);
+}
+
+// 링에 복사 (끝을 넘으면 앞으로 이어서 복사)
+static void shm_copy_in(unsigned char *data, uint32_t size, uint64_t pos, const void *src, uint32_t n) {
+    uint32_t off = (uint32_t)(pos & (size - 1));
+    uint32_t first = n < size - off ? n : size - off;
+    memcpy(data + off, src, first);
+    memcpy(data, (const unsigned char *)src + first, n - first);
+}
+
+// 링에서 복사 (끝을 넘으면 앞에서 이어서 복사)
+static void shm_copy_out(const unsigned char *data, uint32_t size, uint64_t pos, void *dst, uint32_t n) {
+    uint32_t off = (uint32_t)(pos & (size - 1));
+    uint32_t first = n < size - off ? n : size - off;
+    memcpy(dst, data + off, first);
+    memcpy((unsigned char *)dst + first, data, n - first);
+}
+
+// 레코드 쓰기 함수 (생산자 전용) - 공간이 없으면 기다리지 않고 버림 (느린 소비자가 생산자를 막지 않도록)
+// 반환: 1 (기록됨, 소비자가 대기 중이므로 eventfd로 깨워야 함), 0 (기록됨), -1 (공간 부족으로 버림)
+int shm_ring_write(ShmRingCtl *ctl, unsigned char *data, uint32_t size, uint32_t room_no, const void *packet, uint32_t len) {
+    uint64_t need = shm_record_size(len);
+    uint64_t head = ctl->head; // 생산자만 변경하므로 일반 읽기
+    uint64_t tail = __atomic_load_n(&ctl->tail, __ATOMIC_ACQUIRE);
+
+    uint64_t used = head - tail;
+    if (used > size || need > size - used) { // used > size: 상대가 소비 위치를 잘못 기록한 경우
+        __atomic_store_n(&ctl->dropped, ctl->dropped + 1, __ATOMIC_RELAXED);
+        return -1;
+    }
+
+    ShmRecordHdr rec = { .len = len, .room_no = room_no };
+    shm_copy_in(data, size, head, &rec, sizeof(rec));
+    shm_copy_in(data, size, head + sizeof(rec), packet, len);
+    __atomic_store_n(&ctl->head, head + need, __ATOMIC_RELEASE); // 레코드 내용이 위치보다 먼저 보이도록
+
+    // 위치 게시 후 대기 표시 확인 (소비자의 "대기 표시 후 재확인"과 짝을 이뤄 깨우기를 놓치지 않음)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ctl->waiting, __ATOMIC_RELAXED) && __atomic_exchange_n(&ctl->waiting, 0, __ATOMIC_SEQ_CST)) {
+        return 1;
+    }
+    return 0;
+}
+
+// 레코드 읽기 함수 (소비자 전용) - 패킷을 buf에 복사하고 rec에 레코드 헤더 저장
+// 반환: 1 (레코드), 0 (비어있음), -1 (buf보다 크거나 손상된 레코드 - 건너뜀)
+int shm_ring_read(ShmRingCtl *ctl, unsigned char *data, uint32_t size, ShmRecordHdr *rec, void *buf, uint32_t buf_cap) {
+    uint64_t tail = ctl->tail; // 소비자만 변경하므로 일반 읽기
+    uint64_t head = __atomic_load_n(&ctl->head, __ATOMIC_ACQUIRE);
+    if (head == tail) return 0;
+
+    shm_copy_out(data, size, tail, rec, sizeof(*rec));
+    uint64_t need = shm_record_size(rec->len);
+    if (rec->len > size || need > head - tail) {
+        // 상대가 잘못된 레코드를 썼으면 남은 내용을 모두 버리고 다시 맞춤
+        __atomic_store_n(&ctl->tail, head, __ATOMIC_RELEASE);
+        return -1;
+    }
+    if (rec->len > buf_cap) {
+        __atomic_store_n(&ctl->tail, tail + need, __ATOMIC_RELEASE);
+        return -1;
+    }
+
+    shm_copy_out(data, size, tail + sizeof(*rec), buf, rec->len);
+    __atomic_store_n(&ctl->tail, tail + need, __ATOMIC_RELEASE); // 복사가 끝난 뒤 공간 반환
+    return 1;
+}
+
+// 대기 준비 함수 (소비자 전용) - 대기 표시 후 링을 다시 확인 (표시 전에 들어온 레코드를 놓치지 않도록)
+// 반환: 0 (비어있음 - eventfd 대기 가능), 1 (레코드가 남아있음 - 대기 표시를 해제하고 계속 읽어야 함)
+int shm_ring_prepare_wait(ShmRingCtl *ctl) {
+    __atomic_store_n(&ctl->waiting, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ctl->head, __ATOMIC_ACQUIRE) != ctl->tail) {
+        __atomic_store_n(&ctl->waiting, 0, __ATOMIC_SEQ_CST);
+        return 1;
+    }
+    return 0;
+}
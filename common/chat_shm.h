@@ -0,0 +1,52 @@
+// common/chat_shm.h - 공유 메모리 링 전송 정의 헤더
+#ifndef CHAT_SHM_H
+#define CHAT_SHM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ======== 공유 메모리 영역 ========
+// 영역 구성: [ShmRegion 헤더][tx 링 데이터 ring_size 바이트][rx 링 데이터 ring_size 바이트]
+// tx: 서버 -> 사이드카, rx: 사이드카 -> 서버 (방향마다 생산자/소비자가 하나씩인 SPSC 링)
+#define SHM_REGION_MAGIC    0x43534852u // "CSHR"
+#define SHM_REGION_VERSION  1
+#define SHM_RING_MIN_SIZE   65536       // 최소 링 크기 (최대 프레임 1개 이상 수용)
+#define SHM_RECORD_ALIGN    8           // 레코드 정렬 단위 (레코드 헤더가 링 끝에서 잘리지 않도록)
+
+// 링 제어 블록 - 생산자 위치와 소비자 위치를 서로 다른 캐시 라인에 두어 거짓 공유 방지
+typedef struct {
+    uint64_t head __attribute__((aligned(64))); // 생산자가 다음에 쓸 위치 (누적 바이트, 생산자만 증가)
+    uint64_t dropped;                   // 공간 부족으로 버린 레코드 수 (생산자만 증가)
+    uint64_t tail __attribute__((aligned(64))); // 소비자가 다음에 읽을 위치 (누적 바이트, 소비자만 증가)
+    uint32_t waiting;                   // 소비자가 eventfd 대기 중인지 여부 (생산자가 깨울지 결정)
+} ShmRingCtl;
+
+// 공유 메모리 영역 헤더 (링 데이터는 헤더 바로 뒤)
+typedef struct {
+    uint32_t magic;                     // SHM_REGION_MAGIC
+    uint32_t version;                   // SHM_REGION_VERSION
+    uint32_t ring_size;                 // 방향별 링 데이터 크기 (2의 거듭제곱)
+    uint32_t reserved;
+    ShmRingCtl tx;                      // 서버 -> 사이드카 링 제어 블록
+    ShmRingCtl rx;                      // 사이드카 -> 서버 링 제어 블록
+} __attribute__((aligned(64))) ShmRegion;
+
+// 링 레코드 헤더 - 뒤에 chat_protocol.h 패킷 1개(헤더 + 데이터 + 체크섬)가 그대로 이어짐
+typedef struct {
+    uint32_t len;                       // 패킷 길이 (레코드 헤더 제외, 정렬 패딩 제외)
+    uint32_t room_no;                   // 패킷이 속한 대화방 번호 (0: 대화방 무관)
+} ShmRecordHdr;
+
+// ======== 함수 프로토타입 ========
+size_t shm_region_size(uint32_t ring_size);                 // 영역 전체 크기 (헤더 + 링 2개)
+void shm_region_init(ShmRegion *region, uint32_t ring_size); // 영역 헤더 초기화 (생성한 쪽에서 한 번)
+unsigned char *shm_ring_data(ShmRegion *region, int rx);     // 링 데이터 시작 주소 (rx: 0이면 tx 링)
+int shm_ring_write(ShmRingCtl *ctl, unsigned char *data, uint32_t size,
+                   uint32_t room_no, const void *packet, uint32_t len
+                ); // 레코드 쓰기 (생산자) - 1: 소비자를 깨워야 함, 0: 기록됨, -1: 공간 부족으로 버림
+int shm_ring_read(ShmRingCtl *ctl, unsigned char *data, uint32_t size,
+                  ShmRecordHdr *rec, void *buf, uint32_t buf_cap
+                ); // 레코드 읽기 (소비자) - 1: 레코드, 0: 비어있음, -1: buf보다 커서 건너뜀
+int shm_ring_prepare_wait(ShmRingCtl *ctl); // 대기 표시 후 재확인 (소비자) - 0: 대기 가능, 1: 레코드가 남아있음 (대기 표시 해제됨)
+
+#endif // CHAT_SHM_H
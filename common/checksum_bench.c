@@ -0,0 +1,177 @@
+// common/checksum_bench.c - 체크섬 구현별 처리량 측정 (make bench)
+// 사용법: ./checksum_bench [측정당 MB (기본값 256)]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include "chat_checksum.h"
+
+#define BENCH_MAX_SIZE  65536                   // 최대 프레임 크기
+#define BENCH_ALIGN     64                      // 버퍼 정렬 (캐시 라인)
+
+static const size_t bench_sizes[] = { 16, 64, 256, 1024, 4096, 16384, 65536 };
+static const char *xor_impls[] = { "scalar", "sse2", "avx2", NULL }; // NULL: 자동 선택
+static const char *crc_impls[] = { "table", "sse4.2" };
+
+#define BENCH_COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+static volatile uint32_t g_sink;                // 계산 결과 (최적화로 제거되지 않도록)
+
+// 기존 calculate_checksum과 같은 바이트 단위 XOR 루프 (비교 기준, 컴파일러 자동 벡터화 없이)
+__attribute__((noinline, optimize("no-tree-vectorize")))
+static unsigned char xor_byte_loop(const unsigned char *p, size_t len) {
+    unsigned char cs = 0;
+    for (size_t i = 0; i < len; i++) {
+        cs ^= p[i];
+    }
+    return cs;
+}
+
+// 단조 시계 기준 현재 시각 (초)
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// 측정 종류
+typedef enum { BENCH_BYTE_LOOP, BENCH_XOR, BENCH_CRC32C } BenchKind;
+
+// size 바이트 프레임을 total 바이트만큼 반복 계산한 처리량 (GB/s)
+static double bench_run(BenchKind kind, const unsigned char *buf, size_t size, size_t total) {
+    size_t iters = total / size;
+    if (iters == 0) iters = 1;
+    uint32_t acc = 0;
+    double start = bench_now();
+    for (size_t i = 0; i < iters; i++) {
+        switch (kind) {
+            case BENCH_BYTE_LOOP: acc += xor_byte_loop(buf, size); break;
+            case BENCH_XOR:       acc += xor_checksum(buf, size); break;
+            case BENCH_CRC32C:    acc += crc32c(0, buf, size); break;
+        }
+    }
+    double elapsed = bench_now() - start;
+    g_sink = acc;
+    return elapsed > 0 ? (double)iters * (double)size / elapsed / 1e9 : 0;
+}
+
+// 모든 XOR 구현이 바이트 단위 루프와 같은 값을 내는지 확인 (정렬/길이 조합)
+static int bench_verify(const unsigned char *buf) {
+    for (size_t k = 0; k + 1 < BENCH_COUNT(xor_impls); k++) {
+        if (xor_checksum_force(xor_impls[k]) < 0) continue;
+        for (size_t off = 0; off < BENCH_ALIGN; off++) {
+            for (size_t len = 0; len <= 1024; len++) {
+                if (xor_checksum(buf + off, len) != xor_byte_loop(buf + off, len)) {
+                    fprintf(stderr, "mismatch: %s offset %zu length %zu\n", xor_impls[k], off, len);
+                    return -1;
+                }
+            }
+        }
+        if (xor_checksum(buf + 1, BENCH_MAX_SIZE) != xor_byte_loop(buf + 1, BENCH_MAX_SIZE)) {
+            fprintf(stderr, "mismatch: %s length %d\n", xor_impls[k], BENCH_MAX_SIZE);
+            return -1;
+        }
+    }
+    xor_checksum_force(NULL);
+    return 0;
+}
+
+// 모든 CRC32C 구현이 테이블 방식과 같은 값을 내는지 확인 (표준 검사 값 + 정렬/길이 조합)
+static int bench_verify_crc32c(const unsigned char *buf) {
+    crc32c_force("table");
+    if (crc32c(0, "123456789", 9) != 0xe3069283u) {
+        fprintf(stderr, "mismatch: table check value %08x\n", crc32c(0, "123456789", 9));
+        return -1;
+    }
+    for (size_t k = 1; k < BENCH_COUNT(crc_impls); k++) {
+        if (crc32c_force(crc_impls[k]) < 0) continue;
+        for (size_t off = 0; off < BENCH_ALIGN; off++) {
+            for (size_t len = 0; len <= 1024; len++) {
+                uint32_t got = crc32c(0, buf + off, len);
+                crc32c_force("table");
+                uint32_t want = crc32c(0, buf + off, len);
+                crc32c_force(crc_impls[k]);
+                if (got != want) {
+                    fprintf(stderr, "mismatch: %s offset %zu length %zu\n", crc_impls[k], off, len);
+                    crc32c_force(NULL);
+                    return -1;
+                }
+            }
+        }
+        uint32_t got = crc32c(0, buf + 1, BENCH_MAX_SIZE);
+        crc32c_force("table");
+        if (got != crc32c(0, buf + 1, BENCH_MAX_SIZE)) {
+            fprintf(stderr, "mismatch: %s length %d\n", crc_impls[k], BENCH_MAX_SIZE);
+            crc32c_force(NULL);
+            return -1;
+        }
+    }
+    crc32c_force(NULL);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    size_t total = 256u << 20;
+    if (argc > 1 && atoi(argv[1]) > 0) total = (size_t)atoi(argv[1]) << 20;
+
+    unsigned char *buf = aligned_alloc(BENCH_ALIGN, BENCH_MAX_SIZE + BENCH_ALIGN);
+    if (!buf) {
+        perror("aligned_alloc");
+        return EXIT_FAILURE;
+    }
+    srand(1);
+    for (size_t i = 0; i < BENCH_MAX_SIZE + BENCH_ALIGN; i++) buf[i] = (unsigned char)rand();
+
+    if (bench_verify(buf) < 0) {
+        free(buf);
+        return EXIT_FAILURE;
+    }
+    printf("XOR results identical to byte loop for all implementations.\n");
+    if (bench_verify_crc32c(buf) < 0) {
+        free(buf);
+        return EXIT_FAILURE;
+    }
+    printf("CRC32C results identical to table for all implementations.\n\n");
+
+    // XOR 체크섬
+    printf("XOR checksum (GB/s, %zu MB per cell, auto = %s)\n", total >> 20, xor_checksum_impl());
+    printf("%8s %10s", "size", "byte-loop");
+    for (size_t k = 0; k < BENCH_COUNT(xor_impls); k++) printf(" %10s", xor_impls[k] ? xor_impls[k] : "auto");
+    printf("\n");
+    for (size_t s = 0; s < BENCH_COUNT(bench_sizes); s++) {
+        printf("%8zu %10.2f", bench_sizes[s], bench_run(BENCH_BYTE_LOOP, buf, bench_sizes[s], total));
+        for (size_t k = 0; k < BENCH_COUNT(xor_impls); k++) {
+            if (xor_checksum_force(xor_impls[k]) < 0) {
+                printf(" %10s", "n/a");
+                continue;
+            }
+            printf(" %10.2f", bench_run(BENCH_XOR, buf, bench_sizes[s], total));
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    xor_checksum_force(NULL);
+
+    // CRC32C
+    printf("\nCRC32C (GB/s, %zu MB per cell, auto = %s)\n", total >> 20, crc32c_impl());
+    printf("%8s", "size");
+    for (size_t k = 0; k < BENCH_COUNT(crc_impls); k++) printf(" %10s", crc_impls[k]);
+    printf("\n");
+    for (size_t s = 0; s < BENCH_COUNT(bench_sizes); s++) {
+        printf("%8zu", bench_sizes[s]);
+        for (size_t k = 0; k < BENCH_COUNT(crc_impls); k++) {
+            if (crc32c_force(crc_impls[k]) < 0) {
+                printf(" %10s", "n/a");
+                continue;
+            }
+            printf(" %10.2f", bench_run(BENCH_CRC32C, buf, bench_sizes[s], total));
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    crc32c_force(NULL);
+
+    free(buf);
+    return EXIT_SUCCESS;
+}
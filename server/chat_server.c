@@ -1,26 +1,54 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+#include <stdarg.h>
 #include <pthread.h>
 #include <unistd.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <sys/epoll.h>
 #include <errno.h>
 #include <time.h>
 #include <signal.h>
 #include <sqlite3.h>
 #include "chat_server.h"
+#include "event_loop.h"
+#include "uring_loop.h"
+#include "out_queue.h"
+#include "hash_index.h"
+#include "epoch.h"
+#include "room_actor.h"
+#include "shm_tap.h"
 
 // ================== 전역 변수 초기화 ===================
 User *g_users = NULL; // 사용자 목록
+static User *g_users_tail = NULL; // 사용자 목록 끝 (O(1) 추가)
+static HashIndex g_users_by_sock = { .key = HASH_KEY_USER_SOCK }; // 소켓 번호 -> 사용자 해시 인덱스
+static HashIndex g_users_by_id = { .key = HASH_KEY_USER_ID };     // 사용자 ID -> 사용자 해시 인덱스
+static Room *g_rooms_tail = NULL; // 대화방 목록 끝 (O(1) 추가)
+static HashIndex g_rooms_by_no = { .key = HASH_KEY_ROOM_NO };     // 대화방 번호 -> 대화방 해시 인덱스
+static HashIndex g_rooms_by_name = { .key = HASH_KEY_ROOM_NAME }; // 대화방 이름 -> 대화방 해시 인덱스
+unsigned long g_conn_count = 0; // 현재 연결 수 (ID 설정 전 세션 포함, 원자적으로 증감)
 Room *g_rooms = NULL; // 대화방 목록
 int g_server_sock = -1; // 서버 소켓
+int g_unix_sock = -1; // 유닉스 도메인 리스닝 소켓 (같은 호스트의 봇/브리지용)
+static char g_unix_path[UNIX_PATH_MAX_LEN]; // 유닉스 도메인 소켓 파일 경로 (종료 시 삭제, 추상 네임스페이스면 빈 문자열)
 int g_epfd = -1; // epoll 디스크립터
+IoMode g_io_mode = IO_MODE_THREAD; // 클라이언트 I/O 처리 방식
+int g_room_snapshots = 0; // 멤버 스냅샷 모드 여부 (브로드캐스트가 대화방 뮤텍스 대신 에포크 읽기 구역 사용)
+int g_listen_backlog = LISTEN_BACKLOG_DEFAULT; // listen() 대기열 길이
+int g_reuseport = 0; // 루프별 SO_REUSEPORT 리스너 모드 여부 (커널이 접속을 루프별 리스너에 분산)
+uint64_t g_handshake_ticks = 0; // 핸드셰이크 기한 (틱)
+uint64_t g_ping_ticks = 0; // 하트비트 간격 (틱)
+uint64_t g_idle_ticks = 0; // 유휴 연결 종료 시간 (틱)
+static int g_timer_fd = -1; // 타이머 휠 timerfd (메인 epoll에 등록)
 unsigned int g_next_room_no = 1; // 다음 대화방 고유 번호
 
 pthread_mutex_t g_users_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t g_rooms_mutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_rwlock_t g_rooms_lock = PTHREAD_RWLOCK_INITIALIZER; // 잠금 순서: g_rooms_lock -> room->mutex -> outq.mutex
 pthread_mutex_t g_db_mutex    = PTHREAD_MUTEX_INITIALIZER;
 
 // =================== 서버 명령어 테이블 ===================
@@ -57,8 +85,8 @@ void send_usage(User *user, const char *usage) {
     if (user && usage) {
         char msg[BUFFER_SIZE];
         snprintf(msg, sizeof(msg), " %s\n", usage);
-        send_packet(
-            user->sock,
+        user_send_packet(
+            user,
             RES_MAGIC,
             PACKET_TYPE_USAGE,
             msg,
@@ -72,8 +100,8 @@ void send_error(User *user, const char *error_msg) {
     if (user && error_msg) {
         char msg[BUFFER_SIZE];
         snprintf(msg, sizeof(msg), " Error: %s\n", error_msg);
-        send_packet(
-            user->sock,
+        user_send_packet(
+            user,
             RES_MAGIC,
             PACKET_TYPE_ERROR,
             msg,
@@ -83,27 +111,27 @@ void send_error(User *user, const char *error_msg) {
 }
 
 // ============ 목록 / 대화방 내부 관리 함수 구현(동기화 미포함 - unlocked 버전) ===========
-// 사용자 추가 함수 (전역 사용자 목록에 단순 연결)
+// 사용자 추가 함수 (전역 사용자 목록 끝에 연결 및 소켓/ID 해시 인덱스 등록)
 void list_add_user_unlocked(User *user) {
-    if (g_users == NULL) {
+    user->next = NULL;
+    user->prev = g_users_tail;
+    if (g_users_tail) {
+        g_users_tail->next = user;
+    } else {
         // 사용자 목록이 비어있는 경우
         g_users = user;
-        user->next = NULL;
-        user->prev = NULL;
-    } else {
-        User *current = g_users;
-        while (current->next) {
-            current = current->next;
-        }
-        current->next = user;
-        user->prev = current;
-        user->next = NULL;
+    }
+    g_users_tail = user;
+
+    if (hash_index_insert(&g_users_by_sock, user) < 0 || hash_index_insert(&g_users_by_id, user) < 0) {
+        fprintf(stderr, "[ERROR] Failed to index user %s (sock=%d).\n", user->id, user->sock);
     }
 }
 
-// 사용자 제거 함수 (전역 사용자 목록에서 단순 연결 해제)
+// 사용자 제거 함수 (전역 사용자 목록에서 연결 해제 및 인덱스 제거)
 void list_remove_user_unlocked(User *user) {
     if (user == NULL) return;
+    if (!user->prev && g_users != user) return; // 목록에 없는 사용자 (ID 설정 전 종료 등)
     if (user->prev) {
         user->prev->next = user->next;
     } else {
@@ -111,58 +139,58 @@ void list_remove_user_unlocked(User *user) {
     }
     if (user->next) {
         user->next->prev = user->prev;
+    } else {
+        g_users_tail = user->prev;
     }
     user->prev = NULL;
     user->next = NULL;
+
+    hash_index_remove(&g_users_by_sock, user);
+    hash_index_remove(&g_users_by_id, user);
 }
 
-// 소켓으로 사용자 검색 함수 (전역 사용자 목록에서 단순 검색)
+// 소켓으로 사용자 검색 함수 (해시 인덱스, O(1))
 User *find_user_by_sock_unlocked(int sock) {
-    User *current = g_users;
-    // 사용자 목록을 순회하며 소켓 번호로 검색
-    while (current != NULL) {
-        if (current->sock == sock) {
-            return current;
-        }
-        current = current->next;
-    }
-    return NULL;
+    return hash_index_find_user_sock(&g_users_by_sock, sock);
 }
 
-// 사용자 ID로 사용자 검색 함수 (전역 사용자 목록에서 단순 검색)
+// 사용자 ID로 사용자 검색 함수 (해시 인덱스, O(1))
 User *find_user_by_id_unlocked(const char *id) {
-    User *current = g_users;
-    // 사용자 목록을 순회하며 ID로 검색
-    while (current != NULL) {
-        if (strcmp(current->id, id) == 0) {
-            return current;
-        }
-        current = current->next;
+    return hash_index_find_user_id(&g_users_by_id, id);
+}
+
+// 사용자 ID 변경 함수 - 목록에 등록된 사용자면 ID 인덱스도 갱신
+void rename_user_unlocked(User *user, const char *new_id) {
+    int listed = user->prev || g_users == user;
+    if (listed) hash_index_remove(&g_users_by_id, user);
+    strncpy(user->id, new_id, sizeof(user->id) - 1);
+    user->id[sizeof(user->id) - 1] = '\0';
+    if (listed && hash_index_insert(&g_users_by_id, user) < 0) {
+        fprintf(stderr, "[ERROR] Failed to index user %s (sock=%d).\n", user->id, user->sock);
     }
-    return NULL;
 }
 
-// 대화방 추가 함수 (전역 대화방 목록에 단순 연결)
+// 대화방 추가 함수 (전역 대화방 목록 끝에 연결 및 번호/이름 해시 인덱스 등록)
 void list_add_room_unlocked(Room *room) {
-    if (g_rooms == NULL) {
+    room->next = NULL;
+    room->prev = g_rooms_tail;
+    if (g_rooms_tail) {
+        g_rooms_tail->next = room;
+    } else {
         // 대화방 목록이 비어있는 경우
         g_rooms = room;
-        room->next = NULL;
-        room->prev = NULL;
-    } else {
-        Room *current = g_rooms;
-        while (current->next) {
-            current = current->next;
-        }
-        current->next = room;
-        room->prev = current;
-        room->next = NULL;
+    }
+    g_rooms_tail = room;
+
+    if (hash_index_insert(&g_rooms_by_no, room) < 0 || hash_index_insert(&g_rooms_by_name, room) < 0) {
+        fprintf(stderr, "[ERROR] Failed to index room %s (ID: %u).\n", room->room_name, room->no);
     }
 }
 
-// 대화방 제거 함수 (전역 대화방 목록에서 단순 연결 해제)
+// 대화방 제거 함수 (전역 대화방 목록에서 연결 해제 및 인덱스 제거)
 void list_remove_room_unlocked(Room *room) {
     if (room == NULL) return;
+    if (!room->prev && g_rooms != room) return; // 목록에 없는 대화방
     if (room->prev) {
         room->prev->next = room->next;
     } else {
@@ -170,132 +198,129 @@ void list_remove_room_unlocked(Room *room) {
     }
     if (room->next) {
         room->next->prev = room->prev;
+    } else {
+        g_rooms_tail = room->prev;
     }
     room->prev = NULL;
     room->next = NULL;
+
+    hash_index_remove(&g_rooms_by_no, room);
+    hash_index_remove(&g_rooms_by_name, room);
 }
 
-// 대화방 이름으로 대화방 검색 함수 (전역 대화방 목록에서 단순 검색)
+// 대화방 이름으로 대화방 검색 함수 (해시 인덱스, O(1))
 Room *find_room_unlocked(const char *name) {
-    Room *current = g_rooms;
-    while (current != NULL) {
-        // 대화방 이름 비교
-        if (strcmp(current->room_name, name) == 0) {
-            return current;
-        }
-        current = current->next;
-    }
-    return NULL;
+    return hash_index_find_room_name(&g_rooms_by_name, name);
 }
 
-// 대화방 번호로 대화방 검색 함수 (전역 대화방 목록에서 단순 검색)
+// 대화방 번호로 대화방 검색 함수 (해시 인덱스, O(1))
 Room *find_room_by_no_unlocked(unsigned int no) {
-    Room *current = g_rooms;
-    while (current != NULL) {
-        // 대화방 번호 비교
-        if (current->no == no) {
-            return current;
-        }
-        current = current->next;
+    return hash_index_find_room_no(&g_rooms_by_no, no);
+}
+
+// 대화방 이름 변경 함수 - 이름 중복 검사와 이름 인덱스 갱신을 함께 수행, 이미 있는 이름이면 -1 반환
+int rename_room_unlocked(Room *room, const char *new_name) {
+    Room *existing = find_room_unlocked(new_name);
+    if (existing) return existing == room ? 0 : -1;
+
+    hash_index_remove(&g_rooms_by_name, room);
+    strncpy(room->room_name, new_name, sizeof(room->room_name) - 1);
+    room->room_name[sizeof(room->room_name) - 1] = '\0';
+    if (hash_index_insert(&g_rooms_by_name, room) < 0) {
+        fprintf(stderr, "[ERROR] Failed to index room %s (ID: %u).\n", room->room_name, room->no);
     }
-    return NULL;
+    return 0;
+}
+
+// 대화방 메모리 해제 함수
+void free_room(Room *room) {
+    epoch_retire(room->snapshot, free); // 이전 스냅샷을 읽는 중인 브로드캐스트가 있을 수 있으므로 회수 대기
+    pthread_mutex_destroy(&room->mutex);
+    free(room->members);
+    free(room);
+}
+
+// 멤버 스냅샷 게시 함수 (스냅샷 모드, room->mutex 보유 상태에서 호출)
+// 현재 멤버 배열을 복사한 새 스냅샷으로 교체하고, 이전 스냅샷은 읽기 스레드가 모두 나간 뒤 해제
+static void room_publish_snapshot_unlocked(Room *room) {
+    if (!g_room_snapshots) return;
+
+    MemberSnapshot *snap = malloc(sizeof(*snap) + (size_t)room->member_count * sizeof(snap->members[0]));
+    if (snap) {
+        snap->count = room->member_count;
+        memcpy(snap->members, room->members, (size_t)room->member_count * sizeof(snap->members[0]));
+    } else {
+        perror("malloc for member snapshot failed"); // NULL 게시 - 브로드캐스트가 뮤텍스 경로로 대체
+    }
+
+    MemberSnapshot *old = __atomic_exchange_n(&room->snapshot, snap, __ATOMIC_SEQ_CST);
+    epoch_retire(old, free);
 }
 
-// 대화방에 사용자 추가 함수 (배열 + 링크드 리스트 동시 관리)
+// 대화방에 사용자 추가 함수 (멤버 배열 끝에 추가, O(1))
 void room_add_member_unlocked(Room *room, User *user) {
-    // 이미 방에 있는지 체크
-    for (int i = 0; i < MAX_CLIENT; i++) {
-        if (room->members[i] == user) {
-            printf("[INFO] User '%s' is already in room '%s'.\n", user->id, room->room_name);
-            return;
-        }
+    // 이미 방에 있는지 체크 (사용자가 기억하는 위치로 확인)
+    if (user->room == room && user->room_index >= 0 && user->room_index < room->member_count && room->members[user->room_index] == user) {
+        printf("[INFO] User '%s' is already in room '%s'.\n", user->id, room->room_name);
+        return;
     }
 
-    // 배열에 빈 슬롯 추가
-    int idx = -1;
-    for (int i = 0; i < MAX_CLIENT; i++) {
-        if (room->members[i] == NULL) {
-            idx = i;
-            break;
+    // 배열이 가득 찬 경우 두 배로 확장
+    if (room->member_count == room->member_cap) {
+        int new_cap = room->member_cap ? room->member_cap * 2 : ROOM_MEMBERS_INIT_CAP;
+        User **new_members = realloc(room->members, (size_t)new_cap * sizeof(*new_members));
+        if (!new_members) {
+            perror("realloc for room members failed");
+            return;
         }
-    }
-    if (idx < 0) {
-        printf("[ERROR] Room '%s' is full, cannot add member.\n", room->room_name);
-        fflush(stdout);
-        return; // 대화방이 가득 찬 경우
+        room->members = new_members;
+        room->member_cap = new_cap;
     }
 
     // 새 사용자 추가
-    room->members[idx] = user;
-    room->member_count++; // 대화방 참여자 수 증가
-
-    user->room_user_next = NULL;
-    user->room_user_prev = NULL;
-    if (room->member_count == 1) {
-        // 대화방에 참여자가 없는 경우
-        room->members[0] = user;
-    } else {
-        // 마지막 참여자 찾기
-        User *last = NULL;
-        for (int i = 0; i < MAX_CLIENT; i++) {
-            if (room->members[i] && room->members[i] != user && room->members[i]->room_user_next == NULL) {
-                last = room->members[i];
-            }
-        }
-        if (last) {
-            last->room_user_next = user;
-            user->room_user_prev = last;
-        }
-    }
+    user->room_index = room->member_count;
+    room->members[room->member_count++] = user; // 대화방 참여자 수 증가
     user->room = room; // 사용자 구조체에 대화방 정보 저장
+    room_publish_snapshot_unlocked(room);
 }
 
-// 대화방 사용자 제거 함수 (배열 + 링크드 리스트 동시 관리)
+// 대화방 사용자 제거 함수 (마지막 멤버를 빈 자리로 옮기는 swap-remove, O(1))
 void room_remove_member_unlocked(Room *room, User *user) {
     if (room == NULL || user == NULL) {
         printf("[ERROR] Invalid room or user pointer.\n");
         return;
     }
 
-    // 링크드 리스트 연결 해제
-    if (user->room_user_prev) {
-        user->room_user_prev->room_user_next = user->room_user_next;
-    } else {
-        room->members[0] = user->room_user_next;
-    }
-    if (user->room_user_next) {
-        user->room_user_next->room_user_prev = user->room_user_prev;
-    }
+    int idx = user->room_index;
+    if (idx < 0 || idx >= room->member_count || room->members[idx] != user) return; // 이 방의 멤버가 아님
 
-    // 배열 축소(슬롯 정리)
-    int idx = -1;
-    for (int i = 0; i < room->member_count; i++) {
-        if (room->members[i] == user) {
-            idx = i;
-            break;
-        }
-    }
-    if (idx >= 0) {
-        for (int j = idx; j < room->member_count - 1; j++) {
-            room->members[j] = room->members[j + 1];
-        }
-        room->members[room->member_count - 1] = NULL; // 마지막 요소 NULL로 설정
-    }
+    User *last = room->members[--room->member_count]; // 대화방 참여자 수 감소
+    room->members[idx] = last;
+    last->room_index = idx;
+    room->members[room->member_count] = NULL;
 
-    user->room_user_prev = NULL;
-    user->room_user_next = NULL;
+    user->room_index = -1;
     user->room = NULL; // 사용자 구조체에 대화방 정보 초기화
-    room->member_count--; // 대화방 참여자 수 감소
+    room_publish_snapshot_unlocked(room);
 }
 
-// 대화방이 비어있는 경우 제거 함수 (db 동기화 포함)
+// 대화방이 비어있는 경우 제거 함수 (db 동기화 포함, g_rooms_lock 쓰기 잠금 상태에서 호출)
 void destroy_room_if_empty_unlocked(Room *room) {
-    if (room->member_count <= 0) {
+    // 쓰기 잠금 중에는 새 참여가 불가능하므로 멤버 수 확인 후 바로 제거해도 안전
+    pthread_mutex_lock(&room->mutex);
+    int empty = room->member_count <= 0;
+    pthread_mutex_unlock(&room->mutex);
+
+    if (empty) {
         printf("[INFO] Room '%s' is empty, destroying.\n", room->room_name);
         fflush(stdout);
         db_remove_room(room); // 데이터베이스에서 대화방 제거
         list_remove_room_unlocked(room);
-        free(room);
+        if (room->owner) {
+            room_actor_destroy(room); // 액터 모드: 워커가 남은 명령을 처리한 뒤 해제
+        } else {
+            free_room(room);
+        }
     }
 }
 
@@ -330,33 +355,40 @@ User *find_user_by_id(const char *id) {
     return user;
 }
 
+// 사용자 ID 변경 함수
+void rename_user(User *user, const char *new_id) {
+    pthread_mutex_lock(&g_users_mutex);
+    rename_user_unlocked(user, new_id);
+    pthread_mutex_unlock(&g_users_mutex);
+}
+
 // 대화방 추가 함수
 void list_add_room(Room *room) {
-    pthread_mutex_lock(&g_rooms_mutex);
+    pthread_rwlock_wrlock(&g_rooms_lock);
     list_add_room_unlocked(room);
-    pthread_mutex_unlock(&g_rooms_mutex);
+    pthread_rwlock_unlock(&g_rooms_lock);
 }
 
 // 대화방 제거 함수
 void list_remove_room(Room *room) {
-    pthread_mutex_lock(&g_rooms_mutex);
+    pthread_rwlock_wrlock(&g_rooms_lock);
     list_remove_room_unlocked(room);
-    pthread_mutex_unlock(&g_rooms_mutex);
+    pthread_rwlock_unlock(&g_rooms_lock);
 }
 
 // 대화방 검색 함수
 Room *find_room(const char *name) {
-    pthread_mutex_lock(&g_rooms_mutex);
+    pthread_rwlock_rdlock(&g_rooms_lock);
     Room *room = find_room_unlocked(name);
-    pthread_mutex_unlock(&g_rooms_mutex);
+    pthread_rwlock_unlock(&g_rooms_lock);
     return room;
 }
 
 // 대화방 번호로 검색 함수
 Room *find_room_by_no(unsigned int no) {
-    pthread_mutex_lock(&g_rooms_mutex);
+    pthread_rwlock_rdlock(&g_rooms_lock);
     Room *room = find_room_by_no_unlocked(no);
-    pthread_mutex_unlock(&g_rooms_mutex);
+    pthread_rwlock_unlock(&g_rooms_lock);
     return room;
 }
 
@@ -377,121 +409,316 @@ void remove_user(User *user) {
     pthread_mutex_unlock(&g_users_mutex);
 
     db_update_user_connected(user, 0); // 데이터베이스에 연결 상태 업데이트
-    free(user); // 사용자 구조체 메모리 해제
+    destroy_client_session(user); // 사용자 구조체 메모리 해제
 }
 
-// 대화방 추가 래퍼 함수
-void add_room(Room *room) {
-    pthread_mutex_lock(&g_rooms_mutex);
+// 대화방 추가 래퍼 함수 - 성공 시 0, DB 생성 실패 시 -1 반환 (실패 시 room은 해제됨)
+int add_room(Room *room) {
+    pthread_rwlock_wrlock(&g_rooms_lock);
     list_add_room_unlocked(room);
-    pthread_mutex_unlock(&g_rooms_mutex);
+    pthread_rwlock_unlock(&g_rooms_lock);
 
     if (!db_create_room(room)) {
         // 데이터베이스에 대화방 생성 실패 시 롤백
-        pthread_mutex_lock(&g_rooms_mutex);
+        pthread_rwlock_wrlock(&g_rooms_lock);
         list_remove_room_unlocked(room);
-        pthread_mutex_unlock(&g_rooms_mutex);
+        pthread_rwlock_unlock(&g_rooms_lock);
         fprintf(stderr, "[ERROR] Failed to create room in database.\n");
-        free(room);
+        free_room(room);
+        return -1;
     }
+    return 0;
 }
 
 // 대화방 제거 래퍼 함수
 void remove_room(Room *room) {
-    pthread_mutex_lock(&g_rooms_mutex);
+    pthread_rwlock_wrlock(&g_rooms_lock);
     list_remove_room_unlocked(room); // 대화방 목록에서 제거
-    pthread_mutex_unlock(&g_rooms_mutex);
+    pthread_rwlock_unlock(&g_rooms_lock);
 
     db_remove_room(room); // 데이터베이스에서 대화방 정보 제거
-    free(room); // 대화방 구조체 메모리 해제
+    free_room(room); // 대화방 구조체 메모리 해제
 }
 
-// 대화방 참여자 추가 래퍼 함수
-void add_user_to_room(Room *room, User *user) {
-    pthread_mutex_lock(&g_rooms_mutex);
-    room_add_member_unlocked(room, user);
-    pthread_mutex_unlock(&g_rooms_mutex);
+// 대화방 참여 래퍼 함수 - 디렉터리 읽기 잠금으로 대화방 제거를 막은 채 대화방 뮤텍스만 잡고 멤버 추가
+// 다른 방의 참여/퇴장/브로드캐스트와 서로 막지 않음, 대화방이 없으면(이미 제거됨) NULL 반환
+Room *join_room(unsigned int no, User *user) {
+    pthread_rwlock_rdlock(&g_rooms_lock);
+    Room *room = find_room_by_no_unlocked(no);
+    if (room) {
+        if (room->owner) {
+            room_actor_join(room, user); // 액터 모드: 소유 워커가 추가 (완료 대기)
+        } else {
+            pthread_mutex_lock(&room->mutex);
+            room_add_member_unlocked(room, user);
+            pthread_mutex_unlock(&room->mutex);
+        }
 
-    db_add_user_to_room(room, user);
-    db_update_room_member_count(room);
+        if (user->room == room) {
+            db_add_user_to_room(room, user);
+            db_update_room_member_count(room);
+        } else {
+            room = NULL; // 멤버 배열 확장 실패
+        }
+    }
+    pthread_rwlock_unlock(&g_rooms_lock);
+    return room;
 }
 
-// 대화방 참여자 제거 래퍼 함수
-void remove_user_from_room(Room *room, User *user) {
-    pthread_mutex_lock(&g_rooms_mutex);
-    room_remove_member_unlocked(room, user); // 대화방 참여자 목록에서 사용자 제거
-    pthread_mutex_unlock(&g_rooms_mutex);
+// 대화방 참여자 제거 래퍼 함수 - 제거와 안내 브로드캐스트를 대화방 뮤텍스 안에서 함께 수행
+// notice가 있으면 남은 참여자(sender 제외)에게 전송, 마지막 참여자였으면 대화방 제거
+void remove_user_from_room(Room *room, User *user, User *sender, const char *notice) {
+    if (!room || !user) return;
+
+    SharedFrame *frame = NULL;
+    if (notice) {
+        frame = shared_frame_encode(RES_MAGIC, PACKET_TYPE_MESSAGE, notice, (uint16_t)strlen(notice));
+    }
+
+    // 읽기 잠금 동안은 다른 스레드가 대화방을 해제할 수 없음 (해제는 쓰기 잠금 필요)
+    pthread_rwlock_rdlock(&g_rooms_lock);
+    int empty;
+    if (room->owner) {
+        empty = room_actor_leave(room, user, sender, frame) == 0; // 액터 모드: 소유 워커가 제거 및 안내 (완료 대기)
+    } else {
+        pthread_mutex_lock(&room->mutex);
+        room_remove_member_unlocked(room, user); // 대화방 참여자 목록에서 사용자 제거
+        if (frame) {
+            for (int i = 0; i < room->member_count; i++) {
+                User *member = room->members[i];
+                if (member != sender && member->sock >= 0) {
+                    user_queue_frame(member, frame);
+                }
+            }
+        }
+        empty = room->member_count == 0;
+        pthread_mutex_unlock(&room->mutex);
+    }
 
+    unsigned int no = room->no;
     db_remove_user_from_room(room, user); // 데이터베이스에서 사용자 대화방 정보 제거
     db_update_room_member_count(room); // 데이터베이스에 대화방 멤버 수 업데이트
+    pthread_rwlock_unlock(&g_rooms_lock);
 
-    if (room->member_count == 0) {
-        db_remove_room(room); // 대화방이 비어있으면 데이터베이스에서 제거
-        pthread_mutex_lock(&g_rooms_mutex);
-        list_remove_room_unlocked(room); // 대화방 목록에서 제거
-        pthread_mutex_unlock(&g_rooms_mutex);
-        free(room); // 대화방 구조체 메모리 해제
-    }
+    if (frame) shared_frame_release(frame);
+    if (empty) destroy_room_if_empty(no); // 쓰기 잠금에서 다시 확인 (그 사이 다른 참여자가 들어왔을 수 있음)
 }
 
-// 대화방이 비어있는 경우 제거 래퍼 함수
-void destroy_room_if_empty(Room *room) {
-    pthread_mutex_lock(&g_rooms_mutex);
-    destroy_room_if_empty_unlocked(room);
-    pthread_mutex_unlock(&g_rooms_mutex);
+// 대화방이 비어있는 경우 제거 래퍼 함수 - 번호로 다시 찾아 이미 제거된 대화방은 건너뜀
+void destroy_room_if_empty(unsigned int no) {
+    pthread_rwlock_wrlock(&g_rooms_lock);
+    Room *room = find_room_by_no_unlocked(no);
+    if (room) destroy_room_if_empty_unlocked(room);
+    pthread_rwlock_unlock(&g_rooms_lock);
 }
 
 // ============ 브로드캐스트 함수 ============
-// 서버 메시지를 대화방 참여자에게 브로드캐스트 함수
-void broadcast_server_message_to_room(Room *room, User *sender, const char *message_text) {
-    if (!room || !message_text) return; // 대화방이 NULL이거나 메시지가 NULL인 경우
+// 공유 프레임을 대화방 참여자에게 브로드캐스트 함수 - 각 참여자의 송신 큐가 같은 프레임을 참조 (복사/재인코딩 없음)
+// 각 참여자의 송신 큐에 넣고 바로 반환하므로 느린 수신자가 다른 방을 막지 않음
+// 대화방 뮤텍스만 잡으므로 서로 다른 방의 브로드캐스트는 병렬로 진행
+// 스냅샷 모드에서는 게시된 스냅샷을 잠금 없이 순회하므로 같은 방의 참여/퇴장과도 서로 막지 않음
+// 액터 모드에서는 소유 워커에 전달하고 바로 반환 (워커가 대화방 순번 순서대로 전송)
+void broadcast_frame_to_room(Room *room, User *sender, SharedFrame *frame) {
+    if (!room || !frame) return;
+
+    if (g_shm_tap_count > 0) {
+        shm_tap_publish(room->no, frame); // 사이드카 tx 링에 기록 (대화방 전체 메시지 흐름)
+    }
+
+    if (room->owner) {
+        room_actor_post_frame(room, sender, frame);
+        return;
+    }
 
-    pthread_mutex_lock(&g_rooms_mutex);
-    User *member = room->members[0]; // 대화방 참여자 목록의 첫 번째 사용자
-    // 대화방 참여자 목록을 순회하며 서버 메시지 전송
-    while (member != NULL) {
+    if (g_room_snapshots) {
+        epoch_enter();
+        MemberSnapshot *snap = __atomic_load_n(&room->snapshot, __ATOMIC_ACQUIRE);
+        if (snap) {
+            for (int i = 0; i < snap->count; i++) {
+                User *member = snap->members[i];
+                if (member != sender && member->sock >= 0) {
+                    user_queue_frame(member, frame);
+                }
+            }
+            epoch_exit();
+            return;
+        }
+        epoch_exit();
+    }
+
+    pthread_mutex_lock(&room->mutex);
+    // 대화방 멤버 배열을 순회하며 프레임 전송
+    for (int i = 0; i < room->member_count; i++) {
+        User *member = room->members[i];
         if (member != sender && member->sock >= 0) {
-            send_packet(member->sock, RES_MAGIC, PACKET_TYPE_MESSAGE, message_text, (uint16_t)strlen(message_text));
+            user_queue_frame(member, frame);
         }
-        member = member->room_user_next;
     }
-    pthread_mutex_unlock(&g_rooms_mutex);
+    pthread_mutex_unlock(&room->mutex);
+}
+
+// 서버 메시지를 대화방 참여자에게 브로드캐스트 함수 - 한 번만 인코딩하여 모든 참여자가 공유
+void broadcast_server_message_to_room(Room *room, User *sender, const char *message_text) {
+    if (!room || !message_text) return; // 대화방이 NULL이거나 메시지가 NULL인 경우
+
+    SharedFrame *frame = shared_frame_encode(RES_MAGIC, PACKET_TYPE_MESSAGE, message_text, (uint16_t)strlen(message_text));
+    if (!frame) return;
+    broadcast_frame_to_room(room, sender, frame);
+    shared_frame_release(frame);
 }
 
 // ============ 클라이언트 세션 정리 함수 ============
+// 세션 소유 스레드(루프)에 소켓 종료를 통지하는 함수 - 남은 송신을 시도한 뒤 종료, 소켓 닫기/메모리 해제는 소유 스레드가 담당
+static void notify_session_close(User *user) {
+    if (g_io_mode == IO_MODE_URING) {
+        uring_loop_close_user(user); // 링에 쌓인 패킷을 먼저 보낸 뒤 종료
+    } else if (user->sock >= 0) {
+        user_flush_output(user); // 강퇴 안내 등 큐에 남은 패킷 전송 시도
+        shutdown(user->sock, SHUT_RDWR);
+    }
+}
+
+// 세션이 PING에 응답하는지 여부 (HELLO로 HELLO_FEATURE_PING을 합의했거나 PONG을 한 번이라도 보냄)
+static int session_heartbeat(User *user) {
+    return (__atomic_load_n(&user->features, __ATOMIC_RELAXED) & HELLO_FEATURE_PING) != 0;
+}
+
+// 세션 타이머의 다음 확인까지 남은 틱 계산 함수 (ID 설정 후, 0이면 더 확인하지 않음)
+// 하트비트를 지원하지 않는 세션은 PING/유휴 종료 없이 나중에 PONG을 보내는지만 주기적으로 확인
+static uint64_t session_timer_next(User *user, uint64_t now) {
+    if (!session_heartbeat(user)) return g_ping_ticks > 0 ? g_ping_ticks : g_idle_ticks;
+    uint64_t idle = now - __atomic_load_n(&user->last_active, __ATOMIC_RELAXED);
+    uint64_t next = g_ping_ticks;
+    if (g_idle_ticks > 0) {
+        uint64_t left = idle < g_idle_ticks ? g_idle_ticks - idle : 1;
+        if (next == 0 || left < next) next = left;
+    }
+    return next;
+}
+
+// 세션 타이머 종료 처리 함수 - 안내 후 소유 스레드에 종료 통지
+static void session_timer_close(User *user, const char *notice) {
+    printf("[INFO] %s (sock=%d, user=%s).\n", notice, user->sock, user->id[0] ? user->id : "-");
+    fflush(stdout);
+    user_send_packet(user, RES_MAGIC, PACKET_TYPE_SERVER_NOTICE, notice, (uint16_t)strlen(notice));
+    notify_session_close(user);
+}
+
+// 세션 타이머 만료 함수 (메인 스레드, 타이머 휠 뮤텍스 보유 상태)
+// ID 설정 전: 핸드셰이크 기한 확인 / 설정 후: 유휴 시간에 따라 PING 전송 또는 연결 종료 (하트비트 지원 세션만)
+// 수신마다 타이머를 다시 설정하지 않고 last_active만 기록하므로, 만료 시 실제 유휴 시간을 보고 남은 만큼 다시 설정
+static void session_timer_fire(void *arg) {
+    User *user = (User *)arg;
+    if (user->closing || user->sock < 0) return;
+    uint64_t now = timer_now();
+
+    if (user->id[0] == '\0') {
+        uint64_t elapsed = now - user->connect_tick;
+        if (g_handshake_ticks > 0 && elapsed >= g_handshake_ticks) {
+            session_timer_close(user, "Handshake timeout: no ID was set.");
+            return;
+        }
+        uint64_t next = g_handshake_ticks > 0 ? g_handshake_ticks - elapsed : session_timer_next(user, now);
+        if (next > 0) timer_arm_unlocked(&user->timer, next);
+        return;
+    }
+
+    // PING을 모르는 클라이언트(GTK, 이전 콘솔 클라이언트)는 PING을 채팅으로 표시하고 응답하지 않으므로
+    // 보내지 않고 유휴 종료도 하지 않음 - 끊긴 연결은 TCP keepalive로 확인
+    int heartbeat = session_heartbeat(user);
+    uint64_t idle = now - __atomic_load_n(&user->last_active, __ATOMIC_RELAXED);
+    if (heartbeat && g_idle_ticks > 0 && idle >= g_idle_ticks) {
+        session_timer_close(user, "Idle timeout: no response from client.");
+        return;
+    }
+    if (heartbeat && g_ping_ticks > 0 && idle >= g_ping_ticks) {
+        user_send_packet(user, RES_MAGIC, PACKET_TYPE_PING, NULL, 0); // 응답(PONG)이 오면 last_active 갱신
+    }
+    uint64_t next = session_timer_next(user, now);
+    if (next > 0) timer_arm_unlocked(&user->timer, next);
+}
+
+// TCP keepalive 설정 함수 - PING에 응답하지 않는 클라이언트의 끊긴 연결을 커널이 확인
+// 유휴 종료 시간 동안 수신이 없으면 PING 간격마다 확인 패킷 전송 (유닉스 도메인 소켓은 TCP 옵션 실패를 무시)
+static void session_keepalive(int sock) {
+    int on = 1;
+    if (setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on)) < 0) return;
+    int idle_sec = (int)(g_idle_ticks * TIMER_TICK_MS / 1000);
+    int interval_sec = (int)(g_ping_ticks * TIMER_TICK_MS / 1000);
+    if (idle_sec > 0) setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &idle_sec, sizeof(idle_sec));
+    if (interval_sec > 0) setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &interval_sec, sizeof(interval_sec));
+}
+
+// 세션 타이머 시작 함수 - 핸드셰이크 기한(없으면 하트비트/유휴 확인)으로 첫 만료 설정
+static void session_timer_start(User *user) {
+    timer_init(&user->timer, session_timer_fire, user);
+    user->connect_tick = user->last_active = timer_now();
+    if (g_timer_fd < 0) return; // 모든 시간 제한이 꺼져 있음
+
+    uint64_t first = g_handshake_ticks > 0 ? g_handshake_ticks : session_timer_next(user, user->connect_tick);
+    if (first > 0) timer_arm(&user->timer, first);
+}
+
 // 클라이언트 종료 처리(세션 정리) 함수
 void cleanup_client_session(User *user) {
     if (!user) return;
+    timer_cancel(&user->timer); // 소켓을 닫기 전에 취소 (타이머가 닫힌/재사용된 소켓에 접근하지 않도록)
 
-    // 1. 방에서 나가기
-    if (user->room) {
-        Room *room = user->room;
-        char disconnect_msg[BUFFER_SIZE];
-        snprintf(disconnect_msg, sizeof(disconnect_msg), " %s has disconnected.\n", user->id);
+    if (!__atomic_exchange_n(&user->closing, 1, __ATOMIC_ACQ_REL)) { // 중복 정리 방지 (강퇴와 연결 종료가 동시에 정리할 수 있음)
+        work_pool_wait_idle(&user->strand); // 작업 스레드에서 실행 중인 이 사용자의 명령이 끝난 뒤 정리 (이후 대기 작업은 건너뜀)
 
-        remove_user_from_room(room, user); // 대화방에서 사용자 제거
-        broadcast_server_message_to_room(room, NULL, disconnect_msg); // 대화방 참여자에게 브로드캐스트
-        destroy_room_if_empty(room); // 대화방이 비어있으면 제거
+        // 1. 방에서 나가기
+        if (user->room) {
+            Room *room = user->room;
+            char disconnect_msg[BUFFER_SIZE];
+            snprintf(disconnect_msg, sizeof(disconnect_msg), " %s has disconnected.\n", user->id);
+
+            remove_user_from_room(room, user, NULL, disconnect_msg); // 대화방에서 제거 후 참여자에게 안내 (비면 대화방 제거)
+        }
+        if (g_room_snapshots) {
+            // 이전 스냅샷으로 이 사용자에게 전송 중인 브로드캐스트가 끝난 뒤에 소켓 닫기/해제 (강퇴로 이미 제거된 경우 포함)
+            epoch_synchronize();
+        }
+        // 2. 사용자 목록에서 제거
+        list_remove_user(user);
+
+        db_update_user_connected(user, 0); // 데이터베이스에 연결 상태 업데이트
+    }
+
+    if (g_io_mode != IO_MODE_THREAD || !pthread_equal(pthread_self(), user->thread)) {
+        // 다른 스레드(강퇴 등) 또는 이벤트 루프 모드: 소켓 종료 통지만 하고
+        // 소켓 닫기/메모리 해제는 세션을 소유한 스레드(루프)가 담당
+        notify_session_close(user);
+        return;
     }
-    // 2. 사용자 목록에서 제거
-    list_remove_user(user);
 
     // 3. 소켓 종료
     if (user->sock >= 0) {
+        user_flush_output(user); // 큐에 남은 패킷 전송 시도
         shutdown(user->sock, SHUT_RDWR);
         close(user->sock); // 소켓 종료
         user->sock = -1; // 소켓 초기화
     }
 
-    db_update_user_connected(user, 0); // 데이터베이스에 연결 상태 업데이트
-
     // 사용자 구조체 메모리 해제
     printf("[INFO] Cleaning up client session for user %s (sock=%d).\n", user->id, user->sock);
-    free(user); // 사용자 구조체 해제
+    destroy_client_session(user);
 
     pthread_exit(NULL); // 스레드 종료
 }
 
+// 세션 메모리 해제 함수 - 소켓이 닫힌 뒤 세션을 소유한 스레드(루프)가 호출
+void destroy_client_session(User *user) {
+    timer_cancel(&user->timer); // 정리 없이 해제되는 경우(등록 실패 등)에도 타이머 해제
+    if (work_pool_detach(&user->strand)) return; // 남은 작업이 있으면 마지막 작업 후 작업 스레드가 해제
+    work_strand_destroy(&user->strand);
+    rate_limiter_release(&user->rate); // 접속 IP 항목 참조 반환
+    out_queue_destroy(&user->outq); // 송신 큐 해제
+    frame_decoder_free(&user->decoder); // 수신 디코더 버퍼 해제
+    free(user); // 사용자 구조체 해제
+    __sync_fetch_and_sub(&g_conn_count, 1); // 연결 수 감소
+}
+
 // ==== 서버 명령어 처리 함수 ====
 // 서버 사용자 목록 출력 함수
 void server_user(void) {
@@ -539,13 +766,14 @@ void server_room_info(char *room_name) {
         return;
     }
 
-    pthread_mutex_lock(&g_rooms_mutex);
+    pthread_rwlock_rdlock(&g_rooms_lock);
     Room *r = find_room_unlocked(room_name);
-    pthread_mutex_unlock(&g_rooms_mutex);
-
     if (r) {
-        db_get_room_info(r); // 데이터베이스에서 대화방 정보 가져오기
-    } else {
+        db_get_room_info(r); // 데이터베이스에서 대화방 정보 가져오기 (읽기 잠금으로 해제 방지)
+    }
+    pthread_rwlock_unlock(&g_rooms_lock);
+
+    if (!r) {
         printf("Room '%s' not found.\n", room_name);
     }
 }
@@ -571,6 +799,10 @@ void server_quit(void) {
     printf("[INFO] Shutting down Server...\n");
 
     close(g_server_sock); // 서버 소켓 종료
+    if (g_unix_sock >= 0) {
+        close(g_unix_sock); // 유닉스 도메인 소켓 종료
+        if (g_unix_path[0]) unlink(g_unix_path); // 소켓 파일 삭제
+    }
 
     // 모든 연결 해제
     pthread_mutex_lock(&g_users_mutex);
@@ -590,22 +822,28 @@ void server_quit(void) {
     u = g_users;
     while (u) {
         next_u = u->next;
-        free(u);
+        destroy_client_session(u);
         u = next_u;
     }
     g_users = NULL;
+    g_users_tail = NULL;
+    hash_index_free(&g_users_by_sock);
+    hash_index_free(&g_users_by_id);
     pthread_mutex_unlock(&g_users_mutex);
 
     // 대화방 메모리 해제
-    pthread_mutex_lock(&g_rooms_mutex);
+    pthread_rwlock_wrlock(&g_rooms_lock);
     r = g_rooms;
     while (r) {
         next_r = r->next;
-        free(r);
+        free_room(r);
         r = next_r;
     }
     g_rooms = NULL;
-    pthread_mutex_unlock(&g_rooms_mutex);
+    g_rooms_tail = NULL;
+    hash_index_free(&g_rooms_by_no);
+    hash_index_free(&g_rooms_by_name);
+    pthread_rwlock_unlock(&g_rooms_lock);
 
     printf("[INFO] Server shutdown complete.\n");
     fflush(stdout);
@@ -614,47 +852,102 @@ void server_quit(void) {
 }
 
 // ==== 클라이언트 명령어 처리 함수 ====
+// 목록 응답 버퍼 - v1 세션은 기존 한도(BUFFER_SIZE * 2)에서 "..."로 생략, v2 세션은 조각 전송으로 PACKET_MAX_MESSAGE까지
+typedef struct {
+    char *buf;                          // 응답 문자열 (NUL 종료)
+    size_t len;                         // 문자열 길이
+    size_t cap;                         // 버퍼 용량
+    size_t limit;                       // 최대 길이 (생략 표시 포함)
+    int truncated;                      // 한도를 넘어 생략했는지 여부
+} ListBuf;
+
+static void list_init(ListBuf *lb, const User *user) {
+    lb->limit = user->proto_version >= 2 ? user->max_message : BUFFER_SIZE * 2;
+    lb->cap = BUFFER_SIZE * 2 < lb->limit ? BUFFER_SIZE * 2 : lb->limit;
+    lb->buf = malloc(lb->cap);
+    lb->len = 0;
+    lb->truncated = 0;
+    if (lb->buf) lb->buf[0] = '\0';
+}
+
+// 목록 버퍼 용량 확보 - 문자열 뒤에 extra 바이트(NUL 제외)를 더 쓸 수 있도록
+static int list_reserve(ListBuf *lb, size_t extra) {
+    if (lb->len + extra < lb->cap) return 0;
+    size_t new_cap = lb->cap;
+    while (lb->len + extra >= new_cap) new_cap *= 2;
+    char *new_buf = realloc(lb->buf, new_cap);
+    if (!new_buf) return -1;
+    lb->buf = new_buf;
+    lb->cap = new_cap;
+    return 0;
+}
+
+// 목록 버퍼에 추가 - 한도를 넘으면 "..."를 붙이고 이후 추가는 무시 (-1 반환)
+static int list_appendf(ListBuf *lb, const char *fmt, ...) {
+    if (!lb->buf || lb->truncated) return -1;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(NULL, 0, fmt, ap);
+    va_end(ap);
+    if (n < 0) return -1;
+
+    // 생략 표시("...")와 줄바꿈 자리를 남겨 두고 한도 확인
+    if (lb->len + (size_t)n + 4 >= lb->limit || list_reserve(lb, (size_t)n) < 0) {
+        lb->truncated = 1;
+        if (list_reserve(lb, 3) == 0) {
+            memcpy(lb->buf + lb->len, "...", 4);
+            lb->len += 3;
+        }
+        return -1;
+    }
+    va_start(ap, fmt);
+    vsnprintf(lb->buf + lb->len, lb->cap - lb->len, fmt, ap);
+    va_end(ap);
+    lb->len += (size_t)n;
+    return 0;
+}
+
+// 목록 버퍼 전송 후 해제 - 생략 여부와 관계없이 줄바꿈으로 마무리
+static void list_send(ListBuf *lb, User *user, uint8_t type) {
+    if (!lb->buf) return;
+    if (list_reserve(lb, 1) == 0) {
+        lb->buf[lb->len++] = '\n';
+        lb->buf[lb->len] = '\0';
+    }
+    user_send_payload(user, RES_MAGIC, type, lb->buf, lb->len);
+    free(lb->buf);
+    lb->buf = NULL;
+}
+
 // 사용자 목록 정보 출력 함수
 void cmd_users(User *user) {
     printf("[DEBUG] cmd_users called by %s, sock=%d\n", user->id, user->sock);
     fflush(stdout); // 버퍼 비우기
 
-    char user_list[BUFFER_SIZE * 2];
-    size_t len = 0;
-    user_list[0] = '\0';
+    ListBuf list;
+    list_init(&list, user);
 
     if (user->room) {
-        len += snprintf(user_list + len, sizeof(user_list) - len, " Users in room %s: ", user->room->room_name);
-
-        pthread_mutex_lock(&g_rooms_mutex);
-        User *member = user->room->members[0];
-        while (member) {
-            size_t rem = sizeof(user_list) - len;
-            if (rem <= 1) break;
-            len += snprintf(user_list + len, rem, "%s%s", member->id, member->room_user_next ? ", " : "");
-            member = member->room_user_next;
+        list_appendf(&list, " Users in room %s: ", user->room->room_name);
+
+        Room *room = user->room;
+        pthread_mutex_lock(&room->mutex);
+        for (int i = 0; i < room->member_count; i++) {
+            if (list_appendf(&list, "%s%s", room->members[i]->id, i + 1 < room->member_count ? ", " : "") < 0) break;
         }
-        pthread_mutex_unlock(&g_rooms_mutex);
+        pthread_mutex_unlock(&room->mutex);
     } else {
-        len += snprintf(user_list + len, sizeof(user_list) - len, " Connected users: ");
+        list_appendf(&list, " Connected users: ");
         pthread_mutex_lock(&g_users_mutex);
 
         User *iter = g_users;
         while (iter) {
-            size_t rem = sizeof(user_list) - len;
-            if (rem <= 1) break;
-            len += snprintf(user_list + len, rem, "%s%s", iter->id, iter->next ? ", " : "");
+            if (list_appendf(&list, "%s%s", iter->id, iter->next ? ", " : "") < 0) break;
             iter = iter->next;
         }
         pthread_mutex_unlock(&g_users_mutex);
     }
-    len += snprintf(user_list + len, sizeof(user_list) - len, "\n");
-
-    send_packet(user->sock,
-                RES_MAGIC,
-                PACKET_TYPE_LIST_USERS,
-                user_list,
-                (uint16_t)len);
+    list_send(&list, user, PACKET_TYPE_LIST_USERS);
 
     printf("[INFO] Sent user list to sock=%d\n", user->sock);
     fflush(stdout); // 버퍼 비우기
@@ -666,57 +959,43 @@ void cmd_users_wrapper(User *user, char *args) {
 }
 
 // 대화방 목록 정보 출력 함수
-void cmd_rooms(int sock) {
-    char room_list[BUFFER_SIZE * 2];
-    size_t len = 0;
-    room_list[0] = '\0';
+void cmd_rooms(User *user) {
+    ListBuf list;
+    list_init(&list, user);
 
-    len += snprintf(room_list + len, sizeof(room_list) - len, " Available rooms: ");
+    list_appendf(&list, " Available rooms: ");
 
-    pthread_mutex_lock(&g_rooms_mutex);
+    pthread_rwlock_rdlock(&g_rooms_lock);
     Room *room = g_rooms;
     if (room == NULL) {
-        len += snprintf(room_list + len, sizeof(room_list) - len, "No rooms available.\n");
+        list_appendf(&list, "No rooms available.");
     } else {
         while (room) {
-            size_t rem = sizeof(room_list) - len;
-            if (rem < 52) {
-                len += snprintf(room_list + len, rem, "...");
-                break; // 버퍼가 가득 찬 경우 생략
-            }
             // 방 정보 포맷팅
-            int written = snprintf(room_list + len, rem,
-                "ID %u: '%s' (%d members)%s", 
-                room->no,
-                room->room_name,
-                room->member_count,
-                room->next ? ", ": "");
-            if (written < 0 || (size_t)written >= rem) {
-                len += snprintf(room_list + len, rem, "...");
-                break;
+            pthread_mutex_lock(&room->mutex);
+            int member_count = room->member_count;
+            pthread_mutex_unlock(&room->mutex);
+            if (list_appendf(&list, "ID %u: '%s' (%d members)%s",
+                             room->no,
+                             room->room_name,
+                             member_count,
+                             room->next ? ", " : "") < 0) {
+                break; // 한도를 넘은 경우 생략
             }
-            len += (size_t)written;
             room = room->next;
         }
-        len += snprintf(room_list + len, sizeof(room_list) - len, "\n");
     }
-    pthread_mutex_unlock(&g_rooms_mutex);
+    pthread_rwlock_unlock(&g_rooms_lock);
 
-    send_packet(
-        sock,
-        RES_MAGIC,
-        PACKET_TYPE_LIST_ROOMS,
-        room_list,
-        (uint16_t)len
-    );
+    list_send(&list, user, PACKET_TYPE_LIST_ROOMS);
 
-    printf("[INFO] Sent room list to sock=%d\n", sock);
+    printf("[INFO] Sent room list to sock=%d\n", user->sock);
     fflush(stdout); // 버퍼 비우기
 }
 
 void cmd_rooms_wrapper(User *user, char *args) {
     (void)args; // 사용하지 않는 인자
-    cmd_rooms(user->sock);
+    cmd_rooms(user);
 }
 
 // 사용자 ID 변경 함수
@@ -739,7 +1018,7 @@ void cmd_id(User *user, char *args) {
     }
 
     // ID 중복 체크
-    if (find_user_by_id_unlocked(new_id) || db_check_user_id(new_id)) {
+    if (find_user_by_id(new_id) || db_check_user_id(new_id)) {
         char error_msg[BUFFER_SIZE];
         snprintf(error_msg, sizeof(error_msg), " ID '%s' already in use. Try another.\n", new_id);
         send_error(user, error_msg);
@@ -748,13 +1027,12 @@ void cmd_id(User *user, char *args) {
 
     // ID 변경
     db_update_user_id(user, new_id); // 데이터베이스에 사용자 ID 업데이트
-    strncpy(user->id, new_id, sizeof(user->id) - 1); // 사용자 구조체에 ID 설정
-    user->id[sizeof(user->id) - 1] = '\0';
+    rename_user(user, new_id); // 사용자 구조체에 ID 설정 (ID 인덱스 갱신)
 
     char ok[BUFFER_SIZE];
     int n = snprintf(ok, sizeof(ok), " ID changed to '%s'.\n", user->id);
-    send_packet(
-        user->sock,
+    user_send_packet(
+        user,
         RES_MAGIC,
         PACKET_TYPE_ID_CHANGE,
         ok,
@@ -791,7 +1069,7 @@ void cmd_manager(User *user, char *user_id) {
     }
 
     // 사용자 ID 검색
-    User *target_user = find_user_by_id_unlocked(user_id);
+    User *target_user = find_user_by_id(user_id);
     if (!target_user || target_user->room != r) {
         // 사용자 ID가 존재하지 않거나 대화방에 참여 중이지 않은 경우
         char error_msg[BUFFER_SIZE];
@@ -808,9 +1086,9 @@ void cmd_manager(User *user, char *user_id) {
     }
 
     // 방장 변경
-    pthread_mutex_lock(&g_rooms_mutex);
+    pthread_mutex_lock(&r->mutex);
     r->manager = target_user;
-    pthread_mutex_unlock(&g_rooms_mutex);
+    pthread_mutex_unlock(&r->mutex);
     db_update_room_manager(r, target_user->id); // 데이터베이스에 방장 정보 업데이트
 
     char ok[BUFFER_SIZE];
@@ -846,19 +1124,16 @@ void cmd_change(User *user, char *room_name) {
         return;
     }
 
-    // 대화방 이름 중복 검사
-    if (find_room_unlocked(room_name) || db_get_room_by_name(room_name)) {
+    // 대화방 이름 중복 검사 및 변경 (대화방 디렉터리로 검사, DB 조회 없음 - 이름 인덱스 갱신이므로 쓰기 잠금)
+    pthread_rwlock_wrlock(&g_rooms_lock);
+    int renamed = rename_room_unlocked(current, room_name);
+    pthread_rwlock_unlock(&g_rooms_lock);
+    if (renamed < 0) {
         char error_msg[BUFFER_SIZE];
         snprintf(error_msg, sizeof(error_msg), " Room name '%s' already exists. Please choose a different name.\n", room_name);
         send_error(user, error_msg);
         return;
     }
-
-    // 대화방 이름 변경
-    pthread_mutex_lock(&g_rooms_mutex);    
-    strncpy(current->room_name, room_name, sizeof(current->room_name) - 1);
-    current->room_name[sizeof(current->room_name) - 1] = '\0';
-    pthread_mutex_unlock(&g_rooms_mutex);
     
     db_update_room_name(current, current->room_name); // 데이터베이스에 방 이름 업데이트
 
@@ -895,13 +1170,18 @@ void cmd_kick(User *user, char *user_id) {
         return;
     }
     
-    // 사용자 ID 검색
+    // 사용자 ID 검색 - 대상은 다른 스레드(소유 루프)에서 연결이 끊겨 해제될 수 있으므로 목록 뮤텍스 안에서 참조 시작
+    pthread_mutex_lock(&g_users_mutex);
     User *target_user = find_user_by_id_unlocked(user_id);
+    if (target_user) work_pool_hold(&target_user->strand);
+    pthread_mutex_unlock(&g_users_mutex);
+
     // 사용자 존재 여부 확인
     if (target_user == NULL || target_user->room != current) {
         char error_msg[BUFFER_SIZE];
         snprintf(error_msg, sizeof(error_msg), " User '%s' not found in this room.\n", user_id);
         send_error(user, error_msg);
+        if (target_user) work_pool_unhold(&target_user->strand);
         return;
     }
 
@@ -909,31 +1189,31 @@ void cmd_kick(User *user, char *user_id) {
     if (target_user == user) {
         char error_msg[] = " You cannot kick yourself.\n";
         send_error(user, error_msg);
+        work_pool_unhold(&target_user->strand);
         return;
     }
 
-    remove_user_from_room(current, target_user); // 대화방에서 사용자 제거
+    // 대화방에서 사용자 제거 후 방 참여자에게 강퇴 메시지 브로드캐스트
+    char kick_msg[BUFFER_SIZE];
+    snprintf(kick_msg, sizeof(kick_msg), " User '%s' has been kicked from the room by %s.\n", target_user->id, user->id);
+    remove_user_from_room(current, target_user, user, kick_msg);
 
     // 강퇴된 사용자에게 메시지 전송
     char kicked_msg[] = " You have been kicked from the room.\n";
-    send_packet(
-        target_user->sock,
+    user_send_packet(
+        target_user,
         RES_MAGIC,
         PACKET_TYPE_KICK_USER,
         kicked_msg,
         (uint16_t)strlen(kicked_msg)
     );
 
-    // 방 참여자에게 강퇴 메시지 브로드캐스트
-    char kick_msg[BUFFER_SIZE];
-    snprintf(kick_msg, sizeof(kick_msg), " User '%s' has been kicked from the room by %s.\n", target_user->id, user->id);
-    broadcast_server_message_to_room(current, user, kick_msg); // 방 참여자에게 브로드캐스트
-
     printf("[INFO] User %s has been kicked from room '%s' by %s.\n", target_user->id, current->room_name, user->id);
     fflush(stdout); // 버퍼 비우기
     
-    // 강퇴된 사용자의 세션 정리
+    // 강퇴된 사용자의 세션 정리 (소켓 닫기/해제는 소유 스레드가 담당, 참조를 놓은 뒤에 해제될 수 있음)
     cleanup_client_session(target_user);
+    work_pool_unhold(&target_user->strand);
 }
 
 // 새 대화방 생성 및 참가 함수
@@ -955,7 +1235,7 @@ void cmd_create(User *creator, char *room_name) {
     }
 
     // 대화방 이름 중복 검사
-    if (find_room_unlocked(room_name) || db_get_room_by_name(room_name)) {
+    if (find_room(room_name)) { // 대화방 디렉터리로 검사 (DB 조회 없음)
         char error_msg[BUFFER_SIZE];
         snprintf(error_msg, sizeof(error_msg), " Room name '%s' already exists. Please choose a different name.\n", room_name);
         send_error(creator, error_msg);
@@ -982,8 +1262,12 @@ void cmd_create(User *creator, char *room_name) {
         perror("malloc for new_room failed");
         return;
     }
-    memset(new_room->members, 0, sizeof(new_room->members)); // 멤버 초기화
+    pthread_mutex_init(&new_room->mutex, NULL); // 대화방별 뮤텍스 초기화
+    new_room->members = NULL; // 멤버 배열은 첫 참여 시 할당
+    new_room->member_cap = 0;
+    new_room->snapshot = NULL; // 스냅샷은 첫 참여 시 게시
     new_room->no = g_next_room_no++; // 다음 대화방 번호 할당        
+    room_actor_attach(new_room); // 액터 모드: 대화방 번호로 소유 워커 배정
     strncpy(new_room->room_name, room_name, sizeof(new_room->room_name) - 1); // 방 이름 설정
     new_room->room_name[sizeof(new_room->room_name) - 1] = '\0';
     new_room->created_time = time(NULL);
@@ -991,20 +1275,26 @@ void cmd_create(User *creator, char *room_name) {
     new_room->member_count = 0; // 초기 멤버 수 설정
     new_room->next = new_room->prev = NULL; // 다음 대화방 포인터 초기화
     
-    add_room(new_room); // 대화방 목록에 추가
-
-    if (!find_room_by_no_unlocked(new_room->no)) {
-        fprintf(stderr, "[ERROR] Failed to add new room %s (ID: %u) to the global room list.\n", new_room->room_name, new_room->no);
-        free(new_room); // 메모리 해제
+    unsigned int new_no = new_room->no;
+    if (add_room(new_room) < 0) { // 대화방 목록에 추가 (실패 시 new_room은 해제됨)
+        fprintf(stderr, "[ERROR] Failed to add new room %s (ID: %u) to the global room list.\n", room_name, new_no);
+        char error_msg[] = " Failed to create room. Please try again.\n";
+        send_error(creator, error_msg);
         return;
     }
 
-    add_user_to_room(new_room, creator); // 메모리+DB 동기화
+    // 디렉터리에 등록된 뒤에는 번호로 참여 (그 사이 비어있는 방으로 제거되었으면 실패 처리)
+    new_room = join_room(new_no, creator); // 메모리+DB 동기화
+    if (!new_room) {
+        char error_msg[] = " Failed to create room. Please try again.\n";
+        send_error(creator, error_msg);
+        return;
+    }
     
     char ok[BUFFER_SIZE];
     int n = snprintf(ok, sizeof(ok), " Room '%s' (ID: %u) created and joined.\n", new_room->room_name, new_room->no);
-    send_packet(
-        creator->sock,
+    user_send_packet(
+        creator,
         RES_MAGIC,
         PACKET_TYPE_CREATE_ROOM,
         ok,
@@ -1040,8 +1330,8 @@ void cmd_join(User *user, char *room_no_str) {
         return;
     }
 
-    // 대화방 찾기
-    Room *target_room = find_room_by_no_unlocked((unsigned int)room_no);
+    // 대화방 찾기 및 참여 (메모리+DB 동기화)
+    Room *target_room = join_room((unsigned int)room_no, user);
     if (!target_room) {
         char error_msg[BUFFER_SIZE];
         snprintf(error_msg, sizeof(error_msg), " Room with ID %u not found.\n", (unsigned int)room_no);
@@ -1049,12 +1339,10 @@ void cmd_join(User *user, char *room_no_str) {
         return;
     }
 
-    add_user_to_room(target_room, user); // 메모리+DB 동기화
-
     char ok[BUFFER_SIZE];
     int n = snprintf(ok, sizeof(ok), " You have joined room '%s' (ID: %u).\n", target_room->room_name, target_room->no);
-    send_packet(
-        user->sock,
+    user_send_packet(
+        user,
         RES_MAGIC,
         PACKET_TYPE_JOIN_ROOM,
         ok,
@@ -1083,23 +1371,25 @@ void cmd_leave(User *user) {
     }
 
     Room *current_room = user->room;
-    remove_user_from_room(current_room, user); // 메모리+DB 동기화
+    unsigned int room_no = current_room->no;
+    char room_name[MAX_ROOM_NAME_LEN];
+    snprintf(room_name, sizeof(room_name), "%s", current_room->room_name);
+
+    char leave_msg[BUFFER_SIZE];
+    snprintf(leave_msg, sizeof(leave_msg), " %s has left the room.\n", user->id);
+    remove_user_from_room(current_room, user, user, leave_msg); // 메모리+DB 동기화, 참여자에게 브로드캐스트 (마지막 참여자였으면 대화방 제거)
     
     // 퇴장 메시지 전송
     char ok[] = " You left the room.\n";
-    send_packet(
-        user->sock,
+    user_send_packet(
+        user,
         RES_MAGIC,
         PACKET_TYPE_LEAVE_ROOM,
         ok,
         (uint16_t)strlen(ok)
     );
-    printf("[INFO] User %s has left room '%s' (ID: %u)\n", user->id, current_room->room_name, current_room->no);
+    printf("[INFO] User %s has left room '%s' (ID: %u)\n", user->id, room_name, room_no);
     fflush(stdout); // 버퍼 비우기
-
-    char leave_msg[BUFFER_SIZE];
-    snprintf(leave_msg, sizeof(leave_msg), " %s has left the room.\n", user->id);
-    broadcast_server_message_to_room(current_room, user, leave_msg); // 방 참여자에게 브로드캐스트
 }
 
 void cmd_leave_wrapper(User *user, char *args) {
@@ -1116,8 +1406,8 @@ void cmd_delete_account(User *user) {
     if (!user->pending_delete) {
         user->pending_delete = 1; // 계정 삭제 요청 플래그로 변경
         const char *confirm_msg = " Are you sure you want to delete your account? Type '/delete_account' again to confirm.\n";
-        send_packet(
-            user->sock,
+        user_send_packet(
+            user,
             RES_MAGIC,
             PACKET_TYPE_DELETE_ACCOUNT,
             confirm_msg,
@@ -1136,26 +1426,21 @@ void cmd_delete_account(User *user) {
         cmd_leave(user);
     }
 
-    remove_user(user); // 메모리+DB 동기화
-
     // 계정 삭제 완료 메시지 전송
     char *msg = " Your account has been deleted.\n";
-    send_packet(
-        user->sock,
+    user_send_packet(
+        user,
         RES_MAGIC,
         PACKET_TYPE_SERVER_NOTICE,
         msg,
         (uint16_t)strlen(msg)
     );
 
-    // 소켓 종료 및 메모리 해제
-    if (user->sock >= 0) {
-        shutdown(user->sock, SHUT_RDWR);
-        close(user->sock);
-    }
-    
     printf("[INFO] User %s has deleted their account and disconnected.\n", user->id);
     fflush(stdout); // 버퍼 비우기    
+
+    // 사용자 목록 제거, 소켓 종료 및 메모리 해제 (메모리+DB 동기화)
+    cleanup_client_session(user);
 }
 
 void cmd_delete_account_wrapper(User *user, char *args) {
@@ -1203,8 +1488,11 @@ void cmd_delete_message(User *user, char *args) {
         return;
     }
 
+    // 검사와 삭제 동안 읽기 잠금으로 대화방 해제 방지
+    pthread_rwlock_rdlock(&g_rooms_lock);
     Room *room = find_room_by_no_unlocked(room_no);
     if (room == NULL) {
+        pthread_rwlock_unlock(&g_rooms_lock);
         char error_msg[] = " Room not found.\n";
         send_error(user, error_msg);
         return;
@@ -1212,6 +1500,7 @@ void cmd_delete_message(User *user, char *args) {
 
     // 권한 체크: 방장 또는 본인만 삭제 가능
     if (strcmp(user->id, sender_id) != 0 && user != room->manager) {
+        pthread_rwlock_unlock(&g_rooms_lock);
         char error_msg[] = " Only the sender or the room manager can delete this message.\n";
         send_error(user, error_msg);
         return;
@@ -1219,10 +1508,13 @@ void cmd_delete_message(User *user, char *args) {
 
     // 메시지 삭제
     int delete_result = db_remove_message_by_id(room, user, msg_id);
+    char room_name[MAX_ROOM_NAME_LEN];
+    snprintf(room_name, sizeof(room_name), "%s", room->room_name);
+    pthread_rwlock_unlock(&g_rooms_lock);
     if (delete_result) {
         char ok[] = " Message deleted successfully.\n";
-        send_packet(
-            user->sock,
+        user_send_packet(
+            user,
             RES_MAGIC,
             PACKET_TYPE_DELETE_MESSAGE,
             ok,
@@ -1233,7 +1525,7 @@ void cmd_delete_message(User *user, char *args) {
         send_error(user, error_msg);
     }
 
-    printf("[INFO] User %s deleted message ID %d in room '%s' (ID: %u)\n", user->id, msg_id, room->room_name, room->no);
+    printf("[INFO] User %s deleted message ID %d in room '%s' (ID: %u)\n", user->id, msg_id, room_name, room_no);
     fflush(stdout); // 버퍼 비우기
 }
 
@@ -1259,8 +1551,8 @@ void cmd_help(User *user) {
         len += (size_t)written; // 누적 길이 업데이트
     }
 
-    send_packet(
-        user->sock,
+    user_send_packet(
+        user,
         RES_MAGIC,
         PACKET_TYPE_HELP,
         buf,
@@ -1309,8 +1601,8 @@ void cmd_quit(User *user) {
 
     // 사용자에게 종료 메시지 전송
     const char *msg = "You have been disconnected from the server.\n";
-    send_packet(
-        user->sock,
+    user_send_packet(
+        user,
         RES_MAGIC,
         PACKET_TYPE_SERVER_NOTICE,
         msg,
@@ -1416,480 +1708,461 @@ void usage_help(User *user) {
 }
 
 
-// 클라이언트 프로세스 함수
-void *client_process(void *args) {
-    User *user = (User *)args;
-
-    // 1. ID 입력 루프 (패킷 기반)
-    while (user->sock >= 0 && strlen(user->id) == 0) {
-        // 사용자 ID 입력 요청
-        char msg[] = "Enter User ID (2 ~ 20 chars) or just press ENTER for random ID: ";
-        send_packet(
-            user->sock,
-            RES_MAGIC,
-            PACKET_TYPE_SERVER_NOTICE,
-            msg,
-            (uint16_t)strlen(msg)
-        );
-        
-        // 패킷 수신 (사용자 ID 설정 패킷만 받음)
-        PacketHeader pk_header;
-        char id_buffer[MAX_ID_LEN + 1] = {0}; // ID 입력 버퍼
-        unsigned char cs;
+// 사용자 ID 입력 요청 전송 함수
+void send_id_prompt(User *user) {
+    char msg[] = "Enter User ID (2 ~ 20 chars) or just press ENTER for random ID: ";
+    user_send_packet(
+        user,
+        RES_MAGIC,
+        PACKET_TYPE_SERVER_NOTICE,
+        msg,
+        (uint16_t)strlen(msg)
+    );
+}
 
-        printf("[DEBUG] Waiting for user ID input from sock=%d\n", user->sock);
+// ID 설정 패킷 처리 함수 - ID 확정 시 CLIENT_CONTINUE, 재입력 필요 시 CLIENT_RETRY_ID, 세션 종료 시 CLIENT_CLOSED 반환
+int client_handle_id_packet(User *user, const FrameHeader *hdr, const unsigned char *data) {
+    if (hdr->magic != REQ_MAGIC || hdr->type != PACKET_TYPE_SET_ID) {
+        // 잘못된 패킷이면 세션 정리
+        printf("[ERROR] Invalid packet received from sock=%d. Expected SET_ID packet.\n", user->sock);
         fflush(stdout); // 출력 버퍼 비우기
-        ssize_t header_type = recv_all(user->sock, &pk_header, sizeof(PacketHeader));
-        printf("[DEBUG] Received packet header from sock=%d\n", user->sock);
-        printf("[DEBUG] header_type=%zd, magic=%x, type=%d, data_len=%d\n", header_type, pk_header.magic, pk_header.type, pk_header.data_len);
+        cleanup_client_session(user); // 세션 정리
+        return CLIENT_CLOSED;
+    }
+
+    // data_len == 0 또는 data_len > 0 두 경우 처리
+    if (hdr->data_len == 0) {
+        // 사용자가 ID 입력하지 않고 그냥 엔터를 누른 경우 랜덤 ID 생성
+        snprintf(user->id, sizeof(user->id), "User%u", rand() % 10000 + 1);
+        printf("[DEBUG] User ID not provided, generated random ID: %s\n", user->id);
         fflush(stdout); // 출력 버퍼 비우기
-        if (header_type <= 0) {
-            // 연결 종료 또는 에러 발생
-            printf("[ERROR] User %s disconnected or error occurred while receiving ID.\n", user->id);
-            fflush(stdout);
-            cleanup_client_session(user);
-            return NULL; // 클라이언트 세션 종료
+    } else if (hdr->data_len <= MAX_ID_LEN) {
+        // 사용자 ID 입력 수신
+        char id_buffer[MAX_ID_LEN + 1] = {0}; // ID 입력 버퍼
+        memcpy(id_buffer, data, hdr->data_len);
+        id_buffer[hdr->data_len] = '\0';
+
+        if (strlen(id_buffer) < 2 || strlen(id_buffer) > MAX_ID_LEN) {
+            // ID 길이가 유효하지 않은 경우
+            char error_msg[] = " Invalid ID length. Please enter 2 to 20 characters.\n";
+            send_error(user, error_msg);
+            return CLIENT_RETRY_ID; // 다시 입력 요청
         }
-        // 네트워크 바이트 순서 -> 호스트 바이트 순서 변환
-        pk_header.magic = ntohs(pk_header.magic);
-        pk_header.data_len = ntohs(pk_header.data_len);
-
-        if (pk_header.magic != REQ_MAGIC || pk_header.type != PACKET_TYPE_SET_ID) {
-            // 잘못된 패킷이면 남은 데이터 버림(읽지 않음)
-            if (pk_header.data_len > 0) {
-                char tmpbuf[BUFFER_SIZE];
-                recv_all(user->sock, tmpbuf, pk_header.data_len);
-                recv_all(user->sock, &cs, 1); // 체크섬 수신
-            }
-            cleanup_client_session(user); // 세션 정리
-            printf("[ERROR] Invalid packet received from sock=%d. Expected SET_ID packet.\n", user->sock);
-            fflush(stdout); // 출력 버퍼 비우기
-            return NULL; // 클라이언트 세션 종료
+        if (find_user_by_id(id_buffer) || db_check_user_id(id_buffer)) {
+            // ID가 이미 존재하는 경우
+            char error_msg[] = " ID already exists. Please choose another ID.\n";
+            send_error(user, error_msg);
+            return CLIENT_RETRY_ID; // 다시 입력 요청
         }
+        // ID가 유효한 경우
+        strncpy(user->id, id_buffer, sizeof(user->id) - 1);
+        user->id[sizeof(user->id) - 1] = '\0';
+    } else {
+        // ID 길이가 유효하지 않은 경우
+        char error_msg[] = " Invalid ID length. Please enter 2 to 20 characters.\n";
+        send_error(user, error_msg);
+        return CLIENT_RETRY_ID; // 다시 입력 요청
+    }
+
+    add_user(user); // 사용자 목록에 추가
+    rate_limiter_identified(&user->rate); // IP별 ID 설정 전 연결 수에서 제외
+    // 사용자에게 환영 메시지 전송
+    char welcome_msg[BUFFER_SIZE];
+    int n = snprintf(welcome_msg, sizeof(welcome_msg), " Welcome, %s! You can now join a chatroom or create one.\n", user->id);
+    user_send_packet(
+        user,
+        RES_MAGIC,
+        PACKET_TYPE_SERVER_NOTICE,
+        welcome_msg,
+        (uint16_t)n
+    );
+    printf("[INFO] User '%s' connected with ID: %s\n", user->id, user->id);
+    fflush(stdout); // 출력 버퍼 비우기
+    return CLIENT_CONTINUE;
+}
+
+// 메시지 저장 작업 인자 - 세션/대화방이 먼저 해제되어도 되도록 값을 복사
+typedef struct {
+    unsigned int room_no;               // 대화방 번호
+    char sender_id[MAX_ID_LEN];         // 발신자 ID
+    char message[];                     // 메시지 본문 (NUL 종료)
+} PersistMessageJob;
+
+// 메시지 저장 작업 (작업 스레드에서 실행)
+static void persist_message_job(void *arg) {
+    PersistMessageJob *job = (PersistMessageJob *)arg;
+    db_insert_message_by_no(job->room_no, job->sender_id, job->message);
+    free(job);
+}
+
+// 채팅 메시지 저장 함수 - 작업 풀이 있으면 저장 전용 스트랜드로 넘겨 I/O 스레드가 DB 잠금을 기다리지 않도록 함
+static void persist_message(Room *room, User *user, const char *message) {
+    size_t len = strlen(message);
+    PersistMessageJob *job = g_work_pool_count > 0 ? malloc(sizeof(*job) + len + 1) : NULL;
+    if (!job) {
+        db_insert_message(room, user, message);
+        return;
+    }
+    job->room_no = room->no;
+    snprintf(job->sender_id, sizeof(job->sender_id), "%s", user->id);
+    memcpy(job->message, message, len + 1);
+    work_pool_persist(persist_message_job, job);
+}
+
+// 명령/메시지 패킷 처리 함수 - 스레드 모드와 이벤트 루프 모드가 공유 (data는 NUL 종료된 data_len + 1 바이트 버퍼)
+int client_handle_packet(User *user, const FrameHeader *hdr, unsigned char *data) {
+    // 매직 필드 검사 - 잘못된 패킷은 무시하고 다음 패킷 대기
+    if (hdr->magic != REQ_MAGIC) return CLIENT_CONTINUE;
+    // 데이터 길이 한도 - v1 세션은 기존 BUFFER_SIZE, v2 세션은 조립된 메시지 기준으로 합의한 최대 메시지 길이
+    // 한도를 넘는 패킷은 처리하지 않고 오류로 알린 뒤 다음 패킷 대기
+    uint32_t limit = user->proto_version >= 2 ? user->max_message : BUFFER_SIZE;
+    if (hdr->data_len > limit) {
+        char error_msg[64];
+        snprintf(error_msg, sizeof(error_msg), " Packet too long (max %u bytes).\n", limit);
+        send_error(user, error_msg);
+        return CLIENT_CONTINUE;
+    }
 
-        // data_len == 0 또는 data_len > 0 두 경우 처리
-        if (pk_header.data_len == 0) {
-            // 사용자가 ID 입력하지 않고 그냥 엔터를 누른 경우 랜덤 ID 생성
-            snprintf(user->id, sizeof(user->id), "User%u", rand() % 10000 + 1);
-            printf("[DEBUG] User ID not provided, generated random ID: %s\n", user->id);
-            fflush(stdout); // 출력 버퍼 비우기
-            recv_all(user->sock, &cs, 1);
-        } else if (pk_header.data_len > 0 && pk_header.data_len <= MAX_ID_LEN) {
-            // 사용자 ID 입력 수신
-            recv_all(user->sock, id_buffer, pk_header.data_len);
-            id_buffer[pk_header.data_len] = '\0';
-            recv_all(user->sock, &cs, 1); // 체크섬 수신
+    // 패킷 타입 검사
+    switch (hdr->type) {
+        case PACKET_TYPE_MESSAGE:
+            printf("[DEBUG] Received PACKET_TYPE_MESSAGE from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
             
-            if (strlen(id_buffer) < 2 || strlen(id_buffer) > MAX_ID_LEN) {
-                // ID 길이가 유효하지 않은 경우
-                char error_msg[] = " Invalid ID length. Please enter 2 to 20 characters.\n";
+            if (data && hdr->data_len > 0)
+                ((char*)data)[hdr->data_len] = '\0';
+
+            // 대화방에 참여 중인지 확인
+            if (!user->room) {
+                char error_msg[] = " You are not in a chatroom. Please join or create a room first.\n";
                 send_error(user, error_msg);
-                continue; // 다시 입력 요청
+                break;
             }
-            if (find_user_by_id_unlocked(id_buffer) || db_check_user_id(id_buffer)) {
-                // ID가 이미 존재하는 경우
-                char error_msg[] = " ID already exists. Please choose another ID.\n";
+            // 메시지 내용이 비어있는지 확인
+            if (!data || hdr->data_len == 0) {
+                char error_msg[] = " Empty message cannot be sent.\n";
                 send_error(user, error_msg);
-                continue; // 다시 입력 요청
+                break;
             }
-            // ID가 유효한 경우
-            strncpy(user->id, id_buffer, sizeof(user->id) - 1);
-            user->id[sizeof(user->id) - 1] = '\0';
-        } else {
-            // ID 길이가 유효하지 않은 경우
-            if (pk_header.data_len > 0) {
-                char error_msg[] = " Invalid ID length. Please enter 2 to 20 characters.\n";
+            // 본문 길이 확인 - 방송 프레임은 v1 참여자도 받을 수 있어야 하므로 모든 세션이 CHAT_MESSAGE_MAX까지
+            if (hdr->data_len > CHAT_MESSAGE_MAX) {
+                char error_msg[64];
+                snprintf(error_msg, sizeof(error_msg), " Message too long (max %d bytes).\n", CHAT_MESSAGE_MAX);
                 send_error(user, error_msg);
-                continue; // 다시 입력 요청
+                break;
             }
-            cleanup_client_session(user); // 세션 정리
-            return NULL; // 클라이언트 세션 종료
-        }
 
-        add_user(user); // 사용자 목록에 추가
-        // 사용자에게 환영 메시지 전송
-        char welcome_msg[BUFFER_SIZE];
-        int n = snprintf(welcome_msg, sizeof(welcome_msg), " Welcome, %s! You can now join a chatroom or create one.\n", user->id);
-        send_packet(
-            user->sock,
-            RES_MAGIC,
-            PACKET_TYPE_SERVER_NOTICE,
-            welcome_msg,
-            (uint16_t)n
-        );
-        printf("[INFO] User '%s' connected with ID: %s\n", user->id, user->id);
-        fflush(stdout); // 출력 버퍼 비우기
-        break;
-    }
+            persist_message(user->room, user, (const char *)data); // 데이터베이스에 메시지 저장 (작업 풀 사용 시 비동기)
 
-    // 2. 명령/메시지 루프 (패킷 기반)
-    while (user->sock >= 0) {
-        PacketHeader pk_header;
-        unsigned char *data_buffer = NULL;
-
-        // 패킷 헤더 수신
-        ssize_t header_type = recv_all(user->sock, &pk_header, sizeof(PacketHeader));
-        if (header_type <= 0) break; // 연결 종료 또는 에러 발생
-
-        // 네트워크 바이트 순서 -> 호스트 바이트 순서 변환
-        pk_header.magic = ntohs(pk_header.magic);
-        pk_header.data_len = ntohs(pk_header.data_len);
-
-        // 매직 필드 검사
-        if (pk_header.magic != REQ_MAGIC) {
-            // 잘못된 패킷이면 남은 데이터 버림(읽지 않음)
-            if (pk_header.data_len > 0) {
-                char tmpbuf[BUFFER_SIZE];
-                recv_all(user->sock, tmpbuf, pk_header.data_len);
-                unsigned char cs;
-                recv_all(user->sock, &cs, 1); // 체크섬 수신
-            }
-            continue; // 잘못된 패킷은 무시하고 다음 패킷 대기
-        }
+            // 메시지 포맷팅
+            {
+                char msg[BUFFER_SIZE];
+                snprintf(msg, sizeof(msg), "[%s] %s\n", user->id, (char *)data);
 
-        if (pk_header.data_len > BUFFER_SIZE) {
-            // 데이터 길이가 너무 긴 경우
-            if (pk_header.data_len > 0) {
-                // 남아 있는 데이터는 버퍼에서 버림(읽지 않음)
-                char tmpbuf[BUFFER_SIZE];
-                recv_all(user->sock, tmpbuf, pk_header.data_len);
-                unsigned char cs;
-                recv_all(user->sock, &cs, 1); // 체크섬 수신
-            }
-            continue; // 잘못된 패킷은 무시하고 다음 패킷 대기
-        }
+                // 한 번만 인코딩하여 대화방 참여자 브로드캐스트와 발신자 ACK가 같은 프레임을 공유
+                SharedFrame *frame = shared_frame_encode(RES_MAGIC, PACKET_TYPE_MESSAGE, msg, (uint16_t)strlen(msg));
+                if (!frame) break;
 
-        // 데이터 버퍼 할당
-        if (pk_header.data_len > 0) {
-            data_buffer = malloc(pk_header.data_len);
-            if (!data_buffer) {
-                perror("malloc for data_buffer failed");
-                break; // 메모리 할당 실패 시 연결 종료
-            }
-            ssize_t bytes_received = recv_all(user->sock, data_buffer, pk_header.data_len);
-            if (bytes_received <= 0) {
-                free(data_buffer);
-                break; // 연결 종료 또는 에러 발생
+                // 대화방 참여자에게 메시지 브로드캐스트
+                broadcast_frame_to_room(user->room, user, frame);
+                printf("[DEBUG] User %s sent message in room %s: %s\n", user->id, user->room->room_name, (char *)data);
+                fflush(stdout); // 버퍼 비우기
+                // 클라이언트 자기 자신에게도 메시지 전송(ACK용)
+                user_queue_frame(user, frame);
+                shared_frame_release(frame);
             }
-        }
+            break;
+        case PACKET_TYPE_ID_CHANGE:
+            printf("[DEBUG] Received PACKET_TYPE_ID_CHANGE from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
 
-        // 체크섬 수신
-        unsigned char received_checksum;
-        if (recv_all(user->sock, &received_checksum, 1) <= 0) {
-            if (data_buffer) {
-                free(data_buffer); // 메모리 해제
-            }
-            break; // 연결 종료 또는 에러 발생
-        }
+            if (data && hdr->data_len > 0)
+                ((char*)data)[hdr->data_len] = '\0';
 
+            if (!data || hdr->data_len == 0) {
+                char error_msg[] = " ID cannot be empty.\n";
+                send_error(user, error_msg);
+                break;
+            }
 
-        // 패킷 타입 검사
-        switch (pk_header.type) {
-            case PACKET_TYPE_MESSAGE:
-                printf("[DEBUG] Received PACKET_TYPE_MESSAGE from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
-                
-                if (data_buffer && pk_header.data_len > 0)
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
+            {
+                // ID 변경 요청 처리
+                char new_id[MAX_ID_LEN] = {0}; // 새 ID 버퍼 초기화
+                size_t len = hdr->data_len < sizeof(new_id) - 1 ? hdr->data_len : sizeof(new_id) - 1;
+                memcpy(new_id, data, len);
+                new_id[len] = '\0';
 
-                // 대화방에 참여 중인지 확인
-                if (!user->room) {
-                    char error_msg[] = " You are not in a chatroom. Please join or create a room first.\n";
+                if (strlen(new_id) < 2 || strlen(new_id) > MAX_ID_LEN) {
+                    char error_msg[] = " Invalid ID length. Please enter 2 to 20 characters.\n";
                     send_error(user, error_msg);
                     break;
                 }
-                // 메시지 내용이 비어있는지 확인
-                if (!data_buffer || pk_header.data_len == 0) {
-                    char error_msg[] = " Empty message cannot be sent.\n";
+                if (find_user_by_id(new_id) || db_check_user_id(new_id)) {
+                    char error_msg[BUFFER_SIZE];
+                    snprintf(error_msg, sizeof(error_msg), " ID '%s' already exists. Please choose another ID.\n", new_id);
                     send_error(user, error_msg);
                     break;
                 }
 
-                db_insert_message(user->room, user, (const char *)data_buffer); // 데이터베이스에 메시지 저장
-
-                // 메시지 포맷팅
-                {
-                    char msg[BUFFER_SIZE];
-                    snprintf(msg, sizeof(msg), "[%s] %s\n", user->id, (char *)data_buffer);
-
-                    // 대화방 참여자에게 메시지 브로드캐스트
-                    broadcast_server_message_to_room(user->room, user, msg);
-                    printf("[DEBUG] User %s sent message in room %s: %s\n", user->id, user->room->room_name, (char *)data_buffer);
-                    fflush(stdout); // 버퍼 비우기
-                    // 클라이언트 자기 자신에게도 메시지 전송(ACK용)
-                    send_packet(
-                        user->sock,
-                        RES_MAGIC,
-                        PACKET_TYPE_MESSAGE,
-                        msg,
-                        (uint16_t)strlen(msg)
-                    );    
-                }
-                break;
-            case PACKET_TYPE_ID_CHANGE:
-                printf("[DEBUG] Received PACKET_TYPE_ID_CHANGE from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
+                db_update_user_id(user, new_id); // 데이터베이스에서 ID 변경
+                rename_user(user, new_id); // ID 인덱스 갱신
 
-                if (data_buffer && pk_header.data_len > 0)
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
+                char ok[BUFFER_SIZE];
+                int n = snprintf(ok, sizeof(ok), " Your ID has been changed to '%s'.\n", user->id);
+                user_send_packet(
+                    user,
+                    RES_MAGIC,
+                    PACKET_TYPE_SERVER_NOTICE,
+                    ok,
+                    (uint16_t)n
+                );
 
-                if (!data_buffer || pk_header.data_len == 0) {
-                    char error_msg[] = " ID cannot be empty.\n";
-                    send_error(user, error_msg);
-                    break;
+                printf("[INFO] User ID changed: %s -> %s\n", user->id, new_id);
+                fflush(stdout); // 버퍼 비우기
+            }
+            break;
+        case PACKET_TYPE_CREATE_ROOM:
+            printf("[DEBUG] Received PACKET_TYPE_CREATE_ROOM from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
+
+            if (data && hdr->data_len > 0) {
+                ((char*)data)[hdr->data_len] = '\0';
+                char room_name[MAX_ROOM_NAME_LEN];
+                size_t len = hdr->data_len < sizeof(room_name) - 1 ? hdr->data_len : sizeof(room_name) - 1;
+                memcpy(room_name, data, len);
+                room_name[len] = '\0';
+                cmd_create(user, room_name); // 대화방 생성 명령 처리
+            }
+            break;
+        case PACKET_TYPE_JOIN_ROOM:
+            printf("[DEBUG] Received PACKET_TYPE_JOIN_ROOM from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
+
+            if (data && hdr->data_len > 0) {
+                ((char*)data)[hdr->data_len] = '\0';
+                if (hdr->data_len == sizeof(uint32_t)) {
+                    // 클라이언트가 4바이트 정수(네트워크 바이트 순서)로 대화방 번호를 보낸 경우
+                    uint32_t room_no_net;
+                    memcpy(&room_no_net, data, sizeof(room_no_net));
+                    uint32_t room_no = ntohl(room_no_net); // 네트워크 바이트 순서 -> 호스트 바이트 순서 변환
+
+                    char room_no_str[5];
+                    snprintf(room_no_str, sizeof(room_no_str), "%u", room_no);
+                    
+                    cmd_join(user, room_no_str); // 대화방 참여 명령 처리
+                } else {
+                    char room_no_str[5];
+                    size_t len = hdr->data_len < sizeof(room_no_str) - 1 ? hdr->data_len : sizeof(room_no_str) - 1;
+                    memcpy(room_no_str, data, len);
+                    room_no_str[len] = '\0';
+                    cmd_join(user, room_no_str); // 대화방 참여 명령 처리
                 }
+            }
+            break;
+        case PACKET_TYPE_LEAVE_ROOM:
+            printf("[DEBUG] Received PACKET_TYPE_LEAVE_ROOM from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
+            
+            cmd_leave(user); // 대화방 나가기 명령 처리
+            break;
+        case PACKET_TYPE_LIST_ROOMS:
+            printf("[DEBUG] Received PACKET_TYPE_LIST_ROOMS from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
 
-                {
-                    // ID 변경 요청 처리
-                    char new_id[MAX_ID_LEN] = {0}; // 새 ID 버퍼 초기화
-                    size_t len = pk_header.data_len < sizeof(new_id) - 1 ? pk_header.data_len : sizeof(new_id) - 1;
-                    memcpy(new_id, data_buffer, len);
-                    new_id[len] = '\0';
-
-                    if (strlen(new_id) < 2 || strlen(new_id) > MAX_ID_LEN) {
-                        char error_msg[] = " Invalid ID length. Please enter 2 to 20 characters.\n";
-                        send_error(user, error_msg);
-                        break;
-                    }
-                    if (find_user_by_id_unlocked(new_id) || db_check_user_id(new_id)) {
-                        char error_msg[BUFFER_SIZE];
-                        snprintf(error_msg, sizeof(error_msg), " ID '%s' already exists. Please choose another ID.\n", new_id);
-                        send_error(user, error_msg);
-                        break;
-                    }
-
-                    db_update_user_id(user, new_id); // 데이터베이스에서 ID 변경
-                    strncpy(user->id, new_id, sizeof(user->id) - 1);
-                    user->id[sizeof(user->id) - 1] = '\0';
-
-                    char ok[BUFFER_SIZE];
-                    int n = snprintf(ok, sizeof(ok), " Your ID has been changed to '%s'.\n", user->id);
-                    send_packet(
-                        user->sock,
-                        RES_MAGIC,
-                        PACKET_TYPE_SERVER_NOTICE,
-                        ok,
-                        (uint16_t)n
-                    );
-
-                    printf("[INFO] User ID changed: %s -> %s\n", user->id, new_id);
-                    fflush(stdout); // 버퍼 비우기
-                }
-                break;
-            case PACKET_TYPE_CREATE_ROOM:
-                printf("[DEBUG] Received PACKET_TYPE_CREATE_ROOM from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
+            cmd_rooms(user); // 대화방 목록 요청 처리
+            break;
+        case PACKET_TYPE_LIST_USERS:
+            printf("[DEBUG] Received PACKET_TYPE_LIST_USERS from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
 
-                if (data_buffer && pk_header.data_len > 0) {
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
-                    char room_name[MAX_ROOM_NAME_LEN];
-                    size_t len = pk_header.data_len < sizeof(room_name) - 1 ? pk_header.data_len : sizeof(room_name) - 1;
-                    memcpy(room_name, data_buffer, len);
-                    room_name[len] = '\0';
-                    cmd_create(user, room_name); // 대화방 생성 명령 처리
-                }
-                break;
-            case PACKET_TYPE_JOIN_ROOM:
-                printf("[DEBUG] Received PACKET_TYPE_JOIN_ROOM from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
+            cmd_users(user); // 사용자 목록 요청 처리
+            break;
+        case PACKET_TYPE_KICK_USER:
+            printf("[DEBUG] Received PACKET_TYPE_KICK_USER from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
+
+            if (data && hdr->data_len > 0) {
+                ((char*)data)[hdr->data_len] = '\0';
+                char target_id[MAX_ID_LEN];
+                size_t len = hdr->data_len < sizeof(target_id) - 1 ? hdr->data_len : sizeof(target_id) - 1;
+                memcpy(target_id, data, len);
+                target_id[len] = '\0';
+                cmd_kick(user, target_id); // 사용자 추방 명령 처리
+            }
+            break;
+        case PACKET_TYPE_CHANGE_ROOM_NAME:
+            printf("[DEBUG] Received PACKET_TYPE_CHANGE_ROOM_NAME from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
+
+            if (data && hdr->data_len > 0) {
+                ((char*)data)[hdr->data_len] = '\0';
+                char new_room_name[MAX_ROOM_NAME_LEN];
+                size_t len = hdr->data_len < sizeof(new_room_name) - 1 ? hdr->data_len : sizeof(new_room_name) - 1;
+                memcpy(new_room_name, data, len);
+                new_room_name[len] = '\0';
+                cmd_change(user, new_room_name); // 대화방 이름 변경 명령 처리
+            }
+            break;
+        case PACKET_TYPE_CHANGE_ROOM_MANAGER:
+            printf("[DEBUG] Received PACKET_TYPE_CHANGE_ROOM_MANAGER from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
+
+            if (data && hdr->data_len > 0) {
+                ((char*)data)[hdr->data_len] = '\0';
+                char new_manager_id[MAX_ID_LEN];
+                size_t len = hdr->data_len < sizeof(new_manager_id) - 1 ? hdr->data_len : sizeof(new_manager_id) - 1;
+                memcpy(new_manager_id, data, len);
+                new_manager_id[len] = '\0';
+                cmd_manager(user, new_manager_id); // 대화방 관리자 변경 명령 처리
+            }
+            break;
+        case PACKET_TYPE_DELETE_ACCOUNT:
+            printf("[DEBUG] Received PACKET_TYPE_DELETE_ACCOUNT from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
+
+            if (user->pending_delete) {
+                // 두 번째 요청: cmd_delete_account 함수 내에서 세션 종료 처리하므로 이후 처리를 막기 위해 return
+                cmd_delete_account(user);
+                return CLIENT_CLOSED;
+            }
+            cmd_delete_account(user); // 첫 번째 요청: 삭제 확인 메시지만 전송
+            break;
+        case PACKET_TYPE_DELETE_MESSAGE:
+            printf("[DEBUG] Received PACKET_TYPE_DELETE_MESSAGE from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
+
+            if (data && hdr->data_len > 0) {
+                ((char*)data)[hdr->data_len] = '\0';
+                char message_id_str[16];
+                size_t len = hdr->data_len < sizeof(message_id_str) - 1 ? hdr->data_len : sizeof(message_id_str) - 1;
+                memcpy(message_id_str, data, len);
+                message_id_str[len] = '\0';
+                cmd_delete_message(user, message_id_str); // 메시지 삭제 명령 처리
+            }
+            break;
+        case PACKET_TYPE_HELP:
+            printf("[DEBUG] Received PACKET_TYPE_HELP from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
 
-                if (data_buffer && pk_header.data_len > 0) {
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
-                    if (pk_header.data_len == sizeof(uint32_t)) {
-                        // 클라이언트가 4바이트 정수(네트워크 바이트 순서)로 대화방 번호를 보낸 경우
-                        uint32_t room_no_net;
-                        memcpy(&room_no_net, data_buffer, sizeof(room_no_net));
-                        uint32_t room_no = ntohl(room_no_net); // 네트워크 바이트 순서 -> 호스트 바이트 순서 변환
-
-                        char room_no_str[5];
-                        snprintf(room_no_str, sizeof(room_no_str), "%u", room_no);
-                        
-                        cmd_join(user, room_no_str); // 대화방 참여 명령 처리
-                    } else {
-                        char room_no_str[5];
-                        size_t len = pk_header.data_len < sizeof(room_no_str) - 1 ? pk_header.data_len : sizeof(room_no_str) - 1;
-                        memcpy(room_no_str, data_buffer, len);
-                        room_no_str[len] = '\0';
-                        cmd_join(user, room_no_str); // 대화방 참여 명령 처리
-                    }
-                }
-                break;
-            case PACKET_TYPE_LEAVE_ROOM:
-                printf("[DEBUG] Received PACKET_TYPE_LEAVE_ROOM from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
-                
-                cmd_leave(user); // 대화방 나가기 명령 처리
-                break;
-            case PACKET_TYPE_LIST_ROOMS:
-                printf("[DEBUG] Received PACKET_TYPE_LIST_ROOMS from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
+            cmd_help(user); // 도움말 요청 처리
+            break;
+        case PACKET_TYPE_USAGE:
+            printf("[DEBUG] Received PACKET_TYPE_USAGE from user %s\n", user->id);
+            fflush(stdout); // 버퍼 비우기
 
-                cmd_rooms(user->sock); // 대화방 목록 요청 처리
-                break;
-            case PACKET_TYPE_LIST_USERS:
-                printf("[DEBUG] Received PACKET_TYPE_LIST_USERS from user %s\n", user->id);
+            cmd_usage(user); // 사용법 요청 처리
+            break;
+        case PACKET_TYPE_QUIT:
+            printf("[DEBUG] Received PACKET_TYPE_QUIT from user %s\n", user->id);
+            // 사용자 세션 종료 처리
+            printf("[INFO] User %s (fd %d) requested to quit.\n", user->id, user->sock);
+            fflush(stdout);
+            cleanup_client_session(user);
+            return CLIENT_CLOSED; // 세션 종료
+        case PACKET_TYPE_ERROR:
+            // 클라이언트 오류 메시지 처리
+            if (data) {
+                printf("[CLIENT ERROR] from %s (sock=%d): %s\n", user->id, user->sock, (char*)data);
                 fflush(stdout); // 버퍼 비우기
+            }
+            break;
+        case PACKET_TYPE_SET_ID:
+            // 클라이언트가 ID를 설정하는 패킷 처리
+            if (data && hdr->data_len > 0) {
+                ((char*)data)[hdr->data_len] = '\0';
+                char new_id[MAX_ID_LEN];
+                size_t len = hdr->data_len < sizeof(new_id) - 1 ? hdr->data_len : sizeof(new_id) - 1;
+                memcpy(new_id, data, len);
+                new_id[len] = '\0';
+
+                if (strlen(new_id) < 2 || strlen(new_id) > MAX_ID_LEN) {
+                    char error_msg[] = "Invalid ID length. Please enter 2 to 20 characters.\n";
+                    send_error(user, error_msg);
+                    break;
+                }
+                if (find_user_by_id(new_id) || db_check_user_id(new_id)) {
+                    char error_msg[BUFFER_SIZE];
+                    snprintf(error_msg, sizeof(error_msg), "ID '%s' already exists. Please choose another ID.\n", new_id);
+                    send_error(user, error_msg);
+                    break;
+                }
 
-                cmd_users(user); // 사용자 목록 요청 처리
-                break;
-            case PACKET_TYPE_KICK_USER:
-                printf("[DEBUG] Received PACKET_TYPE_KICK_USER from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
+                db_update_user_id(user, new_id); // 데이터베이스에서 ID 변경
+                rename_user(user, new_id); // ID 인덱스 갱신
 
-                if (data_buffer && pk_header.data_len > 0) {
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
-                    char target_id[MAX_ID_LEN];
-                    size_t len = pk_header.data_len < sizeof(target_id) - 1 ? pk_header.data_len : sizeof(target_id) - 1;
-                    memcpy(target_id, data_buffer, len);
-                    target_id[len] = '\0';
-                    cmd_kick(user, target_id); // 사용자 추방 명령 처리
-                }
-                break;
-            case PACKET_TYPE_CHANGE_ROOM_NAME:
-                printf("[DEBUG] Received PACKET_TYPE_CHANGE_ROOM_NAME from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
+                char ok[BUFFER_SIZE];
+                int n = snprintf(ok, sizeof(ok), "Your ID has been set to '%s'.\n", user->id);
+                user_send_packet(
+                    user,
+                    RES_MAGIC,
+                    PACKET_TYPE_SERVER_NOTICE,
+                    ok,
+                    (uint16_t)n
+                );
 
-                if (data_buffer && pk_header.data_len > 0) {
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
-                    char new_room_name[MAX_ROOM_NAME_LEN];
-                    size_t len = pk_header.data_len < sizeof(new_room_name) - 1 ? pk_header.data_len : sizeof(new_room_name) - 1;
-                    memcpy(new_room_name, data_buffer, len);
-                    new_room_name[len] = '\0';
-                    cmd_change(user, new_room_name); // 대화방 이름 변경 명령 처리
-                }
-                break;
-            case PACKET_TYPE_CHANGE_ROOM_MANAGER:
-                printf("[DEBUG] Received PACKET_TYPE_CHANGE_ROOM_MANAGER from user %s\n", user->id);
+                printf("[INFO] User ID set: %s\n", user->id);
                 fflush(stdout); // 버퍼 비우기
-
-                if (data_buffer && pk_header.data_len > 0) {
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
-                    char new_manager_id[MAX_ID_LEN];
-                    size_t len = pk_header.data_len < sizeof(new_manager_id) - 1 ? pk_header.data_len : sizeof(new_manager_id) - 1;
-                    memcpy(new_manager_id, data_buffer, len);
-                    new_manager_id[len] = '\0';
-                    cmd_manager(user, new_manager_id); // 대화방 관리자 변경 명령 처리
-                }
-                break;
-            case PACKET_TYPE_DELETE_ACCOUNT:
-                printf("[DEBUG] Received PACKET_TYPE_DELETE_ACCOUNT from user %s\n", user->id);
+            }
+            break;
+        case PACKET_TYPE_SERVER_NOTICE:
+            // 서버 공지 메시지 처리
+            if (data && hdr->data_len > 0) {
+                ((char*)data)[hdr->data_len] = '\0';
+                printf("from %s (sock=%d): %s\n", user->id, user->sock, (char*)data);
                 fflush(stdout); // 버퍼 비우기
-
-                cmd_delete_account(user); // 사용자 계정 삭제 명령 처리
-                // cmd_delete_account 함수 내에서 세션 종료 처리하므로, 이후 처리를 막기 위해 return
-                return NULL; // 스레드 종료
-                break;
-            case PACKET_TYPE_DELETE_MESSAGE:
-                printf("[DEBUG] Received PACKET_TYPE_DELETE_MESSAGE from user %s\n", user->id);
+            }
+            break;
+        // 기타 알 수 없는 패킷 타입 처리
+        default:
+            {
+                char error_msg[BUFFER_SIZE];
+                int n = snprintf(error_msg, sizeof(error_msg), "Unknown packet type: %u\n", hdr->type);
+                user_send_packet(
+                    user,
+                    RES_MAGIC,
+                    hdr->type,
+                    error_msg,
+                    (uint16_t)n
+                );
+                printf("[DEBUG] Unknown packet type %d from user %s (sock=%d)\n", hdr->type, user->id, user->sock);
                 fflush(stdout); // 버퍼 비우기
+            }
+            break;
+    }
+    return CLIENT_CONTINUE;
+}
 
-                if (data_buffer && pk_header.data_len > 0) {
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
-                    char message_id_str[16];
-                    size_t len = pk_header.data_len < sizeof(message_id_str) - 1 ? pk_header.data_len : sizeof(message_id_str) - 1;
-                    memcpy(message_id_str, data_buffer, len);
-                    message_id_str[len] = '\0';
-                    cmd_delete_message(user, message_id_str); // 메시지 삭제 명령 처리
-                }
-                break;
-            case PACKET_TYPE_HELP:
-                printf("[DEBUG] Received PACKET_TYPE_HELP from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
+// 클라이언트 프로세스 함수 (스레드 모드 - 클라이언트당 스레드 1개)
+// 한 번에 최대 FRAME_READ_BUFFER_SIZE 바이트를 읽어 디코더에 넣고 완성된 패킷을 모두 처리
+void *client_process(void *args) {
+    User *user = (User *)args;
+    user->thread = pthread_self(); // 세션 소유 스레드 기록
 
-                cmd_help(user); // 도움말 요청 처리
-                break;
-            case PACKET_TYPE_USAGE:
-                printf("[DEBUG] Received PACKET_TYPE_USAGE from user %s\n", user->id);
-                fflush(stdout); // 버퍼 비우기
+    unsigned char *read_buf = malloc(FRAME_READ_BUFFER_SIZE); // 스레드 전용 recv() 버퍼
+    if (!read_buf) {
+        perror("malloc for read buffer failed");
+        cleanup_client_session(user);
+        return NULL;
+    }
+    pthread_cleanup_push(free, read_buf); // 세션 정리 중 pthread_exit 되어도 버퍼 해제
 
-                cmd_usage(user); // 사용법 요청 처리
-                break;
-            case PACKET_TYPE_QUIT:
-                printf("[DEBUG] Received PACKET_TYPE_QUIT from user %s\n", user->id);
-                // 사용자 세션 종료 처리
-                printf("[INFO] User %s (fd %d) requested to quit.\n", user->id, user->sock);
-                fflush(stdout);
-                cleanup_client_session(user);
-                return NULL; // 스레드 종료  
-            case PACKET_TYPE_ERROR:
-                // 클라이언트 오류 메시지 처리
-                if (data_buffer) {
-                    printf("[CLIENT ERROR] from %s (sock=%d): %s\n", user->id, user->sock, (char*)data_buffer);
-                    fflush(stdout); // 버퍼 비우기
-                }
-                break;
-            case PACKET_TYPE_SET_ID:
-                // 클라이언트가 ID를 설정하는 패킷 처리
-                if (data_buffer && pk_header.data_len > 0) {
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
-                    char new_id[MAX_ID_LEN];
-                    size_t len = pk_header.data_len < sizeof(new_id) - 1 ? pk_header.data_len : sizeof(new_id) - 1;
-                    memcpy(new_id, data_buffer, len);
-                    new_id[len] = '\0';
-
-                    if (strlen(new_id) < 2 || strlen(new_id) > MAX_ID_LEN) {
-                        char error_msg[] = "Invalid ID length. Please enter 2 to 20 characters.\n";
-                        send_error(user, error_msg);
-                        break;
-                    }
-                    if (find_user_by_id_unlocked(new_id) || db_check_user_id(new_id)) {
-                        char error_msg[BUFFER_SIZE];
-                        snprintf(error_msg, sizeof(error_msg), "ID '%s' already exists. Please choose another ID.\n", new_id);
-                        send_error(user, error_msg);
-                        break;
-                    }
+    // 1. 사용자 ID 입력 요청 (재입력 요청은 디코더 처리 중에 전송)
+    send_id_prompt(user);
 
-                    db_update_user_id(user, new_id); // 데이터베이스에서 ID 변경
-                    strncpy(user->id, new_id, sizeof(user->id) - 1);
-                    user->id[sizeof(user->id) - 1] = '\0';
-
-                    char ok[BUFFER_SIZE];
-                    int n = snprintf(ok, sizeof(ok), "Your ID has been set to '%s'.\n", user->id);
-                    send_packet(
-                        user->sock,
-                        RES_MAGIC,
-                        PACKET_TYPE_SERVER_NOTICE,
-                        ok,
-                        (uint16_t)n
-                    );
-
-                    printf("[INFO] User ID set: %s\n", user->id);
-                    fflush(stdout); // 버퍼 비우기
-                }
-                break;
-            case PACKET_TYPE_SERVER_NOTICE:
-                // 서버 공지 메시지 처리
-                if (data_buffer && pk_header.data_len > 0) {
-                    ((char*)data_buffer)[pk_header.data_len] = '\0';
-                    printf("from %s (sock=%d): %s\n", user->id, user->sock, (char*)data_buffer);
-                    fflush(stdout); // 버퍼 비우기
-                }
-                break;
-            // 기타 알 수 없는 패킷 타입 처리
-            default:
-                {
-                    char error_msg[BUFFER_SIZE];
-                    int n = snprintf(error_msg, sizeof(error_msg), "Unknown packet type: %u\n", pk_header.type);
-                    send_packet(
-                        user->sock,
-                        RES_MAGIC,
-                        pk_header.type,
-                        error_msg,
-                        (uint16_t)n
-                    );
-                    printf("[DEBUG] Unknown packet type %d from user %s (sock=%d)\n", pk_header.type, user->id, user->sock);
-                    fflush(stdout); // 버퍼 비우기
-                }
-                break;
-        }
+    // 2. 수신 루프 (ID 설정 전에는 SET_ID 패킷만, 이후에는 명령/메시지 처리)
+    while (user->sock >= 0) {
+        ssize_t n = recv(user->sock, read_buf, FRAME_READ_BUFFER_SIZE, 0);
+        if (n < 0 && errno == EINTR) continue; // 인터럽트된 경우 재시도
+        if (n <= 0) break; // 연결 종료 또는 에러 발생
 
-        if (data_buffer) free(data_buffer);
-        data_buffer = NULL; // 데이터 버퍼 초기화
+        if (event_loop_feed(user, read_buf, (size_t)n) == CLIENT_CLOSED) break;
     }
 
-    // 3. 세션 종료 처리
-    cleanup_client_session(user);
+    // 3. 세션 종료 처리 (소유 스레드이므로 정리 후 스레드 종료)
     printf("[INFO] User %s (fd %d) session ended.\n", user->id, user->sock);
+    fflush(stdout);
+    cleanup_client_session(user);
+    pthread_cleanup_pop(1);
     return NULL;
 }
 
@@ -1940,8 +2213,20 @@ void process_server_cmd(void) {
         }
         db_recent_user(limit);
     }
+    else if (strcmp(cmd, "outq_stats") == 0) {
+        out_queue_print_stats(); // 느린 수신자 정책별 카운터
+    }
+    else if (strcmp(cmd, "rate_stats") == 0) {
+        rate_limit_print_stats(); // 속도 제한 설정 및 버린 패킷 수
+    }
+    else if (strcmp(cmd, "checksum_stats") == 0) {
+        checksum_print_stats(); // 체크섬 협상 설정 및 불일치로 버린 프레임 수
+    }
+    else if (strcmp(cmd, "compress_stats") == 0) {
+        compress_print_stats(); // 압축 협상 설정 및 압축률
+    }
     else if (strcmp(cmd, "help") == 0) {
-        printf("Available commands: users, rooms, user_info, room_info, recent_users, quit\n");
+        printf("Available commands: users, rooms, user_info, room_info, recent_users, outq_stats, rate_stats, checksum_stats, compress_stats, quit\n");
         fflush(stdout); // 버퍼 비우기
         return;
     }
@@ -1955,58 +2240,330 @@ void process_server_cmd(void) {
 }
 
 
-// ================================== 메인 함수 ================================
-int main() {
-    srand((unsigned)time(NULL));
-    db_init(); // 데이터베이스 초기화
-    db_reset_all_user_connected(); // 모든 사용자 연결 상태 초기화
-
-    // 다음 대화방 번호를 데이터베이스에서 불러와 설정
-    g_next_room_no = db_get_max_room_no() + 1;
-    if (g_next_room_no == 0) {
-        g_next_room_no = 1; // 최소값 1로 설정
-    }
-    printf("[INFO] Next room number initialized to %u\n", g_next_room_no);
+// 접속 거부 함수 - 안내 패킷 하나만 보내고 소켓 닫기 (세션을 만들지 않음)
+static void refuse_connection(int ns, const char *msg, const char *reason) {
+    send_packet(
+        ns,
+        RES_MAGIC,
+        PACKET_TYPE_SERVER_NOTICE,
+        msg,
+        (uint16_t)strlen(msg)
+    );
+    printf("[INFO] Connection refused: %s.\n", reason);
     fflush(stdout); // 버퍼 비우기
+    close(ns);
+}
+
+// 새 클라이언트 세션 생성 함수 - 접속 허용 확인 후 User 할당 (거부/실패 시 소켓을 닫고 NULL 반환)
+User *create_client_session(int ns) {
+    // 접속 IP별 연결 수 확인 및 예약 - 할당/스레드 생성/루프 등록 전에 거부
+    RateIpEntry *ip = NULL;
+    AdmitResult admit = rate_ip_admit(ns, &ip);
+    if (admit == ADMIT_IP_CONNS) {
+        refuse_connection(ns, "Too many connections from your address. Try again later.\n", "too many connections from one address");
+        return NULL;
+    }
+    if (admit == ADMIT_IP_HANDSHAKES) {
+        refuse_connection(ns, "Too many pending logins from your address. Try again later.\n", "too many pending handshakes from one address");
+        return NULL;
+    }
+
+    // 현재 연결 수 확인 및 예약 (목록 순회 없이 O(1))
+    if (__sync_add_and_fetch(&g_conn_count, 1) > MAX_CLIENT) {
+        __sync_fetch_and_sub(&g_conn_count, 1);
+        rate_ip_release(ip, 1);
+        char reason[64];
+        snprintf(reason, sizeof(reason), "server is full (max %d users)", MAX_CLIENT);
+        refuse_connection(ns, "Server is full. Try again later.\n", reason);
+        return NULL;
+    }
+
+    User *user = malloc(sizeof(*user));
+    if (!user) {
+        perror("malloc for User failed");
+        __sync_fetch_and_sub(&g_conn_count, 1);
+        rate_ip_release(ip, 1);
+        close(ns);
+        return NULL;
+    }
+    memset(user, 0, sizeof(*user));
+    out_queue_init(&user->outq); // 송신 큐 초기화
+    frame_decoder_init(&user->decoder); // 수신 디코더 초기화
+    work_strand_init(&user->strand, user); // 작업 풀 스트랜드 초기화
+    user->sock = ns;
+    user->room = NULL;
+    user->room_index = -1; // 대화방 미참여
+    user->pending_delete = 0; // 계정 삭제 요청 플래그 초기화
+    user->id[0] = '\0'; // ID 초기화
+    user->proto_version = 1; // v2 프레임을 받기 전까지는 v1으로 응답
+    user->codec = 0; // CRC32C 프레임을 받기 전까지는 XOR 체크섬으로 응답
+    user->features = 0; // 묶음 전송은 HELLO 또는 v2 프레임으로, 하트비트는 HELLO 또는 PONG으로 확인한 뒤 사용
+    user->max_message = PACKET_MAX_MESSAGE;
+    user->negotiated = 0;
+    rate_limiter_init(&user->rate, ip); // 속도 제한 버킷 초기화 (접속 허용 시 얻은 IP 항목 참조를 넘겨받음)
+    session_keepalive(ns); // 하트비트를 지원하지 않는 클라이언트용 연결 확인
+    session_timer_start(user); // 핸드셰이크 기한/하트비트 타이머 시작
+
+    if (db_is_sock_connected(user->sock)) {
+        // DB에 같은 소켓 번호가 연결되어 있으면 강제로 연결 해제 처리
+        db_update_user_connected(user, 0); // 이전 연결을 끊었다고 표시
+        // 이제 새로 할당 가능
+    }
+    return user;
+}
 
-    int ns;
-    struct sockaddr_in sin, cli;
-    socklen_t clientlen = sizeof(cli);
-        
-    // 서버 소켓 생성
-    if ((g_server_sock = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+// 서버 포트 리스닝 소켓 생성 함수 - 성공 시 소켓, 실패 시 -1 반환
+// reuseport가 설정된 소켓끼리는 같은 포트에 여러 개 바인딩 가능 (커널이 4-튜플 해시로 접속 분산)
+int open_listen_socket(int reuseport) {
+    int sock = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
         perror("socket");
-        exit(1);
+        return -1;
     }
 
     // SO_REUSEADDR 설정
     int optval = 1;
-    if (setsockopt(g_server_sock, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) < 0) {
+    if (setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval)) < 0) {
         perror("setsockopt");
-        close(g_server_sock);
-        exit(1);
+        close(sock);
+        return -1;
+    }
+    // SO_REUSEPORT 설정 (바인딩 전에 설정해야 함)
+    if (reuseport && setsockopt(sock, SOL_SOCKET, SO_REUSEPORT, &optval, sizeof(optval)) < 0) {
+        perror("setsockopt SO_REUSEPORT");
+        close(sock);
+        return -1;
     }
 
     // 서버 주소 설정
+    struct sockaddr_in sin;
     memset(&sin, 0, sizeof(sin));
     sin.sin_family = AF_INET;
     sin.sin_port = htons(PORTNUM);
     sin.sin_addr.s_addr = htonl(INADDR_ANY);
 
     // 바인딩
-    if (bind(g_server_sock, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
+    if (bind(sock, (struct sockaddr *)&sin, sizeof(sin)) < 0) {
         perror("bind");
-        close(g_server_sock);
-        exit(1);
+        close(sock);
+        return -1;
     }
 
     // 리스닝
-    if (listen(g_server_sock, 5) < 0) {
+    if (listen(sock, g_listen_backlog) < 0) {
         perror("listen");
-        close(g_server_sock);
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// 유닉스 도메인 리스닝 소켓 생성 함수 - 성공 시 소켓, 실패 시 -1 반환
+// '@'로 시작하는 이름은 추상 네임스페이스 (파일이 생기지 않고 마지막 참조가 닫히면 자동 해제)
+int open_unix_listen_socket(const char *path) {
+    struct sockaddr_un sun;
+    size_t len = strlen(path);
+    if (len == 0 || len >= sizeof(sun.sun_path)) {
+        fprintf(stderr, "[ERROR] Invalid unix socket path '%s'.\n", path);
+        return -1;
+    }
+
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        perror("socket (unix)");
+        return -1;
+    }
+
+    memset(&sun, 0, sizeof(sun));
+    sun.sun_family = AF_UNIX;
+    memcpy(sun.sun_path, path, len);
+    socklen_t addrlen = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + len + 1);
+    if (path[0] == '@') {
+        sun.sun_path[0] = '\0'; // 추상 네임스페이스: 주소 길이까지만 이름으로 사용 (NUL 제외)
+        addrlen--;
+    } else {
+        unlink(path); // 이전 실행에서 남은 소켓 파일 제거
+    }
+
+    // 바인딩
+    if (bind(sock, (struct sockaddr *)&sun, addrlen) < 0) {
+        perror("bind (unix)");
+        close(sock);
+        return -1;
+    }
+
+    // 리스닝
+    if (listen(sock, g_listen_backlog) < 0) {
+        perror("listen (unix)");
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+// 이벤트 루프 모드 시작 함수 - 성공 시 1, 실패 시 0 반환
+static int start_epoll_mode(void) {
+    const char *loops = getenv("CHAT_LOOPS");
+    int loop_count = loops ? atoi(loops) : 0; // 0이면 CPU 코어 수만큼 생성
+    if (event_loop_init(loop_count) < 0) {
+        fprintf(stderr, "[ERROR] Failed to start event loops.\n");
+        return 0;
+    }
+    g_io_mode = IO_MODE_EPOLL;
+    printf("[INFO] I/O mode: epoll (%d event loops)\n", g_loop_count);
+    fflush(stdout);
+    return 1;
+}
+
+// 환경 변수로 클라이언트 I/O 처리 방식 결정 (CHAT_IO_MODE=thread|epoll|uring, CHAT_LOOPS=<루프 수>)
+static void init_io_mode(void) {
+    const char *mode = getenv("CHAT_IO_MODE");
+    if (mode && strcmp(mode, "uring") == 0) {
+        if (uring_loop_init(g_server_sock, g_unix_sock) == 0) {
+            g_io_mode = IO_MODE_URING;
+            printf("[INFO] I/O mode: io_uring\n");
+            fflush(stdout);
+            return;
+        }
+        fprintf(stderr, "[ERROR] io_uring unavailable, falling back to epoll mode.\n");
+        if (start_epoll_mode()) return;
+    } else if (mode && strcmp(mode, "epoll") == 0) {
+        if (start_epoll_mode()) return;
+    } else if (mode && strcmp(mode, "thread") != 0) {
+        fprintf(stderr, "[ERROR] Unknown CHAT_IO_MODE '%s', using thread mode.\n", mode);
+    }
+    g_io_mode = IO_MODE_THREAD;
+    printf("[INFO] I/O mode: thread per client\n");
+    fflush(stdout);
+}
+
+// ================================== 메인 함수 ================================
+int main() {
+    srand((unsigned)time(NULL));
+    db_init(); // 데이터베이스 초기화
+    db_reset_all_user_connected(); // 모든 사용자 연결 상태 초기화
+
+    // 다음 대화방 번호를 데이터베이스에서 불러와 설정
+    g_next_room_no = db_get_max_room_no() + 1;
+    if (g_next_room_no == 0) {
+        g_next_room_no = 1; // 최소값 1로 설정
+    }
+    printf("[INFO] Next room number initialized to %u\n", g_next_room_no);
+    fflush(stdout); // 버퍼 비우기
+
+    int ns;
+    struct sockaddr_storage cli; // TCP/유닉스 도메인 주소 모두 수용
+    socklen_t clientlen;
+
+    // 리스너 설정 (CHAT_LISTEN_BACKLOG=<대기열 길이>, CHAT_REUSEPORT=1: epoll 모드에서 루프마다 리스너)
+    const char *backlog = getenv("CHAT_LISTEN_BACKLOG");
+    if (backlog && atoi(backlog) > 0) g_listen_backlog = atoi(backlog);
+    const char *reuseport = getenv("CHAT_REUSEPORT");
+    g_reuseport = reuseport && atoi(reuseport) > 0;
+
+    // 서버 소켓 생성 (SO_REUSEPORT 모드면 첫 번째 루프가 이 소켓을 넘겨받음)
+    if ((g_server_sock = open_listen_socket(g_reuseport)) < 0) {
         exit(1);
     }
 
+    // 유닉스 도메인 리스너 (CHAT_UNIX_SOCKET=<경로> 또는 @<추상 이름>) - 같은 호스트의 봇/브리지가 TCP를 거치지 않도록
+    const char *unix_path = getenv("CHAT_UNIX_SOCKET");
+    if (unix_path && unix_path[0]) {
+        if ((g_unix_sock = open_unix_listen_socket(unix_path)) < 0) {
+            close(g_server_sock);
+            exit(1);
+        }
+        if (unix_path[0] != '@') snprintf(g_unix_path, sizeof(g_unix_path), "%s", unix_path);
+        printf("[INFO] Unix socket listener: %s\n", unix_path);
+        fflush(stdout);
+    }
+
+    // 공유 메모리 탭 (CHAT_SHM_SOCKET=<경로> 또는 @<추상 이름>, CHAT_SHM_RING_SIZE=<방향별 바이트>)
+    // 같은 호스트의 사이드카가 이 소켓으로 접속하면 memfd 링 한 쌍을 받아 대화방 메시지 흐름을 소켓 없이 읽음
+    const char *shm_path = getenv("CHAT_SHM_SOCKET");
+    if (shm_path && shm_path[0]) {
+        const char *ring_size = getenv("CHAT_SHM_RING_SIZE");
+        uint32_t size = ring_size && atol(ring_size) > 0 ? (uint32_t)atol(ring_size) : SHM_TAP_DEFAULT_RING_SIZE;
+        if (shm_tap_init(shm_path, size) < 0) {
+            fprintf(stderr, "[ERROR] Failed to start shm tap.\n");
+            exit(1);
+        }
+        printf("[INFO] Shm tap listener: %s\n", shm_path);
+        fflush(stdout);
+    }
+
+    out_queue_configure(); // 사용자별 송신 큐 한도 설정
+    rate_limit_configure(); // 사용자/IP별 수신 패킷 속도 제한 설정
+    checksum_configure(); // 응답 체크섬(CRC32C) 협상 허용 여부 설정
+    compress_configure(); // 응답 압축(LZ4) 협상 허용 여부와 최소 길이 설정
+
+    // 연결 시간 제한 (밀리초, 0이면 비활성) - 루프가 세션을 만들기 전에 타이머 휠 준비
+    // CHAT_HANDSHAKE_TIMEOUT_MS: ID 설정 기한 / CHAT_PING_INTERVAL_MS: 무응답 시 PING 간격 / CHAT_IDLE_TIMEOUT_MS: 무응답 연결 종료
+    const char *handshake_ms = getenv("CHAT_HANDSHAKE_TIMEOUT_MS");
+    const char *ping_ms = getenv("CHAT_PING_INTERVAL_MS");
+    const char *idle_ms = getenv("CHAT_IDLE_TIMEOUT_MS");
+    g_handshake_ticks = timer_ms_to_ticks(handshake_ms ? strtoul(handshake_ms, NULL, 10) : HANDSHAKE_TIMEOUT_MS_DEFAULT);
+    g_ping_ticks = timer_ms_to_ticks(ping_ms ? strtoul(ping_ms, NULL, 10) : PING_INTERVAL_MS_DEFAULT);
+    g_idle_ticks = timer_ms_to_ticks(idle_ms ? strtoul(idle_ms, NULL, 10) : IDLE_TIMEOUT_MS_DEFAULT);
+    if (g_handshake_ticks > 0 || g_ping_ticks > 0 || g_idle_ticks > 0) {
+        if ((g_timer_fd = timer_wheel_init()) < 0) {
+            fprintf(stderr, "[ERROR] Failed to start timer wheel.\n");
+            exit(1);
+        }
+    }
+    printf("[INFO] Timeouts: handshake %llums, ping %llums, idle %llums\n",
+           (unsigned long long)g_handshake_ticks * TIMER_TICK_MS,
+           (unsigned long long)g_ping_ticks * TIMER_TICK_MS,
+           (unsigned long long)g_idle_ticks * TIMER_TICK_MS);
+    fflush(stdout);
+
+    init_io_mode(); // 클라이언트 I/O 처리 방식 설정
+
+    // 루프별 SO_REUSEPORT 리스너 - 커널이 접속을 루프에 분산하므로 accept가 메인 스레드 하나에 몰리지 않음
+    if (g_reuseport && g_io_mode == IO_MODE_EPOLL) {
+        if (event_loop_listen(g_server_sock) < 0) {
+            fprintf(stderr, "[ERROR] Failed to open per-loop listeners.\n");
+            exit(1);
+        }
+        printf("[INFO] Listeners: SO_REUSEPORT x %d (backlog %d)\n", g_loop_count, g_listen_backlog);
+    } else {
+        if (g_reuseport) {
+            fprintf(stderr, "[ERROR] CHAT_REUSEPORT requires epoll mode, using a single listener.\n");
+            g_reuseport = 0;
+        }
+        printf("[INFO] Listener: single socket (backlog %d)\n", g_listen_backlog);
+    }
+    fflush(stdout);
+
+    // 멤버 스냅샷 모드 (CHAT_ROOM_SNAPSHOT=1) - 대규모 방에서 참여/퇴장이 브로드캐스트를 막지 않도록
+    const char *snapshots = getenv("CHAT_ROOM_SNAPSHOT");
+    g_room_snapshots = snapshots && atoi(snapshots) > 0;
+    printf("[INFO] Room member snapshots: %s\n", g_room_snapshots ? "on (epoch reclamation)" : "off (per-room mutex)");
+    fflush(stdout);
+
+    // 대화방 액터 모드 (CHAT_ROOM_ACTORS=<워커 수>) - 대화방마다 소유 워커가 멤버 변경과 전송을 순서대로 처리
+    const char *actors = getenv("CHAT_ROOM_ACTORS");
+    if (actors && atoi(actors) > 0) {
+        if (room_actor_init(atoi(actors)) < 0) {
+            fprintf(stderr, "[ERROR] Failed to start room workers.\n");
+            exit(1);
+        }
+        printf("[INFO] Room actors: %d workers\n", g_room_actor_count);
+        fflush(stdout);
+    }
+
+    // 작업 풀 (이벤트 루프 모드, CHAT_WORK_THREADS=<스레드 수>, 0이면 비활성) - DB를 쓰는 명령을 I/O 루프 밖에서 실행
+    if (g_io_mode != IO_MODE_THREAD) {
+        const char *workers = getenv("CHAT_WORK_THREADS");
+        int worker_count = workers ? atoi(workers) : WORK_POOL_DEFAULT_WORKERS;
+        if (work_pool_init(worker_count) < 0) {
+            fprintf(stderr, "[ERROR] Failed to start work pool.\n");
+            exit(1);
+        }
+        printf("[INFO] Work pool: %d workers\n", g_work_pool_count);
+        fflush(stdout);
+    }
+
     // epoll 인스턴스 생성 및 이벤트 배열 선언
     g_epfd = epoll_create(1);
     if (g_epfd < 0) {
@@ -2018,16 +2575,31 @@ int main() {
     int epoll_num = 0;
     struct epoll_event ev, events[MAX_CLIENT];
 
-    // 서버 소켓 epoll 등록 (클라이언트 접속 감지용)
-    ev.events = EPOLLIN;
-    ev.data.fd = g_server_sock;
-    epoll_ctl(g_epfd, EPOLL_CTL_ADD, g_server_sock, &ev);
+    // 서버 소켓 epoll 등록 (클라이언트 접속 감지용, io_uring 모드는 링에서, SO_REUSEPORT 모드는 각 루프에서 직접 accept)
+    if (g_io_mode != IO_MODE_URING && !g_reuseport) {
+        ev.events = EPOLLIN;
+        ev.data.fd = g_server_sock;
+        epoll_ctl(g_epfd, EPOLL_CTL_ADD, g_server_sock, &ev);
+    }
+    // 유닉스 도메인 소켓 epoll 등록 (io_uring 모드는 링에서 직접 accept)
+    if (g_io_mode != IO_MODE_URING && g_unix_sock >= 0) {
+        ev.events = EPOLLIN;
+        ev.data.fd = g_unix_sock;
+        epoll_ctl(g_epfd, EPOLL_CTL_ADD, g_unix_sock, &ev);
+    }
 
     // 표준입력 stdin(epoll용) 등록 (관리자 명령 입력)
     ev.events = EPOLLIN;
     ev.data.fd = 0;
     epoll_ctl(g_epfd, EPOLL_CTL_ADD, 0, &ev);
 
+    // 타이머 휠 timerfd 등록 (연결 시간 제한 확인)
+    if (g_timer_fd >= 0) {
+        ev.events = EPOLLIN;
+        ev.data.fd = g_timer_fd;
+        epoll_ctl(g_epfd, EPOLL_CTL_ADD, g_timer_fd, &ev);
+    }
+
     printf("Server started.\n");
     fflush(stdout); // 버퍼 비우기
 
@@ -2036,67 +2608,44 @@ int main() {
         // 이벤트 발생한 소켓만 감지
         if ((epoll_num = epoll_wait(g_epfd, events, MAX_CLIENT, -1)) > 0) {
            for (int i = 0; i < epoll_num; i++) {
-                // 1. 서버 소켓: 새 클라이언트 연결 요청 수락
-                if (events[i].data.fd == g_server_sock) {
-                    ns = accept(g_server_sock, (struct sockaddr *)&cli, &clientlen);
+                // 1. 서버 소켓/유닉스 도메인 소켓: 새 클라이언트 연결 요청 수락 (이후 처리는 동일)
+                if (events[i].data.fd == g_server_sock || events[i].data.fd == g_unix_sock) {
+                    clientlen = sizeof(cli);
+                    ns = accept(events[i].data.fd, (struct sockaddr *)&cli, &clientlen);
                     if (ns < 0) {
                         perror("accept");
                         continue; // 다음 이벤트로 넘어감
                     }
                     
-                    // 현재 접속 중인 사용자 수 계산
-                    int user_count = 0;
-                    pthread_mutex_lock(&g_users_mutex);
-                    User *tmp_user = g_users;
-                    while (tmp_user != NULL) {
-                        user_count++;
-                        tmp_user = tmp_user->next;
-                    }
-                    pthread_mutex_unlock(&g_users_mutex);
-
-                    if (user_count >= MAX_CLIENT) {
-                        char *msg = "Server is full. Try again later.\n";
-                        send_packet(
-                            ns,
-                            RES_MAGIC,
-                            PACKET_TYPE_SERVER_NOTICE,
-                            msg,
-                            (uint16_t)strlen(msg)
-                        );
-                        printf("[INFO] Connection refused: server is full (max %d users).\n", MAX_CLIENT);
-                        fflush(stdout); // 버퍼 비우기
-                        close(ns);
-                    } else {
-                        User *user = malloc(sizeof(*user));
-                        if (!user) {
-                            perror("malloc for User failed");
-                            close(ns);
-                            continue; // 메모리 할당 실패 시 다음 이벤트로 넘어감
-                        }
-                        memset(user, 0, sizeof(*user));
-                        user->sock = ns;
-                        user->room = NULL;
-                        user->pending_delete = 0; // 계정 삭제 요청 플래그 초기화
-                        user->id[0] = '\0'; // ID 초기화
-
-                        if (db_is_sock_connected(user->sock)) {
-                            // DB에 같은 소켓 번호가 연결되어 있으면 강제로 연결 해제 처리
-                            db_update_user_connected(user, 0); // 이전 연결을 끊었다고 표시
-                            // 이제 새로 할당 가능 (continue하지 않고 아래로 진행)
-                        }
-                        
-                        // 클라이언트 전용 스레드 생성
-                        if (pthread_create(&user->thread, NULL, client_process, user) != 0) {
-                            perror("pthread_create");
-                            free(user); // 스레드 생성 실패 시 메모리 해제
+                    User *user = create_client_session(ns);
+                    if (!user) continue; // 접속 거부 또는 할당 실패 시 다음 이벤트로 넘어감
+
+                    if (g_io_mode == IO_MODE_EPOLL) {
+                        // 이벤트 루프에 소켓 등록 (루프 간 라운드 로빈 분배)
+                        if (event_loop_add_user(user) < 0) {
+                            destroy_client_session(user);
                             close(ns);
-                            continue; // 다음 이벤트로 넘어감
                         }
-                        pthread_detach(user->thread); // 리소스 자동 회수
+                        continue; // 다음 이벤트로 넘어감
+                    }
+                    
+                    // 클라이언트 전용 스레드 생성
+                    if (pthread_create(&user->thread, NULL, client_process, user) != 0) {
+                        perror("pthread_create");
+                        destroy_client_session(user); // 스레드 생성 실패 시 메모리 해제
+                        close(ns);
+                        continue; // 다음 이벤트로 넘어감
                     }
+                    pthread_detach(user->thread); // 리소스 자동 회수
                 // stdin 입력 처리 (CLI 명령)
                 } else if (events[i].data.fd == 0) {
                     process_server_cmd();
+                // 타이머 틱: 만료된 세션 타이머 실행 (핸드셰이크 기한, PING, 유휴 종료)
+                } else if (g_timer_fd >= 0 && events[i].data.fd == g_timer_fd) {
+                    timer_wheel_expire();
+                // 클라이언트 소켓 쓰기 가능 (스레드 모드 송신 큐 비우기)
+                } else if (events[i].events & EPOLLOUT) {
+                    user_handle_writable_fd(events[i].data.fd);
                 }
             }
         }
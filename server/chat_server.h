@@ -5,9 +5,14 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <sys/types.h>
+#include <sys/socket.h>
 #include <time.h>
 #include "db_helper.h"
 #include "../common/chat_protocol.h"
+#include "out_queue.h"
+#include "work_pool.h"
+#include "timer_wheel.h"
+#include "rate_limit.h"
 
 // ================== 패킷 헤더 및 구조체 정의 ===================
 #define HEADER_SIZE         sizeof(PacketHeader)
@@ -16,7 +21,31 @@
 #define BUFFER_SIZE         2048
 #define MAX_ROOM_NAME_LEN   32
 #define MAX_ID_LEN          20
-
+#define CHAT_MESSAGE_MAX    (BUFFER_SIZE - MAX_ID_LEN - 5) // 채팅 본문 최대 길이 - "[id] 본문\n" 방송이 v1 클라이언트 수신 버퍼(BUFFER_SIZE - 1) 안에 들어가도록
+#define ROOM_MEMBERS_INIT_CAP 8         // 대화방 멤버 배열 초기 용량
+#define HISTORY_BATCH_BYTES (64 * 1024) // 묶음 전송 세션에 대화 기록을 묶어 보내는 단위 (바이트)
+#define UNIX_PATH_MAX_LEN   108         // 유닉스 도메인 소켓 경로 최대 길이 (sockaddr_un.sun_path)
+#define HANDSHAKE_TIMEOUT_MS_DEFAULT 30000  // 접속 후 ID 설정까지 허용 시간 (CHAT_HANDSHAKE_TIMEOUT_MS, 0이면 무제한)
+#define PING_INTERVAL_MS_DEFAULT     30000  // 수신이 없는 하트비트 지원 연결에 PING을 보내는 간격 (CHAT_PING_INTERVAL_MS, 0이면 사용 안 함)
+#define IDLE_TIMEOUT_MS_DEFAULT      120000 // 하트비트 지원 연결에서 수신(PONG 포함)이 없으면 끊는 시간 (CHAT_IDLE_TIMEOUT_MS, 0이면 무제한)
+#define LISTEN_BACKLOG_DEFAULT SOMAXCONN // listen() 대기열 기본 길이 (CHAT_LISTEN_BACKLOG로 변경, 커널 somaxconn으로 제한됨)
+
+// 클라이언트 I/O 처리 방식
+typedef enum {
+    IO_MODE_THREAD,                     // 클라이언트당 스레드 1개 (블로킹 recv)
+    IO_MODE_EPOLL,                      // 코어별 이벤트 루프 + 논블로킹 소켓
+    IO_MODE_URING                       // io_uring 단일 링 (multishot accept, 제공 버퍼 recv, 일괄 send)
+} IoMode;
+
+// 패킷 처리 결과
+typedef enum {
+    CLIENT_CLOSED   = -1,               // 세션 종료됨 (더 이상 user 접근 불가)
+    CLIENT_CONTINUE = 0,                // 계속 처리
+    CLIENT_RETRY_ID = 1                 // ID 재입력 필요
+} ClientStatus;
+
+struct EventLoop;                       // 이벤트 루프 (event_loop.h)
+struct RoomWorker;                      // 대화방 워커 (room_actor.h)
 
 // User 구조체
 typedef struct User {
@@ -26,19 +55,44 @@ typedef struct User {
     struct Room *room;                  // 대화방 포인터
     struct User *next;                  // 다음 사용자 포인터
     struct User *prev;                  // 이전 사용자 포인터
-    struct User *room_user_next;        // 대화방 내 사용자 포인터
-    struct User *room_user_prev;        // 대화방 내 사용자 포인터
+    int room_index;                     // 대화방 멤버 배열 내 위치 (O(1) 제거용)
     int pending_delete;                 // 계정 삭제 대기 여부
+    int closing;                        // 세션 정리 진행 여부
+    struct EventLoop *loop;             // 소유 이벤트 루프 (epoll 모드)
+    FrameDecoder decoder;               // 수신 프레임 증분 디코더 (여러 recv()에 걸친 패킷 조립)
+    OutQueue outq;                      // 송신 대기 큐 (브로드캐스트가 블로킹되지 않도록)
+    WorkStrand strand;                  // 작업 풀로 넘긴 패킷을 순서대로 실행하는 스트랜드 (이벤트 루프 모드)
+    TimerEntry timer;                   // 핸드셰이크 기한/하트비트/유휴 확인 타이머
+    uint64_t connect_tick;              // 접속 시각 (타이머 틱)
+    uint64_t last_active;               // 마지막 수신 시각 (타이머 틱, 수신 스레드가 원자적으로 기록)
+    RateLimiter rate;                   // 사용자/접속 IP별 토큰 버킷 (수신 패킷 처리 전에 확인)
+    int proto_version;                  // 클라이언트 프로토콜 버전 (HELLO로 합의하거나 v2 프레임을 한 번이라도 보내면 2, 큰 응답을 조각으로 전송)
+    uint8_t codec;                      // 이 세션에 보내는 프레임의 코덱 플래그 (PACKET_CODEC_MASK 범위, 수신 스레드가 원자적으로 기록)
+    uint8_t features;                   // 사용할 수 있는 HELLO_FEATURE_* 비트
+    uint32_t max_message;               // 이 세션에 보내는 메시지 최대 길이 (HELLO로 합의, 기본값 PACKET_MAX_MESSAGE)
+    int negotiated;                     // HELLO로 협상을 마쳤는지 여부 (이후 수신 프레임으로 응답 방식을 바꾸지 않음)
+    unsigned long checksum_errors;      // 체크섬이 틀려 버린 수신 프레임 수
 } User;
 
+// 대화방 멤버 스냅샷 - 게시 후 수정하지 않음 (스냅샷 모드에서 브로드캐스트가 잠금 없이 순회)
+typedef struct MemberSnapshot {
+    int count;                          // 멤버 수
+    User *members[];                    // 멤버 배열 (게시 시점의 복사본)
+} MemberSnapshot;
+
 // Room 구조체
 typedef struct Room {
     unsigned int no;                    // 방 고유 번호
     char room_name[MAX_ROOM_NAME_LEN];                 // 방 이름
     time_t created_time;                // 생성된 시간
+    pthread_mutex_t mutex;              // 대화방별 뮤텍스 (멤버 배열/방장 보호, 디렉터리 잠금 다음에 잠금)
     User *manager;                      // 방장
     int member_count;                   // 생에 참여중인 멤버 수
-    User *members[MAX_CLIENT];          // 방에 참여중인 멤버 목록
+    int member_cap;                     // 멤버 배열 용량 (필요 시 두 배로 확장)
+    User **members;                     // 방에 참여중인 멤버 배열 (순서 없음, 제거 시 마지막 멤버로 채움)
+    MemberSnapshot *snapshot;           // 스냅샷 모드: 현재 게시된 멤버 스냅샷 (교체된 스냅샷은 에포크 회수)
+    struct RoomWorker *owner;           // 액터 모드: 멤버 변경/전송을 전담하는 워커 (NULL: 비활성)
+    unsigned long seq;                  // 액터 모드: 마지막으로 부여한 대화방 메시지 순번 (워커 전용)
     struct Room *next;                  // 다음 방 포인터
     struct Room *prev;                  // 이전 방 포인터
 } Room;
@@ -64,14 +118,23 @@ extern client_cmd_t cmd_tbl_client[]; // 클라이언트 명령어 테이블
 
 // ================== 전역 변수 ===================
 extern User *g_users;                // 연결된 사용자 목록 (헤드 포인터)
+extern unsigned long g_conn_count;   // 현재 연결 수 (ID 설정 전 세션 포함)
 extern Room *g_rooms;                // 생성된 대화방 목록 (헤드 포인터)
 extern int  g_server_sock;           // 서버 소켓 디스크립터
+extern int  g_unix_sock;             // 유닉스 도메인 리스닝 소켓 디스크립터 (CHAT_UNIX_SOCKET, 없으면 -1)
 extern int  g_epfd;                  // epoll 인스턴스 디스크립터
 extern unsigned int g_next_room_no;  // 다음 대화방 고유 번호
+extern IoMode g_io_mode;             // 클라이언트 I/O 처리 방식
+extern int  g_room_snapshots;        // 멤버 스냅샷 모드 여부 (CHAT_ROOM_SNAPSHOT=1)
+extern int  g_listen_backlog;        // listen() 대기열 길이 (CHAT_LISTEN_BACKLOG)
+extern int  g_reuseport;             // 루프별 SO_REUSEPORT 리스너 모드 여부 (CHAT_REUSEPORT=1)
+extern uint64_t g_handshake_ticks;   // 핸드셰이크 기한 (틱, 0이면 무제한)
+extern uint64_t g_ping_ticks;        // 하트비트 간격 (틱, 0이면 사용 안 함)
+extern uint64_t g_idle_ticks;        // 유휴 연결 종료 시간 (틱, 0이면 무제한)
 
 // 동기화(Mutex) 사용하여 스레드 상호 배제를 통해 안전하게 처리
 extern pthread_mutex_t g_users_mutex; // 사용자 목록 보호용 뮤텍스
-extern pthread_mutex_t g_rooms_mutex; // 대화방 목록 보호용 뮤텍스
+extern pthread_rwlock_t g_rooms_lock; // 대화방 디렉터리 보호용 읽기/쓰기 잠금 (생성/제거/이름 변경만 쓰기 잠금)
 extern pthread_mutex_t g_db_mutex; // 데이터베이스 접근 보호용 뮤텍스
 
 
@@ -83,25 +146,42 @@ void send_error(User *user, const char *error_msg);
 void list_add_user(User *user);
 void list_remove_user(User *user);
 User *find_user_by_sock(int sock);
+User *find_user_by_sock_unlocked(int sock);         // g_users_mutex 보유 상태에서 호출
 User *find_user_by_id(const char *id);
+User *find_user_by_id_unlocked(const char *id);     // g_users_mutex 보유 상태에서 호출
+void rename_user(User *user, const char *new_id);   // 사용자 ID 변경 (ID 인덱스 갱신)
 
 void list_add_room(Room *room);
 void list_remove_room(Room *room);
 Room *find_room(const char *name);
 Room *find_room_by_no(unsigned int no);
+Room *find_room_by_no_unlocked(unsigned int no);    // g_rooms_lock 보유 상태에서 호출
+void room_add_member_unlocked(Room *room, User *user);    // room->mutex 보유 상태(또는 소유 워커)에서 호출
+void room_remove_member_unlocked(Room *room, User *user); // room->mutex 보유 상태(또는 소유 워커)에서 호출
+Room *join_room(unsigned int no, User *user);       // 번호로 대화방 참여 (메모리+DB 동기화, 없으면 NULL)
 
 // db + 메모리 동기화를 한 번에 수행하는 함수
 void add_user(User *user);                          // 사용자 추가
 void remove_user(User *user);                       // 사용자 제거
-void add_room(Room *room);                          // 대화방 추가
+int add_room(Room *room);                           // 대화방 추가 (실패 시 -1, room 해제됨)
 void remove_room(Room *room);                       // 대화방 제거
-void add_user_to_room(Room *room, User *user);      // 대화방 참여자 추가
-void remove_user_from_room(Room *room, User *user); // 대화방 참여자 제거
-void destroy_room_if_empty(Room *room);             // 대화방이 비어있으면 제거
+void remove_user_from_room(Room *room, User *user, User *sender, const char *notice); // 대화방 참여자 제거 및 남은 참여자에게 안내 (비면 대화방 제거)
+void destroy_room_if_empty(unsigned int no);        // 대화방이 비어있으면 제거
+void free_room(Room *room);                         // 대화방 및 멤버 배열 메모리 해제
 // ============ 브로드캐스트 함수 ============
 void broadcast_server_message_to_room(Room *room, User *sender, const char *message_text); // 특정 방에 있는 모든 사용자(발신자 제외)에 메시지 전송
+void broadcast_frame_to_room(Room *room, User *sender, SharedFrame *frame); // 인코딩된 공유 프레임을 방 참여자(발신자 제외)에 전송
 // ============ 클라이언트 세션 정리 함수 ============
 void cleanup_client_session(User *user);
+void destroy_client_session(User *user);            // 송신 큐/디코더/메모리 해제 및 연결 수 감소
+// ============ 클라이언트 패킷 처리 함수 ============
+void send_id_prompt(User *user);
+int client_handle_id_packet(User *user, const FrameHeader *hdr, const unsigned char *data);
+int client_handle_packet(User *user, const FrameHeader *hdr, unsigned char *data);
+void *client_process(void *args);
+User *create_client_session(int ns);
+int open_listen_socket(int reuseport);              // 서버 포트 리스닝 소켓 생성 (reuseport: SO_REUSEPORT 설정) - 실패 시 -1 반환
+int open_unix_listen_socket(const char *path);      // 유닉스 도메인 리스닝 소켓 생성 ('@'로 시작하면 추상 네임스페이스) - 실패 시 -1 반환
 
 // ============ 서버 CLI 명령어 ============
 void server_user(void);                             // users 명령: 사용자 목록
@@ -113,7 +193,7 @@ void server_quit(void);                             // quit 명령: 서버 종
 void cmd_users(User *user);
 void cmd_users_wrapper(User *user, char *args);
 
-void cmd_rooms(int sock);
+void cmd_rooms(User *user);
 void cmd_rooms_wrapper(User *user, char *args);
 
 void cmd_id(User *user, char *args);
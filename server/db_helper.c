@@ -606,7 +606,6 @@ void db_add_user_to_room(Room *room, User *user) {
             fprintf(stderr, "SQL add user to room error: %s\n", sqlite3_errmsg(db));
         } else {
             printf("[DB] User '%s' added to room '%s' successfully\n", user->id, room->room_name);
-            db_update_room_member_count(room); // 멤버 수 업데이트
         }
         sqlite3_finalize(stmt);
     } else {
@@ -637,7 +636,6 @@ void db_remove_user_from_room(Room *room, User *user) {
             fprintf(stderr, "SQL remove user from room error: %s\n", sqlite3_errmsg(db));
         } else {
             printf("[DB] User '%s' removed from room '%s' successfully\n", user->id, room->room_name);
-            db_update_room_member_count(room); // 멤버 수 업데이트
         }
         sqlite3_finalize(stmt);
     } else {
@@ -865,6 +863,15 @@ void db_insert_message(Room *room, User *user, const char *message) {
         fprintf(stderr, "Invalid room, user or message\n");
         return;
     }
+    db_insert_message_by_no(room->no, user->id, message);
+}
+
+// 메시지 추가 함수 - 대화방 번호와 발신자 ID 값으로 저장 (세션/대화방 수명과 무관하게 나중에 실행 가능)
+void db_insert_message_by_no(unsigned int room_no, const char *sender_id, const char *message) {
+    if (!sender_id || !message || strlen(message) == 0) {
+        fprintf(stderr, "Invalid room, user or message\n");
+        return;
+    }
 
     pthread_mutex_lock(&g_db_mutex);
 
@@ -873,14 +880,14 @@ void db_insert_message(Room *room, User *user, const char *message) {
     sqlite3_stmt *stmt;
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc == SQLITE_OK) {
-        sqlite3_bind_int(stmt, 1, room->no);
-        sqlite3_bind_text(stmt, 2, user->id, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 1, room_no);
+        sqlite3_bind_text(stmt, 2, sender_id, -1, SQLITE_STATIC);
         sqlite3_bind_text(stmt, 3, message, -1, SQLITE_STATIC);
         rc = sqlite3_step(stmt);
         if (rc != SQLITE_DONE) {
             fprintf(stderr, "SQL insert message error: %s\n", sqlite3_errmsg(db));
         } else {
-            printf("[DB] Message from '%s' in room '%s' added successfully\n", user->id, room->room_name);
+            printf("[DB] Message from '%s' in room %u added successfully\n", sender_id, room_no);
         }
         sqlite3_finalize(stmt);
     } else {
@@ -994,11 +1001,11 @@ void db_get_room_message(Room *room, User *user) {
     if (!first_join_time) {
         // 입장 기록이 없으면 메시지 없음
         char msg[] = "[Server] No chat history found for you in this room.\n";
-        send_packet(user->sock,
-                    RES_MAGIC,
-                    PACKET_TYPE_SERVER_NOTICE,
-                    msg,
-                    (uint16_t)strlen(msg)
+        user_send_packet(user,
+                         RES_MAGIC,
+                         PACKET_TYPE_SERVER_NOTICE,
+                         msg,
+                         (uint16_t)strlen(msg)
         );
         pthread_mutex_unlock(&g_db_mutex);
         return;
@@ -1018,21 +1025,41 @@ void db_get_room_message(Room *room, User *user) {
     sqlite3_bind_int(stmt_msg, 1, room->no);
     sqlite3_bind_text(stmt_msg, 2, first_join_time, -1, SQLITE_STATIC);
 
-    char msg_buf[BUFFER_SIZE];
+    char msg_buf[BUFFER_SIZE * 2]; // 한 줄 최대 길이 - 본문에 시각/발신자를 붙여도 담기고 묶음 단위(최소 HELLO_MIN_MESSAGE)보다 크지 않음
     int found = 0;
+    // 묶음 전송 세션: 여러 줄을 HISTORY_BATCH_BYTES(합의한 최대 메시지 길이가 더 작으면 그 길이) 단위로 모아 조각 프레임 하나로 전송
+    // 그 외 세션은 줄마다 패킷 하나
+    size_t batch_max = user->max_message < HISTORY_BATCH_BYTES ? user->max_message : HISTORY_BATCH_BYTES;
+    char *batch = (user->features & HELLO_FEATURE_BATCH) ? malloc(batch_max) : NULL;
+    size_t batch_len = 0;
     while (sqlite3_step(stmt_msg) == SQLITE_ROW) {
         const char *sender_id = (const char *)sqlite3_column_text(stmt_msg, 0);
         const char *context = (const char *)sqlite3_column_text(stmt_msg, 1);
         const char *timestamp = (const char *)sqlite3_column_text(stmt_msg, 2);
         
-        snprintf(msg_buf, sizeof(msg_buf), "[%s] %s: %s\n",
+        int n = snprintf(msg_buf, sizeof(msg_buf), "[%s] %s: %s\n",
                  timestamp ? timestamp : "(time)", sender_id ? sender_id : "(unknown)", context ? context : "(empty)");
-        send_packet(user->sock, RES_MAGIC, PACKET_TYPE_MESSAGE, msg_buf, (uint16_t)strlen(msg_buf));
+        size_t len = n < 0 ? 0 : ((size_t)n < sizeof(msg_buf) ? (size_t)n : sizeof(msg_buf) - 1);
+        if (user->proto_version < 2 && len > BUFFER_SIZE - 1) {
+            len = BUFFER_SIZE - 1; // v1 클라이언트는 BUFFER_SIZE 버퍼로 한 패킷을 받으므로 기존과 같이 잘라서 전송
+        }
         found = 1;
+        if (!batch) {
+            user_send_packet(user, RES_MAGIC, PACKET_TYPE_MESSAGE, msg_buf, (uint16_t)len);
+            continue;
+        }
+        if (batch_len + len > batch_max) {
+            user_send_payload(user, RES_MAGIC, PACKET_TYPE_MESSAGE, batch, batch_len);
+            batch_len = 0;
+        }
+        memcpy(batch + batch_len, msg_buf, len);
+        batch_len += len;
     }
+    if (batch && batch_len > 0) user_send_payload(user, RES_MAGIC, PACKET_TYPE_MESSAGE, batch, batch_len);
+    free(batch);
     if (!found) {
         char msg[] = "[Server] No chat history found for you in this room.\n";
-        send_packet(user->sock, RES_MAGIC, PACKET_TYPE_MESSAGE, msg, (uint16_t)strlen(msg));
+        user_send_packet(user, RES_MAGIC, PACKET_TYPE_MESSAGE, msg, (uint16_t)strlen(msg));
     }
     sqlite3_finalize(stmt_msg);
     pthread_mutex_unlock(&g_db_mutex);
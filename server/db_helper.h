@@ -47,6 +47,7 @@ void db_get_all_rooms();                                             // 모든 
 
 // ===== 메시지 관련 함수 =====
 void db_insert_message(Room *room, User *user, const char *message); // 메시지 추가
+void db_insert_message_by_no(unsigned int room_no, const char *sender_id, const char *message); // 메시지 추가 (값 복사본으로, 작업 스레드용)
 int db_remove_message_by_id(Room *room, User *user, int message_id); // 특정 메시지 ID로 삭제
 void db_get_room_message(Room *room, User *user);                    // 대화방 메시지 가져오기
 
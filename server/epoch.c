@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <sched.h>
+#include "epoch.h"
+
+// 스레드별 읽기 슬롯 - 읽기 구역 안이면 진입 시점의 전역 에포크, 밖이면 0
+typedef struct {
+    uint64_t epoch;                     // 진입 시 관찰한 에포크 (0: 읽기 구역 밖)
+    int used;                           // 스레드에 할당되었는지 여부
+} __attribute__((aligned(64))) EpochSlot; // 캐시 라인 단위로 분리 (읽기 스레드끼리 경합 없음)
+
+// 회수 대기 항목
+typedef struct EpochRetired {
+    struct EpochRetired *next;          // 다음 항목
+    void *ptr;                          // 해제할 포인터
+    EpochFreeFn free_fn;                // 해제 함수
+    uint64_t epoch;                     // 교체 시점의 에포크 (이 값 이하로 진입한 스레드가 남아있으면 대기)
+} EpochRetired;
+
+// ================== 전역 변수 ===================
+static EpochSlot g_epoch_slots[EPOCH_MAX_READERS]; // 읽기 슬롯 배열
+static int g_epoch_slot_hwm = 0;                    // 한 번이라도 할당된 슬롯 수 (스캔 범위)
+static uint64_t g_epoch = 1;                        // 전역 에포크 (교체마다 증가, 0은 사용하지 않음)
+static EpochRetired *g_retired = NULL;              // 회수 대기 목록
+static pthread_mutex_t g_retired_mutex = PTHREAD_MUTEX_INITIALIZER; // 회수 대기 목록 보호용 뮤텍스
+static pthread_key_t g_epoch_key;                   // 스레드 종료 시 슬롯 반환용 키
+static pthread_once_t g_epoch_once = PTHREAD_ONCE_INIT;
+static __thread EpochSlot *t_slot = NULL;           // 현재 스레드의 슬롯
+
+// 스레드 종료 시 슬롯 반환
+static void epoch_release_slot(void *arg) {
+    EpochSlot *slot = arg;
+    __atomic_store_n(&slot->epoch, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&slot->used, 0, __ATOMIC_RELEASE);
+}
+
+static void epoch_init_key(void) {
+    pthread_key_create(&g_epoch_key, epoch_release_slot);
+}
+
+// 현재 스레드의 슬롯 할당 (처음 진입 시 한 번, 빈 슬롯이 없으면 생길 때까지 양보)
+static EpochSlot *epoch_get_slot(void) {
+    if (t_slot) return t_slot;
+    pthread_once(&g_epoch_once, epoch_init_key);
+
+    for (;;) {
+        for (int i = 0; i < EPOCH_MAX_READERS; i++) {
+            int expected = 0;
+            if (__atomic_compare_exchange_n(&g_epoch_slots[i].used, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+                t_slot = &g_epoch_slots[i];
+                pthread_setspecific(g_epoch_key, t_slot);
+                int hwm = __atomic_load_n(&g_epoch_slot_hwm, __ATOMIC_SEQ_CST);
+                while (hwm < i + 1 && !__atomic_compare_exchange_n(&g_epoch_slot_hwm, &hwm, i + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST));
+                return t_slot;
+            }
+        }
+        sched_yield();
+    }
+}
+
+// 읽기 구역 진입 - 슬롯에 현재 에포크를 기록한 뒤 공유 포인터를 읽음
+void epoch_enter(void) {
+    EpochSlot *slot = epoch_get_slot();
+    uint64_t e = __atomic_load_n(&g_epoch, __ATOMIC_SEQ_CST);
+    __atomic_store_n(&slot->epoch, e, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST); // 슬롯 기록이 이후 포인터 읽기보다 먼저 보이도록
+}
+
+// 읽기 구역 종료
+void epoch_exit(void) {
+    __atomic_store_n(&t_slot->epoch, 0, __ATOMIC_RELEASE);
+}
+
+// 읽기 구역에 있는 스레드 중 가장 오래된 진입 에포크 (없으면 UINT64_MAX)
+static uint64_t epoch_min_active(void) {
+    uint64_t min = UINT64_MAX;
+    int hwm = __atomic_load_n(&g_epoch_slot_hwm, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < hwm; i++) {
+        uint64_t e = __atomic_load_n(&g_epoch_slots[i].epoch, __ATOMIC_SEQ_CST);
+        if (e && e < min) min = e;
+    }
+    return min;
+}
+
+// 교체된 포인터 회수 등록 - 새 포인터를 먼저 게시한 뒤 호출
+void epoch_retire(void *ptr, EpochFreeFn free_fn) {
+    if (!ptr) return;
+
+    EpochRetired *r = malloc(sizeof(*r));
+    if (!r) {
+        // 대기열에 넣을 수 없으면 모든 읽기 스레드가 나갈 때까지 기다린 뒤 바로 해제
+        perror("malloc for epoch retire failed");
+        epoch_synchronize();
+        free_fn(ptr);
+        return;
+    }
+    r->ptr = ptr;
+    r->free_fn = free_fn;
+    r->epoch = __atomic_fetch_add(&g_epoch, 1, __ATOMIC_SEQ_CST); // 이후 진입하는 스레드는 새 포인터만 봄
+
+    pthread_mutex_lock(&g_retired_mutex);
+    r->next = g_retired;
+    g_retired = r;
+    pthread_mutex_unlock(&g_retired_mutex);
+
+    epoch_reclaim();
+}
+
+// 안전해진 회수 대기 항목 해제 - 교체 시점 이하의 에포크로 진입한 스레드가 없으면 해제 가능
+void epoch_reclaim(void) {
+    uint64_t min = epoch_min_active();
+    EpochRetired *done = NULL;
+
+    pthread_mutex_lock(&g_retired_mutex);
+    EpochRetired **pp = &g_retired;
+    while (*pp) {
+        EpochRetired *r = *pp;
+        if (r->epoch < min) {
+            *pp = r->next;
+            r->next = done;
+            done = r;
+        } else {
+            pp = &r->next;
+        }
+    }
+    pthread_mutex_unlock(&g_retired_mutex);
+
+    // 해제 함수는 뮤텍스 밖에서 호출
+    while (done) {
+        EpochRetired *next = done->next;
+        done->free_fn(done->ptr);
+        free(done);
+        done = next;
+    }
+}
+
+// 현재 읽기 구역에 있는 스레드가 모두 나갈 때까지 대기 (이후 진입하는 스레드는 기다리지 않음)
+void epoch_synchronize(void) {
+    uint64_t e = __atomic_fetch_add(&g_epoch, 1, __ATOMIC_SEQ_CST);
+    int hwm = __atomic_load_n(&g_epoch_slot_hwm, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < hwm; i++) {
+        EpochSlot *slot = &g_epoch_slots[i];
+        if (slot == t_slot) continue; // 자기 자신은 읽기 구역 밖에서만 호출
+        for (;;) {
+            uint64_t se = __atomic_load_n(&slot->epoch, __ATOMIC_SEQ_CST);
+            if (se == 0 || se > e) break;
+            sched_yield();
+        }
+    }
+}
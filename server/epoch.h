@@ -0,0 +1,22 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdint.h>
+
+// ================== 에포크 기반 메모리 회수 설정 ===================
+#define EPOCH_MAX_READERS       1024    // 동시에 읽기 구역을 사용할 수 있는 최대 스레드 수
+
+// 회수 시 호출할 해제 함수
+typedef void (*EpochFreeFn)(void *ptr);
+
+// ================== 함수 프로토타입 ===================
+// 읽기 구역 진입/종료 - 구역 안에서 읽은 공유 포인터는 종료 전까지 해제되지 않음 (중첩 불가, 구역 안에서 블로킹 금지)
+void epoch_enter(void);
+void epoch_exit(void);
+
+// 교체된 포인터를 회수 대기열에 등록 - 이미 구역에 들어와 있던 읽기 스레드가 모두 나간 뒤 free_fn 호출
+void epoch_retire(void *ptr, EpochFreeFn free_fn);
+void epoch_reclaim(void);               // 안전해진 항목 해제 (epoch_retire에서도 호출)
+void epoch_synchronize(void);           // 현재 읽기 구역에 있는 스레드가 모두 나갈 때까지 대기 (읽기 구역 밖에서 호출)
+
+#endif // EPOCH_H
@@ -0,0 +1,469 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <arpa/inet.h>
+#include "chat_server.h"
+#include "event_loop.h"
+#include "chat_checksum.h"
+#include "chat_compress.h"
+
+// ================== 전역 변수 초기화 ===================
+EventLoop *g_loops = NULL;      // 이벤트 루프 배열
+int g_loop_count = 0;           // 이벤트 루프 수
+static unsigned int g_next_loop = 0; // 다음에 연결을 배정할 루프 (라운드 로빈)
+ChecksumStats g_checksum_stats;         // 수신 체크섬 누적 카운터
+static int g_checksum_crc32c = 1;       // CRC32C 프레임을 보낸 세션에 CRC32C로 응답할지 여부 (CHAT_CHECKSUM)
+static int g_compress_lz4 = 1;          // HELLO에서 LZ4 압축을 제안받으면 수락할지 여부 (CHAT_COMPRESS)
+static size_t g_compress_min = PACKET_COMPRESS_MIN; // 압축 최소 길이 (CHAT_COMPRESS_MIN)
+static unsigned long g_compress_sessions; // LZ4 압축으로 합의한 세션 수
+
+// 소켓 논블로킹 설정 함수
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0) return -1;
+    return fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+// 연결 종료 처리 함수 - 루프에서 소켓 제거 후 세션 정리, 소켓 닫기, 메모리 해제
+static void loop_close_user(EventLoop *loop, User *user) {
+    epoll_ctl(loop->epfd, EPOLL_CTL_DEL, user->sock, NULL);
+    cleanup_client_session(user); // 이미 정리된 세션이면 바로 반환
+
+    printf("[INFO] Closing connection for user %s (sock=%d, loop=%d).\n", user->id, user->sock, loop->index);
+    fflush(stdout);
+
+    user_flush_output(user); // 큐에 남은 패킷 전송 시도
+    close(user->sock);
+    user->sock = -1;
+    destroy_client_session(user);
+    __sync_fetch_and_sub(&loop->conn_count, 1);
+}
+
+// DB 작업이 포함되어 오래 걸릴 수 있는 패킷인지 확인 (작업 풀로 넘길 대상)
+static int loop_packet_blocks(uint8_t type) {
+    switch (type) {
+        case PACKET_TYPE_ID_CHANGE:
+        case PACKET_TYPE_CREATE_ROOM:
+        case PACKET_TYPE_JOIN_ROOM:             // 대화방 메시지 기록 로드
+        case PACKET_TYPE_LEAVE_ROOM:
+        case PACKET_TYPE_KICK_USER:
+        case PACKET_TYPE_CHANGE_ROOM_NAME:
+        case PACKET_TYPE_CHANGE_ROOM_MANAGER:
+        case PACKET_TYPE_DELETE_ACCOUNT:
+        case PACKET_TYPE_DELETE_MESSAGE:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// 작업 풀로 넘긴 패킷 - 디코더 버퍼는 다음 recv()에서 재사용되므로 데이터를 복사
+typedef struct {
+    User *user;                         // 패킷을 보낸 사용자 (스트랜드가 끝날 때까지 해제되지 않음)
+    FrameHeader hdr;                    // 패킷 헤더 (호스트 바이트 순서)
+    unsigned char data[];               // 패킷 데이터 (data_len + 1 바이트, NUL 종료용 여유)
+} LoopPacketJob;
+
+// 작업 스레드에서 패킷 처리 - 세션이 닫히는 중이면 건너뜀
+static void loop_packet_job(void *arg) {
+    LoopPacketJob *job = (LoopPacketJob *)arg;
+    User *user = job->user;
+    if (!user->closing) {
+        int status = client_handle_packet(user, &job->hdr, job->hdr.data_len > 0 ? job->data : NULL);
+        if (status == CLIENT_CLOSED && !user->closing) {
+            cleanup_client_session(user); // 소켓 종료만 통지, 해제는 소유 루프가 담당
+        }
+    }
+    free(job);
+}
+
+// 패킷을 사용자 스트랜드로 넘기는 함수 - 실패 시 -1 반환 (호출자가 직접 처리)
+static int loop_offload_packet(User *user, const FrameHeader *hdr, const unsigned char *data) {
+    LoopPacketJob *job = malloc(sizeof(*job) + hdr->data_len + 1);
+    if (!job) {
+        perror("malloc for packet job failed");
+        return -1;
+    }
+    job->user = user;
+    job->hdr = *hdr;
+    if (data) memcpy(job->data, data, hdr->data_len);
+    job->data[hdr->data_len] = '\0';
+    if (work_pool_submit(&user->strand, loop_packet_job, job) < 0) {
+        free(job);
+        return -1;
+    }
+    return 0;
+}
+
+// 수신 패킷 속도 제한 확인 함수 - 초과 시 제한이 시작될 때 한 번만 안내 (안내 자체가 폭주하지 않도록)
+static int loop_rate_allow(User *user, uint8_t type) {
+    int ret = rate_limiter_allow(&user->rate, type);
+    if (ret > 0) {
+        user->rate.throttled = 0;
+        return 1;
+    }
+    if (!user->rate.throttled) {
+        user->rate.throttled = 1;
+        __atomic_fetch_add(&g_rate_stats.episodes, 1, __ATOMIC_RELAXED);
+        printf("[INFO] Rate limit exceeded by %s (sock=%d, %s budget).\n",
+               user->id[0] ? user->id : "-", user->sock, ret < 0 ? "ip" : "user");
+        fflush(stdout);
+        char error_msg[] = " Rate limit exceeded. Messages are being dropped, please slow down.\n";
+        send_error(user, error_msg);
+    }
+    return 0;
+}
+
+// ============ 체크섬 협상 ============
+// 체크섬 설정 함수 - CHAT_CHECKSUM=xor이면 수신 확인만 하고 응답은 계속 XOR 체크섬
+void checksum_configure(void) {
+    const char *mode = getenv("CHAT_CHECKSUM");
+    if (mode && strcmp(mode, "xor") == 0) g_checksum_crc32c = 0;
+    else if (mode && strcmp(mode, "crc32c") != 0) printf("[WARN] Unknown CHAT_CHECKSUM '%s', using crc32c.\n", mode);
+    printf("[INFO] Checksum replies: %s (crc32c via %s)\n", g_checksum_crc32c ? "crc32c when offered" : "xor only", crc32c_impl());
+    fflush(stdout);
+}
+
+// 체크섬 설정과 카운터 출력 함수 (서버 명령 checksum_stats)
+void checksum_print_stats(void) {
+    printf("Checksum replies: %s, crc32c via %s\n", g_checksum_crc32c ? "crc32c when offered" : "xor only", crc32c_impl());
+    printf("  mismatched: %lu xor, %lu crc32c frames dropped\n",
+           __atomic_load_n(&g_checksum_stats.mismatched_xor, __ATOMIC_RELAXED),
+           __atomic_load_n(&g_checksum_stats.mismatched_crc32c, __ATOMIC_RELAXED));
+    printf("  sessions  : %lu negotiated via HELLO, %lu switched to crc32c, %lu closed after %d mismatches\n",
+           __atomic_load_n(&g_checksum_stats.hello_sessions, __ATOMIC_RELAXED),
+           __atomic_load_n(&g_checksum_stats.crc32c_sessions, __ATOMIC_RELAXED),
+           __atomic_load_n(&g_checksum_stats.closed_sessions, __ATOMIC_RELAXED), CHECKSUM_MAX_ERRORS);
+    fflush(stdout);
+}
+
+// 압축 설정 함수 - CHAT_COMPRESS=off이면 압축을 합의하지 않음, CHAT_COMPRESS_MIN으로 압축 최소 길이 조정
+void compress_configure(void) {
+    const char *mode = getenv("CHAT_COMPRESS");
+    if (mode && strcmp(mode, "off") == 0) g_compress_lz4 = 0;
+    else if (mode && strcmp(mode, "lz4") != 0) printf("[WARN] Unknown CHAT_COMPRESS '%s', using lz4.\n", mode);
+    const char *min = getenv("CHAT_COMPRESS_MIN");
+    if (min && atoi(min) >= 0) g_compress_min = (size_t)atoi(min);
+    packet_set_compress_min(g_compress_min);
+    printf("[INFO] Compression: %s (min %zu bytes, dictionary %zu bytes)\n",
+           g_compress_lz4 ? "lz4 when negotiated" : "off", g_compress_min, lz4_dict_size());
+    fflush(stdout);
+}
+
+// 압축 설정과 카운터 출력 함수 (서버 명령 compress_stats)
+void compress_print_stats(void) {
+    unsigned long bytes_in = __atomic_load_n(&g_compress_stats.bytes_in, __ATOMIC_RELAXED);
+    unsigned long bytes_out = __atomic_load_n(&g_compress_stats.bytes_out, __ATOMIC_RELAXED);
+    printf("Compression: %s (min %zu bytes, dictionary %zu bytes)\n",
+           g_compress_lz4 ? "lz4 when negotiated" : "off", g_compress_min, lz4_dict_size());
+    printf("  sessions  : %lu negotiated lz4\n", __atomic_load_n(&g_compress_sessions, __ATOMIC_RELAXED));
+    printf("  frames    : %lu compressed, %lu sent uncompressed (no gain)\n",
+           __atomic_load_n(&g_compress_stats.frames, __ATOMIC_RELAXED),
+           __atomic_load_n(&g_compress_stats.skipped, __ATOMIC_RELAXED));
+    printf("  bytes     : %lu -> %lu (%.1f%%)\n", bytes_in, bytes_out, bytes_in ? 100.0 * bytes_out / bytes_in : 0.0);
+    fflush(stdout);
+}
+
+// 체크섬이 틀린 프레임 처리 함수 - 프레임은 버리고 집계, 불일치가 계속되면 -1 반환 (연결 종료)
+static int loop_checksum_mismatch(User *user, const FrameHeader *hdr) {
+    int crc = (hdr->flags & PACKET_FLAG_CRC32C) != 0;
+    __atomic_fetch_add(crc ? &g_checksum_stats.mismatched_crc32c : &g_checksum_stats.mismatched_xor, 1, __ATOMIC_RELAXED);
+    if (user->checksum_errors++ == 0) {
+        printf("[INFO] %s checksum mismatch from %s (sock=%d, type=%d), frame dropped.\n",
+               crc ? "CRC32C" : "XOR", user->id[0] ? user->id : "-", user->sock, hdr->type);
+        fflush(stdout);
+    }
+    if (user->checksum_errors < CHECKSUM_MAX_ERRORS) return 0;
+    __atomic_fetch_add(&g_checksum_stats.closed_sessions, 1, __ATOMIC_RELAXED);
+    printf("[INFO] Closing %s (sock=%d): too many checksum mismatches.\n", user->id[0] ? user->id : "-", user->sock);
+    fflush(stdout);
+    return -1;
+}
+
+// 수신 프레임으로 세션 코덱 갱신 함수 - CRC32C 프레임을 보낸 클라이언트에는 이후 CRC32C 프레임으로 응답
+// HELLO로 협상한 세션은 합의 결과를 그대로 유지
+static void loop_negotiate_codec(User *user, const FrameHeader *hdr) {
+    if (user->negotiated) return;
+    if (hdr->version > user->proto_version) {
+        // v2 프레임을 보낸 클라이언트에는 큰 응답을 조각으로, 대화 기록을 묶어서 전송
+        user->proto_version = hdr->version;
+        __atomic_fetch_or(&user->features, HELLO_FEATURE_BATCH, __ATOMIC_RELAXED);
+    }
+    if ((hdr->flags & PACKET_FLAG_CRC32C) && g_checksum_crc32c &&
+        !(__atomic_load_n(&user->codec, __ATOMIC_RELAXED) & PACKET_FLAG_CRC32C)) {
+        __atomic_fetch_or(&user->codec, PACKET_FLAG_CRC32C, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&g_checksum_stats.crc32c_sessions, 1, __ATOMIC_RELAXED);
+    }
+}
+
+// 연결 협상 패킷 처리 함수 - SET_ID 전 한 번만 허용
+// 합의 결과는 이전 방식(v1 프레임)으로 HELLO_ACK에 담아 보낸 뒤 세션에 적용 (이후 응답부터 새 코덱)
+static void loop_handle_hello(User *user, const FrameHeader *hdr, const unsigned char *data) {
+    HelloInfo offer, agreed;
+    if (user->id[0] != '\0' || user->negotiated) {
+        char error_msg[] = " HELLO is only allowed once, before SET_ID.\n";
+        send_error(user, error_msg);
+        return;
+    }
+    if (hello_decode(data, hdr->data_len, &offer) < 0) {
+        char error_msg[] = " Malformed HELLO packet.\n";
+        send_error(user, error_msg);
+        return;
+    }
+
+    HelloInfo local = {
+        .version = PACKET_VERSION_MAX,
+        .checksums = HELLO_CHECKSUM_XOR | (g_checksum_crc32c ? HELLO_CHECKSUM_CRC32C : 0),
+        .compression = g_compress_lz4 ? HELLO_COMPRESS_LZ4 : 0,
+        .features = HELLO_FEATURE_BATCH | HELLO_FEATURE_PING,
+        .max_message = PACKET_MAX_MESSAGE,
+    };
+    hello_negotiate(&offer, &local, &agreed);
+
+    unsigned char payload[HELLO_PAYLOAD_LEN];
+    hello_encode(&agreed, payload);
+    user_send_packet(user, RES_MAGIC, PACKET_TYPE_HELLO_ACK, payload, sizeof(payload));
+
+    user->negotiated = 1;
+    user->proto_version = agreed.version;
+    __atomic_store_n(&user->features, agreed.features, __ATOMIC_RELAXED); // 세션 타이머(메인 스레드)가 하트비트 비트를 읽음
+    user->max_message = agreed.max_message;
+    uint8_t codec = hello_codec(&agreed);
+    __atomic_store_n(&user->codec, codec, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&g_checksum_stats.hello_sessions, 1, __ATOMIC_RELAXED);
+    if (codec & PACKET_FLAG_CRC32C) __atomic_fetch_add(&g_checksum_stats.crc32c_sessions, 1, __ATOMIC_RELAXED);
+    if (codec & PACKET_FLAG_LZ4) __atomic_fetch_add(&g_compress_sessions, 1, __ATOMIC_RELAXED);
+}
+
+// 수신 데이터를 디코더에 넣고 완성된 패킷을 모두 처리하는 함수 (모든 I/O 모드 공용) - 세션 종료 시 CLIENT_CLOSED 반환
+// buf는 데이터를 NUL 종료하기 위해 제자리에서 수정됨
+int event_loop_feed(User *user, unsigned char *buf, size_t len) {
+    int status = CLIENT_CONTINUE;
+    Frame frame;
+    int ret;
+
+    __atomic_store_n(&user->last_active, timer_now(), __ATOMIC_RELAXED); // 유휴 타이머 기준 갱신 (재설정 없이 만료 시 확인)
+    frame_decoder_feed(&user->decoder, buf, len);
+    while ((ret = frame_decoder_next(&user->decoder, &frame)) > 0) {
+        // 데이터가 없는 패킷은 기존과 같이 NULL로 전달
+        unsigned char *data = frame.hdr.data_len > 0 ? frame.data : NULL;
+        if (!frame.checksum_ok) {
+            if (loop_checksum_mismatch(user, &frame.hdr) < 0) return CLIENT_CLOSED;
+            continue; // 깨진 프레임은 헤더도 믿을 수 없으므로 협상/처리 없이 버림
+        }
+        loop_negotiate_codec(user, &frame.hdr);
+
+        if (frame.hdr.type == PACKET_TYPE_PONG) {
+            // 하트비트 응답은 수신 시각 갱신만으로 충분 (ID 설정 전후 모두)
+            // PONG을 한 번이라도 보낸 세션은 HELLO 없이도 하트비트/유휴 종료 대상으로 전환
+            if (!(__atomic_load_n(&user->features, __ATOMIC_RELAXED) & HELLO_FEATURE_PING)) {
+                __atomic_fetch_or(&user->features, HELLO_FEATURE_PING, __ATOMIC_RELAXED);
+            }
+            continue;
+        } else if (!loop_rate_allow(user, frame.hdr.type)) {
+            continue; // 예산 초과 패킷은 DB 저장/브로드캐스트/작업 풀 전에 버림
+        } else if (frame.hdr.type == PACKET_TYPE_HELLO) {
+            loop_handle_hello(user, &frame.hdr, data); // 연결 협상 (ID 설정 전에만 허용)
+        } else if (user->id[0] == '\0') {
+            // ID 설정 전에는 SET_ID 패킷만 처리
+            status = client_handle_id_packet(user, &frame.hdr, data);
+            if (status == CLIENT_RETRY_ID) {
+                send_id_prompt(user); // 다시 입력 요청
+                status = CLIENT_CONTINUE;
+            }
+        } else if (g_work_pool_count > 0 &&
+                   (loop_packet_blocks(frame.hdr.type) || work_pool_strand_busy(&user->strand)) &&
+                   loop_offload_packet(user, &frame.hdr, data) == 0) {
+            // DB 명령은 작업 풀에서 실행, 앞선 작업이 남아있으면 순서 유지를 위해 이후 패킷도 같은 스트랜드로
+            status = CLIENT_CONTINUE;
+        } else {
+            status = client_handle_packet(user, &frame.hdr, data);
+        }
+
+        if (status == CLIENT_CLOSED || user->closing) return CLIENT_CLOSED;
+    }
+    if (ret < 0) return CLIENT_CLOSED; // 디코더 메모리 부족
+    return status;
+}
+
+// 읽기 가능 이벤트 처리 함수 - 소켓이 빌 때까지 읽고 완성된 패킷 처리
+static void loop_handle_readable(EventLoop *loop, User *user) {
+    while (1) {
+        ssize_t n = recv(user->sock, loop->read_buf, LOOP_READ_BUFFER_SIZE, 0);
+        if (n > 0) {
+            if (event_loop_feed(user, loop->read_buf, (size_t)n) == CLIENT_CLOSED) {
+                loop_close_user(loop, user);
+                return;
+            }
+            if (n < LOOP_READ_BUFFER_SIZE) return; // 소켓 수신 버퍼를 모두 비움
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue; // 인터럽트된 경우 재시도
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return; // 더 읽을 데이터 없음
+
+        // 연결 종료 또는 에러 발생
+        loop_close_user(loop, user);
+        return;
+    }
+}
+
+// 사용자 소켓을 지정한 루프에 등록하는 함수 - 성공 시 0, 실패 시 -1 반환
+static int loop_register_user(EventLoop *loop, User *user) {
+    if (set_nonblocking(user->sock) < 0) {
+        perror("fcntl O_NONBLOCK");
+        return -1;
+    }
+    user->loop = loop;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.ptr = user;
+    if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, user->sock, &ev) < 0) {
+        perror("epoll_ctl (event loop add)");
+        user->loop = NULL;
+        return -1;
+    }
+    __sync_fetch_and_add(&loop->conn_count, 1);
+
+    send_id_prompt(user); // ID 입력 요청 (송신 큐를 거치므로 응답 패킷보다 먼저 도착)
+
+    printf("[INFO] sock=%d assigned to event loop %d.\n", user->sock, loop->index);
+    fflush(stdout);
+    return 0;
+}
+
+// 루프 전용 리스너의 대기 연결 수락 함수 - 받은 연결은 다른 루프로 넘기지 않고 이 루프가 담당
+static void loop_handle_accept(EventLoop *loop) {
+    for (int i = 0; i < LOOP_ACCEPT_BATCH; i++) {
+        int ns = accept(loop->listen_fd, NULL, NULL); // 논블로킹 설정은 루프 등록 시 수행
+        if (ns < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) perror("accept (event loop)");
+            return; // 대기 연결 없음 (남은 연결은 레벨 트리거로 다시 알림)
+        }
+        loop->accepted++;
+
+        User *user = create_client_session(ns);
+        if (!user) continue; // 접속 거부 또는 할당 실패 (소켓은 이미 닫힘)
+
+        if (loop_register_user(loop, user) < 0) {
+            destroy_client_session(user);
+            close(ns);
+        }
+    }
+}
+
+// 이벤트 루프 스레드 함수
+static void *event_loop_thread(void *args) {
+    EventLoop *loop = (EventLoop *)args;
+    struct epoll_event events[LOOP_MAX_EVENTS];
+
+    while (1) {
+        int n = epoll_wait(loop->epfd, events, LOOP_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait (event loop)");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            if (events[i].data.ptr == loop) {
+                loop_handle_accept(loop); // 루프 전용 리스너
+                continue;
+            }
+            User *user = (User *)events[i].data.ptr;
+            if (events[i].events & EPOLLOUT) {
+                user_handle_writable(user); // 송신 큐 비우기 (읽기 처리에서 해제될 수 있으므로 먼저 처리)
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                loop_handle_readable(loop, user);
+            }
+        }
+    }
+    return NULL;
+}
+
+// 이벤트 루프 생성 및 스레드 시작 함수 - 성공 시 0, 실패 시 -1 반환
+int event_loop_init(int loop_count) {
+    if (loop_count <= 0) {
+        long cores = sysconf(_SC_NPROCESSORS_ONLN); // CPU 코어 수
+        loop_count = cores > 0 ? (int)cores : 1;
+    }
+    if (loop_count > MAX_EVENT_LOOPS) loop_count = MAX_EVENT_LOOPS;
+
+    g_loops = calloc((size_t)loop_count, sizeof(EventLoop));
+    if (!g_loops) {
+        perror("calloc for event loops failed");
+        return -1;
+    }
+
+    for (int i = 0; i < loop_count; i++) {
+        EventLoop *loop = &g_loops[i];
+        loop->index = i;
+        loop->listen_fd = -1;
+        loop->epfd = epoll_create1(EPOLL_CLOEXEC);
+        loop->read_buf = malloc(LOOP_READ_BUFFER_SIZE);
+        if (loop->epfd < 0 || !loop->read_buf) {
+            perror("event loop init failed");
+            return -1;
+        }
+        if (pthread_create(&loop->thread, NULL, event_loop_thread, loop) != 0) {
+            perror("pthread_create (event loop)");
+            return -1;
+        }
+        pthread_detach(loop->thread); // 리소스 자동 회수
+        g_loop_count++;
+    }
+    return 0;
+}
+
+// 접속한 사용자를 이벤트 루프에 등록하는 함수 - 성공 시 0, 실패 시 -1 반환
+int event_loop_add_user(User *user) {
+    if (g_loop_count <= 0 || !user) return -1;
+
+    EventLoop *loop = &g_loops[g_next_loop++ % (unsigned int)g_loop_count];
+    return loop_register_user(loop, user);
+}
+
+// 루프마다 SO_REUSEPORT 리스너를 만들어 루프 epoll에 등록하는 함수 - 성공 시 0, 실패 시 -1 반환
+// first_sock(SO_REUSEPORT로 미리 바인딩된 서버 소켓)은 0번 루프가 넘겨받고, 나머지 루프는 새로 생성
+int event_loop_listen(int first_sock) {
+    for (int i = 0; i < g_loop_count; i++) {
+        EventLoop *loop = &g_loops[i];
+        int sock = i == 0 ? first_sock : open_listen_socket(1);
+        if (sock < 0) return -1;
+        if (set_nonblocking(sock) < 0) {
+            perror("fcntl O_NONBLOCK (listener)");
+            return -1;
+        }
+        loop->listen_fd = sock;
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.ptr = loop; // 사용자 포인터와 구분 (리스너 이벤트는 루프 자신을 가리킴)
+        if (epoll_ctl(loop->epfd, EPOLL_CTL_ADD, sock, &ev) < 0) {
+            perror("epoll_ctl (event loop listener)");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// 사용자 소켓의 EPOLLOUT 감시 설정/해제 함수 (송신 큐 뮤텍스 보유 상태에서 호출) - 실패 시 -1 반환
+int event_loop_watch_writable(User *user, int enable) {
+    EventLoop *loop = user->loop;
+    if (!loop) return -1;
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP | (enable ? EPOLLOUT : 0);
+    ev.data.ptr = user;
+    return epoll_ctl(loop->epfd, EPOLL_CTL_MOD, user->sock, &ev);
+}
@@ -0,0 +1,50 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <pthread.h>
+#include "chat_server.h"
+
+// ================== 이벤트 루프 설정 ===================
+#define LOOP_MAX_EVENTS         256     // epoll_wait 한 번에 처리할 최대 이벤트 수
+#define LOOP_READ_BUFFER_SIZE   FRAME_READ_BUFFER_SIZE // 루프별 recv() 버퍼 크기
+#define MAX_EVENT_LOOPS         64      // 최대 이벤트 루프 수
+#define LOOP_ACCEPT_BATCH       64      // 리스너 이벤트 한 번에 accept할 최대 연결 수 (기존 연결 처리가 밀리지 않도록)
+#define CHECKSUM_MAX_ERRORS     8       // 세션별 체크섬 불일치 허용 횟수 (넘으면 스트림이 깨진 것으로 보고 연결 종료)
+
+// 수신 체크섬 누적 카운터 (서버 명령 checksum_stats로 출력)
+typedef struct {
+    unsigned long mismatched_xor;       // XOR 체크섬이 틀려 버린 프레임 수
+    unsigned long mismatched_crc32c;    // CRC32C가 틀려 버린 프레임 수
+    unsigned long crc32c_sessions;      // CRC32C 응답으로 전환한 세션 수
+    unsigned long hello_sessions;       // HELLO로 협상한 세션 수
+    unsigned long closed_sessions;      // 불일치가 계속되어 종료한 세션 수
+} ChecksumStats;
+
+// 이벤트 루프 구조체 - 스레드 1개가 epoll 인스턴스 1개와 소속 소켓들을 전담
+typedef struct EventLoop {
+    int index;                          // 루프 번호
+    int epfd;                           // 루프 전용 epoll 디스크립터
+    pthread_t thread;                   // 루프 스레드
+    unsigned char *read_buf;            // recv() 공용 버퍼 (루프 스레드 전용)
+    unsigned long conn_count;           // 현재 담당 중인 연결 수
+    int listen_fd;                      // 루프 전용 SO_REUSEPORT 리스너 (없으면 -1)
+    unsigned long accepted;             // 루프 리스너로 받은 연결 수
+} EventLoop;
+
+// ================== 전역 변수 ===================
+extern EventLoop *g_loops;              // 이벤트 루프 배열
+extern int g_loop_count;                // 이벤트 루프 수
+extern ChecksumStats g_checksum_stats;  // 수신 체크섬 누적 카운터
+
+// ================== 함수 프로토타입 ===================
+int event_loop_init(int loop_count);    // 루프 생성 및 스레드 시작 (loop_count <= 0 이면 CPU 코어 수)
+int event_loop_add_user(User *user);    // 접속한 사용자를 루프에 분배 및 등록
+int event_loop_listen(int first_sock);  // 루프마다 SO_REUSEPORT 리스너 등록 (first_sock은 0번 루프가 사용)
+int event_loop_feed(User *user, unsigned char *buf, size_t len); // 수신 데이터 디코딩 및 패킷 처리 (buf는 제자리 수정됨)
+int event_loop_watch_writable(User *user, int enable); // 송신 큐가 남았을 때 EPOLLOUT 감시 설정/해제
+void checksum_configure(void);          // 환경 변수로 응답 체크섬 협상 허용 여부 설정
+void checksum_print_stats(void);        // 체크섬 설정과 카운터 출력 (서버 명령 checksum_stats)
+void compress_configure(void);          // 환경 변수로 응답 압축 협상 허용 여부와 최소 길이 설정
+void compress_print_stats(void);        // 압축 설정과 카운터 출력 (서버 명령 compress_stats)
+
+#endif // EVENT_LOOP_H
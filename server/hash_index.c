@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "chat_server.h"
+#include "hash_index.h"
+
+#define HASH_INDEX_TOMBSTONE ((void *)1) // 삭제된 슬롯 표시 (탐사가 끊기지 않도록 유지)
+
+// 정수 키 해시 (곱셈 해시)
+static size_t hash_int(uint32_t key) {
+    return (size_t)(key * 2654435761u);
+}
+
+// 문자열 키 해시 (FNV-1a)
+static size_t hash_str(const char *key) {
+    uint32_t h = 2166136261u;
+    for (const unsigned char *p = (const unsigned char *)key; *p; p++) {
+        h ^= *p;
+        h *= 16777619u;
+    }
+    return (size_t)h;
+}
+
+// 항목의 현재 키에 대한 해시 계산
+static size_t hash_item(const HashIndex *idx, const void *item) {
+    switch (idx->key) {
+        case HASH_KEY_USER_SOCK: return hash_int((uint32_t)((const User *)item)->sock);
+        case HASH_KEY_USER_ID:   return hash_str(((const User *)item)->id);
+        case HASH_KEY_ROOM_NO:   return hash_int(((const Room *)item)->no);
+        case HASH_KEY_ROOM_NAME: return hash_str(((const Room *)item)->room_name);
+    }
+    return 0;
+}
+
+// 인덱스 초기화 함수
+void hash_index_init(HashIndex *idx, HashKey key) {
+    memset(idx, 0, sizeof(*idx));
+    idx->key = key;
+}
+
+// 슬롯 배열 해제 함수
+void hash_index_free(HashIndex *idx) {
+    free(idx->slots);
+    idx->slots = NULL;
+    idx->cap = idx->count = idx->used = 0;
+}
+
+// 슬롯 배열 재할당 함수 - 삭제 표시를 정리하며 모든 항목을 다시 배치
+static int hash_index_resize(HashIndex *idx, size_t new_cap) {
+    void **slots = calloc(new_cap, sizeof(*slots));
+    if (!slots) {
+        perror("calloc for hash index failed");
+        return -1;
+    }
+    for (size_t i = 0; i < idx->cap; i++) {
+        void *item = idx->slots[i];
+        if (!item || item == HASH_INDEX_TOMBSTONE) continue;
+        size_t pos = hash_item(idx, item) & (new_cap - 1);
+        while (slots[pos]) pos = (pos + 1) & (new_cap - 1);
+        slots[pos] = item;
+    }
+    free(idx->slots);
+    idx->slots = slots;
+    idx->cap = new_cap;
+    idx->used = idx->count;
+    return 0;
+}
+
+// 항목 등록 함수 - 성공 시 0, 메모리 부족 시 -1 반환
+int hash_index_insert(HashIndex *idx, void *item) {
+    if ((idx->used + 1) * 100 > idx->cap * HASH_INDEX_MAX_LOAD) {
+        // 항목이 많으면 두 배로, 삭제 표시가 많으면 같은 크기로 재배치
+        size_t new_cap = idx->cap ? idx->cap : HASH_INDEX_INIT_CAP;
+        if ((idx->count + 1) * 100 > new_cap * (HASH_INDEX_MAX_LOAD / 2)) new_cap *= 2;
+        if (hash_index_resize(idx, new_cap) < 0) return -1;
+    }
+
+    size_t mask = idx->cap - 1;
+    size_t pos = hash_item(idx, item) & mask;
+    while (idx->slots[pos] && idx->slots[pos] != HASH_INDEX_TOMBSTONE) pos = (pos + 1) & mask;
+    if (!idx->slots[pos]) idx->used++; // 삭제 표시 재사용 시에는 증가하지 않음
+    idx->slots[pos] = item;
+    idx->count++;
+    return 0;
+}
+
+// 항목 제거 함수 - 현재 키로 탐사하고, 찾지 못하면(키가 바뀐 경우) 전체 슬롯에서 검색
+void hash_index_remove(HashIndex *idx, void *item) {
+    if (idx->count == 0) return;
+
+    size_t mask = idx->cap - 1;
+    size_t pos = hash_item(idx, item) & mask;
+    for (size_t n = 0; n < idx->cap && idx->slots[pos]; n++, pos = (pos + 1) & mask) {
+        if (idx->slots[pos] == item) {
+            idx->slots[pos] = HASH_INDEX_TOMBSTONE;
+            idx->count--;
+            return;
+        }
+    }
+    for (size_t i = 0; i < idx->cap; i++) {
+        if (idx->slots[i] == item) {
+            idx->slots[i] = HASH_INDEX_TOMBSTONE;
+            idx->count--;
+            return;
+        }
+    }
+}
+
+// 키 비교 함수 - 항목이 찾는 키와 일치하면 1
+typedef int (*HashMatch)(const void *item, const void *key);
+
+static int match_user_sock(const void *item, const void *key) { return ((const User *)item)->sock == *(const int *)key; }
+static int match_user_id(const void *item, const void *key) { return strcmp(((const User *)item)->id, (const char *)key) == 0; }
+static int match_room_no(const void *item, const void *key) { return ((const Room *)item)->no == *(const unsigned int *)key; }
+static int match_room_name(const void *item, const void *key) { return strcmp(((const Room *)item)->room_name, (const char *)key) == 0; }
+
+// 키 해시 위치부터 빈 슬롯을 만날 때까지 탐사하며 일치하는 항목 검색
+static void *hash_index_lookup(const HashIndex *idx, size_t hash, HashMatch match, const void *key) {
+    if (idx->count == 0) return NULL;
+
+    size_t mask = idx->cap - 1;
+    size_t pos = hash & mask;
+    for (size_t n = 0; n < idx->cap && idx->slots[pos]; n++, pos = (pos + 1) & mask) {
+        void *item = idx->slots[pos];
+        if (item != HASH_INDEX_TOMBSTONE && match(item, key)) return item;
+    }
+    return NULL;
+}
+
+// 소켓 번호로 사용자 검색 함수
+User *hash_index_find_user_sock(const HashIndex *idx, int sock) {
+    return hash_index_lookup(idx, hash_int((uint32_t)sock), match_user_sock, &sock);
+}
+
+// 사용자 ID로 사용자 검색 함수
+User *hash_index_find_user_id(const HashIndex *idx, const char *id) {
+    if (!id) return NULL;
+    return hash_index_lookup(idx, hash_str(id), match_user_id, id);
+}
+
+// 대화방 번호로 대화방 검색 함수
+Room *hash_index_find_room_no(const HashIndex *idx, unsigned int no) {
+    return hash_index_lookup(idx, hash_int(no), match_room_no, &no);
+}
+
+// 대화방 이름으로 대화방 검색 함수
+Room *hash_index_find_room_name(const HashIndex *idx, const char *name) {
+    if (!name) return NULL;
+    return hash_index_lookup(idx, hash_str(name), match_room_name, name);
+}
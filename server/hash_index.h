@@ -0,0 +1,40 @@
+#ifndef HASH_INDEX_H
+#define HASH_INDEX_H
+
+#include <stddef.h>
+
+// ================== 해시 인덱스 설정 ===================
+#define HASH_INDEX_INIT_CAP     256     // 초기 슬롯 수 (2의 거듭제곱)
+#define HASH_INDEX_MAX_LOAD     70      // 사용 중 + 삭제 표시 슬롯 비율(%)이 이 값을 넘으면 확장
+
+struct User;
+struct Room;
+
+// 인덱스 키 종류 - 항목의 필드를 키로 사용 (항목 자체를 슬롯에 저장)
+typedef enum {
+    HASH_KEY_USER_SOCK,                 // 사용자 소켓 번호 (User.sock)
+    HASH_KEY_USER_ID,                   // 사용자 ID (User.id)
+    HASH_KEY_ROOM_NO,                   // 대화방 번호 (Room.no)
+    HASH_KEY_ROOM_NAME                  // 대화방 이름 (Room.room_name)
+} HashKey;
+
+// 오픈 어드레싱(선형 탐사) 해시 인덱스 - 해당 목록의 뮤텍스 보유 상태에서만 접근
+typedef struct {
+    HashKey key;                        // 키 종류
+    void **slots;                       // 슬롯 배열 (NULL: 빈 슬롯, HASH_INDEX_TOMBSTONE: 삭제 표시)
+    size_t cap;                         // 슬롯 수 (2의 거듭제곱)
+    size_t count;                       // 등록된 항목 수
+    size_t used;                        // 사용 중 + 삭제 표시 슬롯 수
+} HashIndex;
+
+// ================== 함수 프로토타입 ===================
+void hash_index_init(HashIndex *idx, HashKey key);  // 인덱스 초기화 (슬롯은 첫 추가 시 할당)
+void hash_index_free(HashIndex *idx);               // 슬롯 배열 해제
+int hash_index_insert(HashIndex *idx, void *item);  // 항목 등록 (현재 키 기준) - 실패 시 -1
+void hash_index_remove(HashIndex *idx, void *item); // 항목 제거 (등록 이후 키가 바뀌었어도 제거)
+struct User *hash_index_find_user_sock(const HashIndex *idx, int sock);       // 소켓 번호로 사용자 검색
+struct User *hash_index_find_user_id(const HashIndex *idx, const char *id);   // 사용자 ID로 사용자 검색
+struct Room *hash_index_find_room_no(const HashIndex *idx, unsigned int no);  // 대화방 번호로 검색
+struct Room *hash_index_find_room_name(const HashIndex *idx, const char *name); // 대화방 이름으로 검색
+
+#endif // HASH_INDEX_H
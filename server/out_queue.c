@@ -0,0 +1,495 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <stddef.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/epoll.h>
+#include "chat_server.h"
+#include "event_loop.h"
+#include "uring_loop.h"
+#include "out_queue.h"
+
+// ================== 전역 변수 초기화 ===================
+size_t g_outq_limit = OUT_QUEUE_DEFAULT_LIMIT; // 사용자별 송신 큐 한도 (바이트)
+SlowPolicy g_slow_policy = SLOW_POLICY_COLLAPSE; // 느린 수신자 처리 정책
+unsigned long g_slow_max_age_ms = SLOW_DEFAULT_MAX_AGE_MS; // disconnect 정책의 시간 한도 (ms)
+SlowStats g_slow_stats;                         // 정책별 누적 카운터
+
+static const char *slow_policy_names[] = { "drop", "collapse", "disconnect" };
+
+// 환경 변수로 송신 큐 한도 및 느린 수신자 정책 설정
+// (CHAT_OUTQ_LIMIT=<바이트>, CHAT_SLOW_POLICY=drop|collapse|disconnect, CHAT_SLOW_MAX_AGE_MS=<ms>)
+void out_queue_configure(void) {
+    const char *limit = getenv("CHAT_OUTQ_LIMIT");
+    if (limit && atol(limit) > 0) {
+        g_outq_limit = (size_t)atol(limit);
+    }
+
+    const char *policy = getenv("CHAT_SLOW_POLICY");
+    if (policy) {
+        int found = 0;
+        for (int i = 0; i < (int)(sizeof(slow_policy_names) / sizeof(slow_policy_names[0])); i++) {
+            if (strcmp(policy, slow_policy_names[i]) == 0) {
+                g_slow_policy = (SlowPolicy)i;
+                found = 1;
+            }
+        }
+        if (!found) {
+            fprintf(stderr, "[ERROR] Unknown CHAT_SLOW_POLICY '%s', using %s.\n", policy, slow_policy_names[g_slow_policy]);
+        }
+    }
+
+    const char *max_age = getenv("CHAT_SLOW_MAX_AGE_MS");
+    if (max_age && atol(max_age) > 0) {
+        g_slow_max_age_ms = (unsigned long)atol(max_age);
+    }
+
+    printf("[INFO] Outbound queue limit: %zu bytes per user, slow consumer policy: %s\n",
+           g_outq_limit, slow_policy_names[g_slow_policy]);
+    fflush(stdout);
+}
+
+// 정책별 카운터 출력 함수 (서버 명령 outq_stats)
+void out_queue_print_stats(void) {
+    printf("Slow consumer policy: %s (limit %zu bytes, hard limit %zu bytes, max age %lu ms)\n",
+           slow_policy_names[g_slow_policy], g_outq_limit, g_outq_limit * OUT_QUEUE_HARD_FACTOR, g_slow_max_age_ms);
+    printf("  drop       : %lu messages dropped\n", g_slow_stats.dropped_msgs);
+    printf("  collapse   : %lu messages collapsed into %lu notices\n", g_slow_stats.collapsed_msgs, g_slow_stats.skip_notices);
+    printf("  shed bytes : %lu\n", g_slow_stats.dropped_bytes);
+    printf("  disconnect : %lu by bytes, %lu by age\n", g_slow_stats.disconnect_bytes, g_slow_stats.disconnect_age);
+    printf("  hard limit : %lu disconnects (control responses over hard limit)\n", g_slow_stats.disconnect_hard);
+    fflush(stdout);
+}
+
+// 단조 시계 기준 현재 시각 (ms)
+static uint64_t out_queue_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// ================== 큐 기본 조작 ===================
+// 송신 큐 초기화 함수
+void out_queue_init(OutQueue *q) {
+    memset(q, 0, sizeof(*q));
+    pthread_mutex_init(&q->mutex, NULL);
+}
+
+// 맨 앞 패킷 제거 함수 (전송 완료 시)
+void out_queue_pop_unlocked(OutQueue *q) {
+    OutChunk *chunk = q->head;
+    if (!chunk) return;
+    q->head = chunk->next;
+    if (!q->head) q->tail = NULL;
+    q->bytes -= chunk->len - chunk->off;
+    if (chunk == q->skip_chunk) {
+        q->skip_chunk = NULL; // 안내가 전송되었으므로 이후 폐기분은 새 안내로 집계
+        q->skipped = 0;
+    }
+    shared_frame_release(chunk->frame);
+    free(chunk);
+}
+
+// 커널에 제출되지 않은 패킷 모두 폐기 함수 (전송 실패 시)
+void out_queue_clear_unlocked(OutQueue *q) {
+    OutChunk **pp = &q->head;
+    for (int i = 0; i < q->pinned && *pp; i++) pp = &(*pp)->next; // 제출된 패킷은 완료될 때까지 유지
+
+    OutChunk *chunk = *pp;
+    *pp = NULL;
+    while (chunk) {
+        OutChunk *next = chunk->next;
+        q->bytes -= chunk->len - chunk->off;
+        if (chunk == q->skip_chunk) {
+            q->skip_chunk = NULL;
+            q->skipped = 0;
+        }
+        shared_frame_release(chunk->frame);
+        free(chunk);
+        chunk = next;
+    }
+    // 꼬리 포인터 재설정
+    q->tail = NULL;
+    for (OutChunk *c = q->head; c; c = c->next) q->tail = c;
+}
+
+// 송신 큐 해제 함수 (세션 종료 시)
+void out_queue_destroy(OutQueue *q) {
+    q->pinned = 0;
+    out_queue_clear_unlocked(q);
+    pthread_mutex_destroy(&q->mutex);
+}
+
+// 논블로킹 전송으로 큐를 최대한 비우는 함수 - 0: 모두 전송, 1: 남음(EAGAIN), -1: 에러
+// 대기 중인 패킷을 최대 OUT_QUEUE_IOV_BATCH개씩 iovec로 묶어 sendmsg() 한 번으로 전송
+static int out_queue_flush_unlocked(OutQueue *q, int sock) {
+    struct iovec iov[OUT_QUEUE_IOV_BATCH];
+
+    while (q->head) {
+        int iovcnt = 0;
+        size_t batch_bytes = 0;
+        for (OutChunk *c = q->head; c && iovcnt < OUT_QUEUE_IOV_BATCH; c = c->next) {
+            iov[iovcnt].iov_base = (void *)(c->buf + c->off);
+            iov[iovcnt].iov_len = c->len - c->off;
+            batch_bytes += iov[iovcnt].iov_len;
+            iovcnt++;
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (size_t)iovcnt;
+        ssize_t n = sendmsg(sock, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue; // 인터럽트된 경우 재시도
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return 1; // 송신 버퍼 가득 참
+            return -1;
+        }
+
+        // 전송된 바이트만큼 앞쪽 패킷부터 완료 처리
+        size_t sent = (size_t)n;
+        while (sent > 0 && q->head) {
+            OutChunk *chunk = q->head;
+            size_t remain = chunk->len - chunk->off;
+            size_t step = sent < remain ? sent : remain;
+            chunk->off += step;
+            q->bytes -= step;
+            sent -= step;
+            if (chunk->off == chunk->len) out_queue_pop_unlocked(q);
+        }
+        if ((size_t)n < batch_bytes) return 1; // 부분 전송 - 송신 버퍼 가득 참
+    }
+    return 0;
+}
+
+// ================== 쓰기 가능 이벤트 등록 ===================
+// 스레드 모드: 메인 epoll에 EPOLLOUT 1회성 등록 (이벤트 시 메인 스레드가 큐를 비움)
+static int out_queue_arm_main(int sock) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLOUT | EPOLLONESHOT;
+    ev.data.fd = sock;
+    if (epoll_ctl(g_epfd, EPOLL_CTL_MOD, sock, &ev) == 0) return 0;
+    if (errno != ENOENT) return -1;
+    return epoll_ctl(g_epfd, EPOLL_CTL_ADD, sock, &ev);
+}
+
+// 남은 데이터가 있을 때 쓰기 가능 이벤트 등록 함수 (큐 뮤텍스 보유 상태에서 호출)
+static void out_queue_arm_unlocked(User *user) {
+    int ret = -1;
+    if (g_io_mode == IO_MODE_EPOLL) {
+        ret = event_loop_watch_writable(user, 1);
+    } else if (g_io_mode == IO_MODE_THREAD) {
+        ret = out_queue_arm_main(user->sock);
+    }
+    if (ret < 0) {
+        perror("epoll_ctl (outbound queue)");
+        return;
+    }
+    user->outq.write_armed = 1;
+}
+
+// 전송 에러 처리 - 남은 패킷을 버리고 소켓을 닫아 소유 스레드(루프)가 세션을 정리하도록 유도
+static void out_queue_fail_unlocked(User *user) {
+    out_queue_clear_unlocked(&user->outq);
+    if (user->sock >= 0) shutdown(user->sock, SHUT_RDWR);
+}
+
+// ================== 느린 수신자 정책 ===================
+// 커널에 제출된(io_uring) 패킷인지 확인 - 제출된 버퍼는 수정/해제 불가
+static int out_queue_is_pinned(OutQueue *q, OutChunk *chunk) {
+    int i = 0;
+    for (OutChunk *c = q->head; c && i < q->pinned; c = c->next, i++) {
+        if (c == chunk) return 1;
+    }
+    return 0;
+}
+
+// "N messages skipped" 안내 패킷 생성 함수
+static OutChunk *out_queue_make_skip_chunk(unsigned long skipped) {
+    char notice[96];
+    int n = snprintf(notice, sizeof(notice), " [Server] %lu messages skipped (connection too slow).\n", skipped);
+
+    OutChunk *chunk = malloc(sizeof(*chunk));
+    if (!chunk) return NULL;
+    chunk->frame = shared_frame_encode(RES_MAGIC, PACKET_TYPE_SERVER_NOTICE, notice, (uint16_t)n);
+    if (!chunk->frame) {
+        free(chunk);
+        return NULL;
+    }
+    chunk->buf = chunk->frame->data;
+    chunk->len = chunk->frame->len;
+    chunk->next = NULL;
+    chunk->off = 0;
+    chunk->type = PACKET_TYPE_SERVER_NOTICE; // 제어 패킷 취급 (폐기 대상 아님)
+    chunk->queued_ms = out_queue_now_ms();
+    return chunk;
+}
+
+// collapse 정책: 폐기한 메시지 수를 안내 패킷에 반영하는 함수
+// 아직 전송 전인 안내가 있으면 숫자만 갱신하고, 없으면 *pp 위치(폐기된 메시지 자리)에 새 안내 삽입 - 삽입 시 1 반환
+static int out_queue_note_skipped_unlocked(OutQueue *q, OutChunk **pp, OutChunk *prev) {
+    __sync_fetch_and_add(&g_slow_stats.collapsed_msgs, 1);
+
+    OutChunk *skip = q->skip_chunk;
+    if (skip && skip->off == 0 && !out_queue_is_pinned(q, skip)) {
+        OutChunk *fresh = out_queue_make_skip_chunk(q->skipped + 1);
+        if (!fresh) return 0;
+        // 기존 안내 버퍼를 새 내용으로 교체 (위치 유지)
+        q->bytes = q->bytes - skip->len + fresh->len;
+        shared_frame_release(skip->frame);
+        skip->frame = fresh->frame;
+        skip->buf = fresh->buf;
+        skip->len = fresh->len;
+        free(fresh);
+        q->skipped++;
+        return 0;
+    }
+
+    OutChunk *chunk = out_queue_make_skip_chunk(1);
+    if (!chunk) return 0;
+    chunk->next = *pp;
+    *pp = chunk;
+    if (q->tail == prev) q->tail = chunk;
+    q->bytes += chunk->len;
+    q->skip_chunk = chunk;
+    q->skipped = 1;
+    __sync_fetch_and_add(&g_slow_stats.skip_notices, 1);
+    return 1;
+}
+
+// drop/collapse 정책: 새 패킷이 들어갈 공간이 생길 때까지 오래된 채팅 메시지부터 폐기
+// (전송 중이거나 커널에 제출된 패킷, 제어 응답은 건드리지 않음)
+static void out_queue_shed_chat_unlocked(OutQueue *q, size_t incoming) {
+    OutChunk **pp = &q->head;
+    OutChunk *prev = NULL;
+    int index = 0;
+
+    while (*pp && q->bytes + incoming > g_outq_limit) {
+        OutChunk *chunk = *pp;
+        if (index < q->pinned || chunk->off > 0 || chunk->type != PACKET_TYPE_MESSAGE) {
+            prev = chunk;
+            pp = &chunk->next;
+            index++;
+            continue;
+        }
+
+        // 채팅 메시지 폐기
+        *pp = chunk->next;
+        if (q->tail == chunk) q->tail = prev;
+        q->bytes -= chunk->len;
+        q->dropped++;
+        __sync_fetch_and_add(&g_slow_stats.dropped_bytes, chunk->len);
+        shared_frame_release(chunk->frame);
+        free(chunk);
+
+        if (g_slow_policy == SLOW_POLICY_COLLAPSE) {
+            if (out_queue_note_skipped_unlocked(q, pp, prev)) {
+                // 삽입된 안내 다음부터 계속 검사
+                prev = *pp;
+                pp = &(*pp)->next;
+                index++;
+            }
+        } else {
+            __sync_fetch_and_add(&g_slow_stats.dropped_msgs, 1);
+        }
+    }
+}
+
+// 느린 수신자로 판정된 연결 종료 - 큐를 비우고 소켓을 닫아 소유 스레드(루프)가 세션을 정리
+static void out_queue_disconnect_unlocked(User *user, unsigned long *counter, const char *reason) {
+    user->outq.closed = 1;
+    __sync_fetch_and_add(counter, 1);
+    printf("[INFO] Slow consumer %s (sock=%d) disconnected: %s (%zu bytes queued).\n",
+           user->id, user->sock, reason, user->outq.bytes);
+    fflush(stdout);
+    out_queue_fail_unlocked(user);
+}
+
+// 새 패킷을 큐에 넣기 전에 정책 적용 - 0: 추가, -1: 새 패킷 폐기, -2: 연결 종료
+static int out_queue_admit_unlocked(User *user, OutChunk *chunk) {
+    OutQueue *q = &user->outq;
+
+    if (g_slow_policy == SLOW_POLICY_DISCONNECT) {
+        if (q->head && chunk->queued_ms - q->head->queued_ms > g_slow_max_age_ms) {
+            out_queue_disconnect_unlocked(user, &g_slow_stats.disconnect_age, "queue age limit");
+            return -2;
+        }
+        if (q->bytes + chunk->len > g_outq_limit) {
+            out_queue_disconnect_unlocked(user, &g_slow_stats.disconnect_bytes, "queue byte limit");
+            return -2;
+        }
+        return 0;
+    }
+
+    if (q->bytes + chunk->len <= g_outq_limit) return 0;
+    out_queue_shed_chat_unlocked(q, chunk->len);
+    if (q->bytes + chunk->len <= g_outq_limit) return 0;
+
+    if (chunk->type == PACKET_TYPE_MESSAGE) {
+        // 더 폐기할 채팅이 없으면 새 채팅 메시지를 폐기
+        q->dropped++;
+        __sync_fetch_and_add(&g_slow_stats.dropped_bytes, chunk->len);
+        if (g_slow_policy == SLOW_POLICY_COLLAPSE) {
+            out_queue_note_skipped_unlocked(q, q->tail ? &q->tail->next : &q->head, q->tail);
+        } else {
+            __sync_fetch_and_add(&g_slow_stats.dropped_msgs, 1);
+        }
+        return -1;
+    }
+
+    // 제어 응답은 폐기하지 않되, 하드 한도를 넘으면 연결 종료 (메모리 보호)
+    if (q->bytes + chunk->len > g_outq_limit * OUT_QUEUE_HARD_FACTOR) {
+        out_queue_disconnect_unlocked(user, &g_slow_stats.disconnect_hard, "control responses over hard limit");
+        return -2;
+    }
+    return 0;
+}
+
+// ================== 사용자 송신 함수 ===================
+// 공유 프레임을 사용자 송신 큐에 추가하는 함수 - 큐가 참조를 하나 더 보유 (복사 없음), 큐 한도 초과 시 -1 반환
+ssize_t user_queue_frame(User *user, SharedFrame *frame) {
+    if (!user || user->sock < 0 || !frame) return -1;
+    OutQueue *q = &user->outq;
+
+    // 세션 코덱(체크섬 방식)이 다르면 같은 패킷의 해당 코덱 인코딩 사용 (브로드캐스트 프레임당 코덱별 한 번만 인코딩)
+    SharedFrame *variant = NULL;
+    uint8_t codec = __atomic_load_n(&user->codec, __ATOMIC_RELAXED);
+    if (frame->codec != codec) variant = shared_frame_variant(frame, codec);
+    if (variant) frame = variant;
+    size_t len = frame->len;
+
+    OutChunk *chunk = malloc(sizeof(*chunk));
+    if (!chunk) {
+        perror("malloc for OutChunk failed");
+        shared_frame_release(variant);
+        return -1;
+    }
+    chunk->next = NULL;
+    chunk->frame = variant ? variant : shared_frame_ref(frame);
+    chunk->buf = frame->data;
+    chunk->len = len;
+    chunk->off = 0;
+    chunk->type = len > offsetof(PacketHeader, type) ? frame->data[offsetof(PacketHeader, type)] : 0;
+    chunk->queued_ms = out_queue_now_ms();
+
+    pthread_mutex_lock(&q->mutex);
+    // 느린 수신자 정책 적용 (다른 사용자 전송은 막지 않음)
+    if (q->closed || out_queue_admit_unlocked(user, chunk) < 0) {
+        pthread_mutex_unlock(&q->mutex);
+        shared_frame_release(chunk->frame);
+        free(chunk);
+        return -1;
+    }
+    if (q->tail) q->tail->next = chunk;
+    else q->head = chunk;
+    q->tail = chunk;
+    q->bytes += len;
+
+    if (g_io_mode == IO_MODE_URING) {
+        // io_uring 모드: 링 스레드가 연결별 send 체인으로 일괄 제출
+        pthread_mutex_unlock(&q->mutex);
+        uring_loop_notify(user);
+        return (ssize_t)len;
+    }
+
+    if (!q->write_armed) {
+        // 쓰기 대기 중이 아니면 바로 논블로킹 전송 시도
+        int ret = out_queue_flush_unlocked(q, user->sock);
+        if (ret < 0) {
+            out_queue_fail_unlocked(user);
+        } else if (ret > 0) {
+            if (g_io_mode == IO_MODE_THREAD && user->id[0] == '\0') {
+                // 스레드 모드의 ID 설정 전 세션: 사용자 목록에 없어 메인 스레드가 찾을 수 없으므로
+                // 세션 스레드가 직접 비움 (ID 입력 안내뿐이므로 자신의 소켓만 기다림, 대기 중에는 뮤텍스 해제)
+                while (ret > 0 && !q->write_armed) {
+                    pthread_mutex_unlock(&q->mutex);
+                    struct pollfd pfd = { .fd = user->sock, .events = POLLOUT, .revents = 0 };
+                    poll(&pfd, 1, -1);
+                    pthread_mutex_lock(&q->mutex);
+                    ret = out_queue_flush_unlocked(q, user->sock);
+                }
+                if (ret < 0) out_queue_fail_unlocked(user);
+            } else {
+                out_queue_arm_unlocked(user);
+            }
+        }
+    }
+    pthread_mutex_unlock(&q->mutex);
+    return (ssize_t)len;
+}
+
+// 패킷을 인코딩하여 사용자 송신 큐에 추가하는 함수 - send_packet 대신 사용 (블로킹 없음)
+ssize_t user_send_packet(User *user, uint16_t magic, uint8_t type, const void *data, uint16_t data_len) {
+    if (!user || user->sock < 0) return -1;
+
+    // 코덱을 협상한 세션은 처음부터 해당 코덱의 v2 프레임으로 인코딩
+    uint8_t codec = __atomic_load_n(&user->codec, __ATOMIC_RELAXED);
+    SharedFrame *frame = codec ? shared_frame_encode_v2(magic, type, data, data_len, codec)
+                               : shared_frame_encode(magic, type, data, data_len);
+    if (!frame) return -1;
+    ssize_t ret = user_queue_frame(user, frame);
+    shared_frame_release(frame);
+    return ret;
+}
+
+// 길이 제한 없는 응답을 송신 큐에 추가하는 함수 - v2 세션은 조각 프레임으로 전체 전송
+// v1 세션은 v1 프레임 하나에 담을 수 있는 만큼만 전송 (호출자가 v1용으로 미리 줄여서 넘기는 것이 원칙)
+ssize_t user_send_payload(User *user, uint16_t magic, uint8_t type, const void *data, size_t data_len) {
+    if (!user || user->sock < 0) return -1;
+    if (user->proto_version < 2) {
+        return user_send_packet(user, magic, type, data, (uint16_t)(data_len > UINT16_MAX ? UINT16_MAX : data_len));
+    }
+
+    if (data_len > user->max_message) data_len = user->max_message; // 합의한 한도를 넘는 부분은 보내지 않음
+    SharedFrame *frame = shared_frame_encode_v2(magic, type, data, data_len, __atomic_load_n(&user->codec, __ATOMIC_RELAXED));
+    if (!frame) return -1;
+    ssize_t ret = user_queue_frame(user, frame);
+    shared_frame_release(frame);
+    return ret;
+}
+
+// 남은 송신 큐를 논블로킹으로 비우는 함수 (세션 종료 직전 등) - 0: 모두 전송, 1: 남음, -1: 에러
+int user_flush_output(User *user) {
+    if (!user || user->sock < 0) return -1;
+    pthread_mutex_lock(&user->outq.mutex);
+    int ret = out_queue_flush_unlocked(&user->outq, user->sock);
+    pthread_mutex_unlock(&user->outq.mutex);
+    return ret;
+}
+
+// ================== 쓰기 가능 이벤트 처리 ===================
+// 이벤트 루프 모드: EPOLLOUT 발생 시 큐를 비우고, 모두 전송되면 EPOLLOUT 감시 해제
+void user_handle_writable(User *user) {
+    OutQueue *q = &user->outq;
+    pthread_mutex_lock(&q->mutex);
+    int ret = out_queue_flush_unlocked(q, user->sock);
+    if (ret <= 0 && q->write_armed) {
+        event_loop_watch_writable(user, 0);
+        q->write_armed = 0;
+    }
+    if (ret < 0) out_queue_fail_unlocked(user);
+    pthread_mutex_unlock(&q->mutex);
+}
+
+// 스레드 모드: 메인 epoll에서 EPOLLOUT 발생 시 해당 소켓의 사용자 큐 비우기
+void user_handle_writable_fd(int fd) {
+    pthread_mutex_lock(&g_users_mutex); // 목록에서 제거된(정리 중인) 사용자는 건드리지 않음
+    User *user = find_user_by_sock_unlocked(fd);
+    if (user) {
+        OutQueue *q = &user->outq;
+        pthread_mutex_lock(&q->mutex);
+        q->write_armed = 0;
+        int ret = out_queue_flush_unlocked(q, user->sock);
+        if (ret > 0) out_queue_arm_unlocked(user); // 1회성 등록이므로 다시 등록
+        else if (ret < 0) out_queue_fail_unlocked(user);
+        pthread_mutex_unlock(&q->mutex);
+    }
+    pthread_mutex_unlock(&g_users_mutex);
+}
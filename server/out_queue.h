@@ -0,0 +1,82 @@
+#ifndef OUT_QUEUE_H
+#define OUT_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include "../common/chat_protocol.h"
+
+// ================== 송신 큐 설정 ===================
+#define OUT_QUEUE_DEFAULT_LIMIT (1024 * 1024)   // 사용자별 송신 큐 최대 바이트 (CHAT_OUTQ_LIMIT로 변경)
+#define OUT_QUEUE_HARD_FACTOR   2               // 제어 패킷은 한도의 이 배수까지 허용 후 연결 종료
+#define SLOW_DEFAULT_MAX_AGE_MS 30000           // disconnect 정책의 기본 시간 한도 (CHAT_SLOW_MAX_AGE_MS로 변경)
+#define OUT_QUEUE_IOV_BATCH     64              // sendmsg() 한 번에 모아 보낼 최대 패킷 수
+
+// 느린 수신자 처리 정책 (CHAT_SLOW_POLICY)
+typedef enum {
+    SLOW_POLICY_DROP,                   // 오래된 채팅 메시지부터 폐기 (제어 응답은 유지)
+    SLOW_POLICY_COLLAPSE,               // 폐기한 채팅 메시지를 "N messages skipped" 안내 하나로 대체
+    SLOW_POLICY_DISCONNECT              // 바이트/시간 한도 초과 시 연결 종료
+} SlowPolicy;
+
+// 정책별 누적 카운터 (서버 명령 outq_stats로 출력)
+typedef struct {
+    unsigned long dropped_msgs;         // drop: 폐기한 채팅 메시지 수
+    unsigned long dropped_bytes;        // drop/collapse: 폐기한 바이트 수
+    unsigned long collapsed_msgs;       // collapse: 안내로 대체된 채팅 메시지 수
+    unsigned long skip_notices;         // collapse: 생성된 안내 패킷 수
+    unsigned long disconnect_bytes;     // disconnect: 바이트 한도 초과로 종료한 연결 수
+    unsigned long disconnect_age;       // disconnect: 시간 한도 초과로 종료한 연결 수
+    unsigned long disconnect_hard;      // 공통: 제어 패킷이 하드 한도를 넘어 종료한 연결 수
+} SlowStats;
+
+// 송신 대기 패킷 (인코딩 완료된 패킷 1개)
+typedef struct OutChunk {
+    struct OutChunk *next;              // 다음 패킷
+    SharedFrame *frame;                 // 공유 프레임 (참조 1개 보유, 브로드캐스트 수신자끼리 공유)
+    const unsigned char *buf;           // 패킷 버퍼 (frame->data)
+    size_t len;                         // 패킷 길이
+    size_t off;                         // 전송 완료된 바이트 수
+    uint8_t type;                       // 패킷 타입 (PACKET_TYPE_MESSAGE만 폐기 대상)
+    uint64_t queued_ms;                 // 큐에 들어간 시각 (단조 시계, ms)
+} OutChunk;
+
+// 사용자별 송신 큐 - 브로드캐스트는 큐에 넣고 바로 반환, 소켓이 쓰기 가능해지면 비움
+typedef struct OutQueue {
+    pthread_mutex_t mutex;              // 큐 보호용 뮤텍스 (다른 뮤텍스보다 나중에 잠금)
+    OutChunk *head;                     // 가장 오래된 패킷
+    OutChunk *tail;                     // 가장 최근 패킷
+    size_t bytes;                       // 아직 전송되지 않은 바이트 수
+    int write_armed;                    // 쓰기 가능 이벤트(EPOLLOUT) 대기 중 여부
+    int pinned;                         // 커널에 제출되어 해제할 수 없는 앞쪽 패킷 수 (io_uring)
+    int closed;                         // 느린 수신자로 판정되어 종료 중 (이후 패킷 무시)
+    OutChunk *skip_chunk;               // collapse 정책의 "N messages skipped" 안내 패킷
+    unsigned long skipped;              // skip_chunk에 반영된 메시지 수
+    unsigned long dropped;              // 폐기(또는 요약)된 메시지 수
+} OutQueue;
+
+struct User;
+
+// ================== 전역 변수 ===================
+extern size_t g_outq_limit;             // 사용자별 송신 큐 한도 (바이트)
+extern SlowPolicy g_slow_policy;        // 느린 수신자 처리 정책
+extern unsigned long g_slow_max_age_ms; // disconnect 정책의 시간 한도 (ms)
+extern SlowStats g_slow_stats;          // 정책별 누적 카운터
+
+// ================== 함수 프로토타입 ===================
+void out_queue_configure(void);                 // 환경 변수로 송신 큐 한도 및 느린 수신자 정책 설정
+void out_queue_print_stats(void);               // 정책별 카운터 출력 (서버 명령 outq_stats)
+void out_queue_init(OutQueue *q);               // 송신 큐 초기화
+void out_queue_clear_unlocked(OutQueue *q);     // 고정되지 않은 패킷 모두 폐기
+void out_queue_destroy(OutQueue *q);            // 남은 패킷 해제 및 뮤텍스 정리
+void out_queue_pop_unlocked(OutQueue *q);       // 전송이 끝난 맨 앞 패킷 제거
+
+ssize_t user_send_packet(struct User *user, uint16_t magic, uint8_t type, const void *data, uint16_t data_len); // 패킷 인코딩 후 송신 큐에 추가
+ssize_t user_send_payload(struct User *user, uint16_t magic, uint8_t type, const void *data, size_t data_len); // 큰 응답 전송 (v2 세션은 조각 프레임, v1 세션은 v1 최대 길이까지)
+ssize_t user_queue_frame(struct User *user, SharedFrame *frame); // 공유 프레임을 송신 큐에 추가 (참조 추가, 호출자 참조는 유지)
+int user_flush_output(struct User *user);       // 논블로킹으로 송신 큐 비우기 - 0: 모두 전송, 1: 남음, -1: 에러
+void user_handle_writable(struct User *user);   // 쓰기 가능 이벤트 처리 (이벤트 루프 모드)
+void user_handle_writable_fd(int fd);           // 쓰기 가능 이벤트 처리 (스레드 모드, 메인 epoll)
+
+#endif // OUT_QUEUE_H
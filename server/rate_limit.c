@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "../common/chat_protocol.h"
+#include "rate_limit.h"
+
+// ================== 전역 변수 ===================
+RateStats g_rate_stats;                 // 속도 제한 누적 카운터
+
+static double g_user_rate[RATE_CLASS_COUNT] = { RATE_USER_CHAT_DEFAULT, RATE_USER_CONTROL_DEFAULT }; // 사용자별 초당 허용량
+static double g_ip_rate[RATE_CLASS_COUNT] = { RATE_IP_CHAT_DEFAULT, RATE_IP_CONTROL_DEFAULT };       // IP별 초당 허용량
+static const char *rate_class_names[RATE_CLASS_COUNT] = { "chat", "control" };
+static int g_conn_per_ip = CONN_PER_IP_DEFAULT;           // IP별 최대 동시 연결 수
+static int g_handshake_per_ip = HANDSHAKE_PER_IP_DEFAULT; // IP별 ID 설정 전 연결 수
+
+static RateIpEntry *g_ip_table[RATE_IP_TABLE_SIZE]; // 접속 IP 해시 테이블 (체이닝)
+static pthread_mutex_t g_ip_table_mutex = PTHREAD_MUTEX_INITIALIZER; // 테이블 보호용 뮤텍스 (접속/해제 시에만 잠금)
+
+// 환경 변수 하나를 초당 허용량으로 읽기 (음수는 무시)
+static void rate_read_env(const char *name, double *rate) {
+    const char *value = getenv(name);
+    if (value && atof(value) >= 0) *rate = atof(value);
+}
+
+// 환경 변수로 버킷 예산과 접속 제한 설정
+// (CHAT_RATE_CHAT, CHAT_RATE_CONTROL, CHAT_RATE_IP_CHAT, CHAT_RATE_IP_CONTROL = 초당 패킷 수, 0이면 비활성)
+// (CHAT_MAX_CONN_PER_IP, CHAT_MAX_HANDSHAKE_PER_IP = IP별 연결 수, 0이면 제한 없음)
+void rate_limit_configure(void) {
+    rate_read_env("CHAT_RATE_CHAT", &g_user_rate[RATE_CLASS_CHAT]);
+    rate_read_env("CHAT_RATE_CONTROL", &g_user_rate[RATE_CLASS_CONTROL]);
+    rate_read_env("CHAT_RATE_IP_CHAT", &g_ip_rate[RATE_CLASS_CHAT]);
+    rate_read_env("CHAT_RATE_IP_CONTROL", &g_ip_rate[RATE_CLASS_CONTROL]);
+
+    const char *conns = getenv("CHAT_MAX_CONN_PER_IP");
+    if (conns && atoi(conns) >= 0) g_conn_per_ip = atoi(conns);
+    const char *handshakes = getenv("CHAT_MAX_HANDSHAKE_PER_IP");
+    if (handshakes && atoi(handshakes) >= 0) g_handshake_per_ip = atoi(handshakes);
+
+    printf("[INFO] Rate limits (packets/s, burst x%d): user chat %g, control %g / ip chat %g, control %g\n",
+           RATE_BURST_FACTOR, g_user_rate[RATE_CLASS_CHAT], g_user_rate[RATE_CLASS_CONTROL],
+           g_ip_rate[RATE_CLASS_CHAT], g_ip_rate[RATE_CLASS_CONTROL]);
+    printf("[INFO] Connection caps per IP: %d connections, %d handshakes (0 = unlimited)\n",
+           g_conn_per_ip, g_handshake_per_ip);
+    fflush(stdout);
+}
+
+// 설정과 카운터 출력 함수 (서버 명령 rate_stats)
+void rate_limit_print_stats(void) {
+    printf("Rate limits (packets/s, burst x%d, 0 = off)\n", RATE_BURST_FACTOR);
+    for (int c = 0; c < RATE_CLASS_COUNT; c++) {
+        printf("  %-8s: user %g, ip %g / dropped %lu by user, %lu by ip\n", rate_class_names[c],
+               g_user_rate[c], g_ip_rate[c],
+               __atomic_load_n(&g_rate_stats.dropped_user[c], __ATOMIC_RELAXED),
+               __atomic_load_n(&g_rate_stats.dropped_ip[c], __ATOMIC_RELAXED));
+    }
+    printf("  throttled: %lu times\n", __atomic_load_n(&g_rate_stats.episodes, __ATOMIC_RELAXED));
+    printf("Connection caps per IP: %d connections, %d handshakes (0 = unlimited)\n", g_conn_per_ip, g_handshake_per_ip);
+    printf("  rejected : %lu over connection cap, %lu over handshake cap\n",
+           __atomic_load_n(&g_rate_stats.rejected_conns, __ATOMIC_RELAXED),
+           __atomic_load_n(&g_rate_stats.rejected_handshakes, __ATOMIC_RELAXED));
+    fflush(stdout);
+}
+
+// 패킷 타입의 예산 종류 - 채팅 메시지만 채팅 예산, 나머지는 제어 예산
+RateClass rate_limit_class(uint8_t type) {
+    return type == PACKET_TYPE_MESSAGE ? RATE_CLASS_CHAT : RATE_CLASS_CONTROL;
+}
+
+// ================== 토큰 버킷 ===================
+// 단조 시계 기준 현재 시각 (ns)
+static uint64_t rate_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// 버킷을 가득 채운 상태로 초기화
+static void bucket_init(TokenBucket *b, double rate, uint64_t now) {
+    b->tokens = rate * RATE_BURST_FACTOR;
+    b->stamp_ns = now;
+}
+
+// 경과 시간만큼 채운 뒤 토큰 1개 소비 - 1: 소비함, 0: 부족
+static int bucket_take(TokenBucket *b, double rate, uint64_t now) {
+    double cap = rate * RATE_BURST_FACTOR;
+    if (now > b->stamp_ns) {
+        b->tokens += (double)(now - b->stamp_ns) * rate / 1e9;
+        if (b->tokens > cap) b->tokens = cap;
+        b->stamp_ns = now;
+    }
+    if (b->tokens < 1.0) return 0;
+    b->tokens -= 1.0;
+    return 1;
+}
+
+// ================== 접속 IP 테이블 ===================
+// 주소 해시 (FNV-1a)
+static unsigned int ip_hash(int family, const unsigned char *addr) {
+    unsigned int h = 2166136261u ^ (unsigned int)family;
+    for (int i = 0; i < 16; i++) {
+        h = (h ^ addr[i]) * 16777619u;
+    }
+    return h & (RATE_IP_TABLE_SIZE - 1);
+}
+
+// 소켓의 상대 IP 주소 추출 - IP가 없는 소켓(유닉스 도메인)이나 실패 시 -1
+static int ip_peer_addr(int sock, int *family, unsigned char addr[16]) {
+    struct sockaddr_storage ss;
+    socklen_t len = sizeof(ss);
+    if (getpeername(sock, (struct sockaddr *)&ss, &len) < 0) return -1;
+
+    memset(addr, 0, 16);
+    if (ss.ss_family == AF_INET) {
+        memcpy(addr, &((struct sockaddr_in *)&ss)->sin_addr, 4);
+    } else if (ss.ss_family == AF_INET6) {
+        memcpy(addr, &((struct sockaddr_in6 *)&ss)->sin6_addr, 16);
+    } else {
+        return -1;
+    }
+    *family = ss.ss_family;
+    return 0;
+}
+
+// 접속 허용 확인 함수 - 세션 할당/스레드 생성/루프 등록 전에 호출
+// 허용 시 IP 항목을 참조하고 (없으면 생성) 연결 수/ID 설정 전 연결 수를 늘린 뒤 ip에 저장
+// IP가 없는 소켓이나 항목 할당 실패 시에는 제한 없이 허용하고 ip에 NULL 저장
+AdmitResult rate_ip_admit(int sock, RateIpEntry **ip) {
+    int family;
+    unsigned char addr[16];
+    *ip = NULL;
+    if (ip_peer_addr(sock, &family, addr) < 0) return ADMIT_OK;
+    unsigned int h = ip_hash(family, addr);
+
+    pthread_mutex_lock(&g_ip_table_mutex);
+    RateIpEntry *e = g_ip_table[h];
+    while (e && (e->family != family || memcmp(e->addr, addr, sizeof(addr)) != 0)) {
+        e = e->next;
+    }
+    if (e && g_conn_per_ip > 0 && e->conns >= g_conn_per_ip) {
+        pthread_mutex_unlock(&g_ip_table_mutex);
+        __atomic_fetch_add(&g_rate_stats.rejected_conns, 1, __ATOMIC_RELAXED);
+        return ADMIT_IP_CONNS;
+    }
+    if (e && g_handshake_per_ip > 0 && e->handshakes >= g_handshake_per_ip) {
+        pthread_mutex_unlock(&g_ip_table_mutex);
+        __atomic_fetch_add(&g_rate_stats.rejected_handshakes, 1, __ATOMIC_RELAXED);
+        return ADMIT_IP_HANDSHAKES;
+    }
+    if (!e && (e = calloc(1, sizeof(*e))) != NULL) {
+        uint64_t now = rate_now_ns();
+        e->family = family;
+        memcpy(e->addr, addr, sizeof(addr));
+        pthread_mutex_init(&e->mutex, NULL);
+        for (int c = 0; c < RATE_CLASS_COUNT; c++) bucket_init(&e->bucket[c], g_ip_rate[c], now);
+        e->next = g_ip_table[h];
+        g_ip_table[h] = e;
+    }
+    if (e) {
+        e->conns++;
+        e->handshakes++;
+    }
+    pthread_mutex_unlock(&g_ip_table_mutex);
+    *ip = e;
+    return ADMIT_OK;
+}
+
+// 항목 참조 반환 함수 - 마지막 세션이면 테이블에서 제거 후 해제
+void rate_ip_release(RateIpEntry *e, int handshaking) {
+    if (!e) return;
+    unsigned int h = ip_hash(e->family, e->addr);
+
+    pthread_mutex_lock(&g_ip_table_mutex);
+    if (handshaking) e->handshakes--;
+    if (--e->conns > 0) {
+        pthread_mutex_unlock(&g_ip_table_mutex);
+        return;
+    }
+    RateIpEntry **pp = &g_ip_table[h];
+    while (*pp && *pp != e) pp = &(*pp)->next;
+    if (*pp) *pp = e->next;
+    pthread_mutex_unlock(&g_ip_table_mutex);
+
+    pthread_mutex_destroy(&e->mutex);
+    free(e);
+}
+
+// ================== 세션 인터페이스 ===================
+// 세션 시작 함수 - 사용자 버킷을 가득 채우고 허용 시 얻은 IP 항목 참조를 넘겨받음
+void rate_limiter_init(RateLimiter *rl, RateIpEntry *ip) {
+    uint64_t now = rate_now_ns();
+    memset(rl, 0, sizeof(*rl));
+    for (int c = 0; c < RATE_CLASS_COUNT; c++) bucket_init(&rl->bucket[c], g_user_rate[c], now);
+    rl->ip = ip;
+    rl->handshaking = ip != NULL;
+}
+
+// ID 설정 완료 함수 - 이후로는 IP별 ID 설정 전 연결 수에 포함하지 않음
+void rate_limiter_identified(RateLimiter *rl) {
+    if (!rl->handshaking) return;
+    pthread_mutex_lock(&g_ip_table_mutex);
+    rl->ip->handshakes--;
+    pthread_mutex_unlock(&g_ip_table_mutex);
+    rl->handshaking = 0;
+}
+
+// 세션 해제 함수
+void rate_limiter_release(RateLimiter *rl) {
+    rate_ip_release(rl->ip, rl->handshaking);
+    rl->ip = NULL;
+    rl->handshaking = 0;
+}
+
+// 패킷 허용 여부 확인 함수 (세션의 수신 스레드에서 호출) - DB 저장/브로드캐스트 전에 호출
+// 반환: 1 (허용), 0 (사용자 버킷 초과), -1 (IP 버킷 초과 - 같은 IP의 다른 세션과 예산 공유)
+int rate_limiter_allow(RateLimiter *rl, uint8_t type) {
+    RateClass c = rate_limit_class(type);
+    uint64_t now = rate_now_ns();
+
+    if (g_user_rate[c] > 0 && !bucket_take(&rl->bucket[c], g_user_rate[c], now)) {
+        __atomic_fetch_add(&g_rate_stats.dropped_user[c], 1, __ATOMIC_RELAXED);
+        return 0;
+    }
+    if (rl->ip && g_ip_rate[c] > 0) {
+        pthread_mutex_lock(&rl->ip->mutex);
+        int ok = bucket_take(&rl->ip->bucket[c], g_ip_rate[c], now);
+        pthread_mutex_unlock(&rl->ip->mutex);
+        if (!ok) {
+            if (g_user_rate[c] > 0) rl->bucket[c].tokens += 1.0; // 버린 패킷은 사용자 예산에서 빼지 않음
+            __atomic_fetch_add(&g_rate_stats.dropped_ip[c], 1, __ATOMIC_RELAXED);
+            return -1;
+        }
+    }
+    return 1;
+}
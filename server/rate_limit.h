@@ -0,0 +1,80 @@
+#ifndef RATE_LIMIT_H
+#define RATE_LIMIT_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+// ================== 속도 제한 설정 ===================
+// 초당 허용 패킷 수 (환경 변수로 변경, 0이면 해당 버킷 비활성) - 버킷 용량(순간 허용량)은 초당 허용량 x RATE_BURST_FACTOR
+#define RATE_USER_CHAT_DEFAULT      20      // 사용자별 채팅 패킷 (CHAT_RATE_CHAT)
+#define RATE_USER_CONTROL_DEFAULT   5       // 사용자별 제어 패킷 (CHAT_RATE_CONTROL)
+#define RATE_IP_CHAT_DEFAULT        100     // 접속 IP별 채팅 패킷 (CHAT_RATE_IP_CHAT)
+#define RATE_IP_CONTROL_DEFAULT     25      // 접속 IP별 제어 패킷 (CHAT_RATE_IP_CONTROL)
+#define RATE_BURST_FACTOR           2       // 버킷 용량 배수
+#define RATE_IP_TABLE_SIZE          1024    // IP 테이블 해시 버킷 수 (2의 거듭제곱)
+#define CONN_PER_IP_DEFAULT         32      // 접속 IP별 최대 동시 연결 수 (CHAT_MAX_CONN_PER_IP, 0이면 제한 없음)
+#define HANDSHAKE_PER_IP_DEFAULT    8       // 접속 IP별 ID 설정 전 연결 수 (CHAT_MAX_HANDSHAKE_PER_IP, 0이면 제한 없음)
+
+// 접속 허용 결과 (rate_ip_admit)
+typedef enum {
+    ADMIT_OK,                           // 허용
+    ADMIT_IP_CONNS,                     // 같은 IP의 동시 연결 수 초과
+    ADMIT_IP_HANDSHAKES                 // 같은 IP의 ID 설정 전 연결 수 초과
+} AdmitResult;
+
+// 패킷 종류별 예산 - 채팅 폭주가 명령을, 명령 폭주가 채팅을 막지 않도록 따로 계산
+typedef enum {
+    RATE_CLASS_CHAT,                    // 채팅 메시지 (DB 저장 + 대화방 전체 전송)
+    RATE_CLASS_CONTROL,                 // 그 밖의 명령 (ID 설정, 방 생성/참여, 목록 등)
+    RATE_CLASS_COUNT
+} RateClass;
+
+// 토큰 버킷 - 마지막 확인 이후 경과 시간만큼 채운 뒤 패킷마다 토큰 1개 소비
+typedef struct {
+    double tokens;                      // 남은 토큰
+    uint64_t stamp_ns;                  // 마지막으로 채운 시각 (단조 시계, ns)
+} TokenBucket;
+
+// 접속 IP별 항목 - 같은 IP의 세션이 공유 (마지막 세션이 끝나면 해제)
+typedef struct RateIpEntry {
+    struct RateIpEntry *next;           // 같은 해시 버킷의 다음 항목
+    int family;                         // 주소 종류 (AF_INET / AF_INET6)
+    unsigned char addr[16];             // 주소 (IPv4는 앞 4바이트)
+    int conns;                          // 접속 중인 세션 수 = 참조 수 (테이블 뮤텍스 보유 상태에서 변경)
+    int handshakes;                     // 그중 ID 설정 전인 세션 수 (테이블 뮤텍스 보유 상태에서 변경)
+    pthread_mutex_t mutex;              // 버킷 보호용 뮤텍스 (여러 I/O 스레드가 같은 IP의 세션을 처리)
+    TokenBucket bucket[RATE_CLASS_COUNT]; // 종류별 버킷
+} RateIpEntry;
+
+// 세션별 속도 제한 상태 - 사용자 버킷은 수신 스레드만 접근하므로 잠금 없음
+typedef struct {
+    TokenBucket bucket[RATE_CLASS_COUNT]; // 종류별 사용자 버킷
+    RateIpEntry *ip;                    // 접속 IP 항목 (유닉스 도메인 등 IP가 없으면 NULL)
+    int throttled;                      // 제한 중 여부 (제한이 시작될 때 한 번만 안내)
+    int handshaking;                    // ID 설정 전 연결로 집계 중인지 여부
+} RateLimiter;
+
+// 속도 제한 누적 카운터 (서버 명령 rate_stats로 출력)
+typedef struct {
+    unsigned long dropped_user[RATE_CLASS_COUNT]; // 사용자 버킷 초과로 버린 패킷 수
+    unsigned long dropped_ip[RATE_CLASS_COUNT];   // IP 버킷 초과로 버린 패킷 수
+    unsigned long episodes;             // 제한이 시작된 횟수 (안내 패킷 수)
+    unsigned long rejected_conns;       // 접속 시 IP별 동시 연결 수 초과로 거부한 연결 수
+    unsigned long rejected_handshakes;  // 접속 시 IP별 ID 설정 전 연결 수 초과로 거부한 연결 수
+} RateStats;
+
+// ================== 전역 변수 ===================
+extern RateStats g_rate_stats;          // 속도 제한 누적 카운터
+
+// ================== 함수 프로토타입 ===================
+void rate_limit_configure(void);        // 환경 변수로 버킷 예산 설정
+void rate_limit_print_stats(void);      // 설정과 카운터 출력 (서버 명령 rate_stats)
+RateClass rate_limit_class(uint8_t type); // 패킷 타입의 예산 종류
+AdmitResult rate_ip_admit(int sock, RateIpEntry **ip); // 접속 허용 확인 - 허용 시 IP 항목 참조를 ip에 저장 (IP가 없는 소켓은 NULL)
+void rate_ip_release(RateIpEntry *ip, int handshaking); // 세션을 만들지 않은 경우 허용 시 얻은 참조 반환
+void rate_limiter_init(RateLimiter *rl, RateIpEntry *ip); // 세션 시작 - 버킷을 가득 채우고 허용 시 얻은 IP 항목 참조를 넘겨받음
+void rate_limiter_identified(RateLimiter *rl);     // ID 설정 완료 - IP별 ID 설정 전 연결 수에서 제외
+void rate_limiter_release(RateLimiter *rl);        // 세션 해제 - IP 항목 참조 반환
+int rate_limiter_allow(RateLimiter *rl, uint8_t type); // 패킷 허용 여부 - 1: 허용, 0: 사용자 버킷 초과, -1: IP 버킷 초과
+
+#endif // RATE_LIMIT_H
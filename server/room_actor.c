@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/eventfd.h>
+#include "chat_server.h"
+#include "room_actor.h"
+
+// ================== 전역 변수 초기화 ===================
+int g_room_actor_count = 0;             // 대화방 워커 수 (0: 액터 모드 비활성)
+static RoomWorker *g_room_workers = NULL; // 대화방 워커 배열
+
+// ================== MPSC 큐 ===================
+// 큐 초기화 - 더미 노드 하나로 시작
+static void room_cmd_queue_init(RoomCmdQueue *q) {
+    q->stub.next = NULL;
+    q->head = &q->stub;
+    q->tail = &q->stub;
+}
+
+// 명령 추가 (여러 스레드에서 동시에 호출 가능, 잠금 없음)
+static void room_cmd_queue_push(RoomCmdQueue *q, RoomCmd *cmd) {
+    cmd->next = NULL;
+    RoomCmd *prev = __atomic_exchange_n(&q->head, cmd, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, cmd, __ATOMIC_RELEASE); // 이 사이에는 소비자가 끝을 볼 수 없어 잠시 기다림
+}
+
+// 명령 꺼내기 (워커 스레드 전용) - 비었거나 생산자가 연결 중이면 NULL
+static RoomCmd *room_cmd_queue_pop(RoomCmdQueue *q) {
+    RoomCmd *tail = q->tail;
+    RoomCmd *next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+    if (tail == &q->stub) {
+        if (!next) return NULL;
+        q->tail = next;
+        tail = next;
+        next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    }
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    if (tail != __atomic_load_n(&q->head, __ATOMIC_ACQUIRE)) return NULL; // 생산자가 연결하는 중
+
+    // 마지막 명령을 꺼내기 전에 더미 노드를 다시 넣어 큐가 비지 않도록 유지
+    room_cmd_queue_push(q, &q->stub);
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next) {
+        q->tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+// 큐에 처리할 명령이 남아있는지 확인 (연결 중인 명령 포함)
+static int room_cmd_queue_pending(RoomCmdQueue *q) {
+    return __atomic_load_n(&q->tail->next, __ATOMIC_ACQUIRE) != NULL || q->tail != __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+}
+
+// ================== 워커 ===================
+// 대화방 멤버에게 프레임 전송 (워커 전용 - 멤버 배열은 워커만 수정하므로 잠금 없이 순회)
+static void room_actor_fanout(Room *room, User *sender, SharedFrame *frame) {
+    for (int i = 0; i < room->member_count; i++) {
+        User *member = room->members[i];
+        if (member != sender && member->sock >= 0) {
+            user_queue_frame(member, frame);
+        }
+    }
+}
+
+// 명령 처리 함수
+static void room_actor_apply(RoomWorker *worker, RoomCmd *cmd) {
+    Room *room = cmd->room;
+    worker->processed++;
+
+    switch (cmd->type) {
+        case ROOM_CMD_JOIN:
+            // 멤버 배열 변경은 목록 조회(/users 등)와의 경합을 위해 대화방 뮤텍스 안에서 수행
+            pthread_mutex_lock(&room->mutex);
+            room_add_member_unlocked(room, cmd->user);
+            pthread_mutex_unlock(&room->mutex);
+            cmd->result = cmd->user->room == room ? 0 : -1;
+            break;
+
+        case ROOM_CMD_LEAVE:
+            pthread_mutex_lock(&room->mutex);
+            room_remove_member_unlocked(room, cmd->user);
+            pthread_mutex_unlock(&room->mutex);
+            if (cmd->frame) {
+                room->seq++;
+                room_actor_fanout(room, cmd->sender, cmd->frame);
+            }
+            cmd->result = room->member_count;
+            break;
+
+        case ROOM_CMD_FRAME:
+            room->seq++; // 워커가 순서대로 처리하므로 대화방 내 전송 순서 = 순번
+            room_actor_fanout(room, cmd->sender, cmd->frame);
+            break;
+
+        case ROOM_CMD_DESTROY:
+            // 앞서 들어온 명령은 모두 처리되었으므로 안전하게 해제
+            printf("[INFO] Room worker %d released room (ID: %u, last seq=%lu).\n", worker->index, room->no, room->seq);
+            fflush(stdout);
+            free_room(room);
+            break;
+    }
+
+    if (cmd->done) {
+        sem_post(cmd->done); // 동기 명령: 호출자가 결과를 읽고 스택의 명령을 정리
+    } else {
+        if (cmd->frame) shared_frame_release(cmd->frame);
+        free(cmd);
+    }
+}
+
+// 워커 스레드 - 큐가 빌 때까지 명령을 처리하고, 비면 eventfd로 대기
+static void *room_actor_thread(void *arg) {
+    RoomWorker *worker = (RoomWorker *)arg;
+    uint64_t val;
+
+    for (;;) {
+        RoomCmd *cmd = room_cmd_queue_pop(&worker->queue);
+        if (cmd) {
+            room_actor_apply(worker, cmd);
+            continue;
+        }
+
+        // 대기 표시 후 다시 확인 (표시 전에 들어온 명령을 놓치지 않도록)
+        __atomic_store_n(&worker->sleeping, 1, __ATOMIC_SEQ_CST);
+        if (room_cmd_queue_pending(&worker->queue)) {
+            __atomic_store_n(&worker->sleeping, 0, __ATOMIC_SEQ_CST);
+            sched_yield(); // 생산자가 연결을 마칠 때까지 양보
+            continue;
+        }
+        if (read(worker->wake_fd, &val, sizeof(val)) < 0 && errno != EINTR) {
+            perror("read (room worker eventfd)");
+        }
+        __atomic_store_n(&worker->sleeping, 0, __ATOMIC_SEQ_CST);
+    }
+    return NULL;
+}
+
+// 명령을 대화방 소유 워커에 전달 - 워커가 대기 중이면 깨움
+static void room_actor_post(Room *room, RoomCmd *cmd) {
+    RoomWorker *worker = room->owner;
+    room_cmd_queue_push(&worker->queue, cmd);
+    if (__atomic_exchange_n(&worker->sleeping, 0, __ATOMIC_SEQ_CST)) {
+        uint64_t one = 1;
+        if (write(worker->wake_fd, &one, sizeof(one)) < 0) {
+            perror("write (room worker eventfd)");
+        }
+    }
+}
+
+// 동기 명령 전달 후 완료 대기
+static int room_actor_call(Room *room, RoomCmd *cmd) {
+    sem_t done;
+    sem_init(&done, 0, 0);
+    cmd->done = &done;
+    room_actor_post(room, cmd);
+    while (sem_wait(&done) < 0 && errno == EINTR);
+    sem_destroy(&done);
+    return cmd->result;
+}
+
+// ================== 외부 인터페이스 ===================
+// 워커 생성 및 스레드 시작 함수 - 실패 시 -1 반환
+int room_actor_init(int worker_count) {
+    if (worker_count <= 0) return 0;
+    if (worker_count > MAX_ROOM_ACTORS) worker_count = MAX_ROOM_ACTORS;
+
+    g_room_workers = calloc((size_t)worker_count, sizeof(RoomWorker));
+    if (!g_room_workers) {
+        perror("calloc for room workers failed");
+        return -1;
+    }
+
+    for (int i = 0; i < worker_count; i++) {
+        RoomWorker *worker = &g_room_workers[i];
+        worker->index = i;
+        room_cmd_queue_init(&worker->queue);
+        worker->wake_fd = eventfd(0, EFD_CLOEXEC);
+        if (worker->wake_fd < 0) {
+            perror("eventfd (room worker)");
+            return -1;
+        }
+        if (pthread_create(&worker->thread, NULL, room_actor_thread, worker) != 0) {
+            perror("pthread_create (room worker)");
+            return -1;
+        }
+        pthread_detach(worker->thread); // 리소스 자동 회수
+        g_room_actor_count++;
+    }
+    return 0;
+}
+
+// 새 대화방에 소유 워커 배정 함수 (대화방 번호로 분배, 액터 모드가 아니면 NULL)
+void room_actor_attach(Room *room) {
+    room->seq = 0;
+    room->owner = g_room_actor_count > 0 ? &g_room_workers[room->no % (unsigned int)g_room_actor_count] : NULL;
+}
+
+// 멤버 추가 요청 함수 - 워커가 추가를 마칠 때까지 대기
+int room_actor_join(Room *room, User *user) {
+    RoomCmd cmd = { .type = ROOM_CMD_JOIN, .room = room, .user = user };
+    return room_actor_call(room, &cmd);
+}
+
+// 멤버 제거 요청 함수 - notice가 있으면 제거 후 남은 멤버(sender 제외)에게 전송, 남은 멤버 수 반환
+// 반환 후에는 워커가 이 사용자를 참조하지 않으므로 세션 해제 가능
+int room_actor_leave(Room *room, User *user, User *sender, SharedFrame *notice) {
+    RoomCmd cmd = { .type = ROOM_CMD_LEAVE, .room = room, .user = user, .sender = sender, .frame = notice };
+    return room_actor_call(room, &cmd);
+}
+
+// 프레임 전송 요청 함수 - 워커가 순번을 부여하고 전송 (호출자 참조는 유지)
+void room_actor_post_frame(Room *room, User *sender, SharedFrame *frame) {
+    RoomCmd *cmd = calloc(1, sizeof(*cmd));
+    if (!cmd) {
+        perror("calloc for room command failed");
+        return;
+    }
+    cmd->type = ROOM_CMD_FRAME;
+    cmd->room = room;
+    cmd->sender = sender;
+    cmd->frame = shared_frame_ref(frame);
+    room_actor_post(room, cmd);
+}
+
+// 대화방 해제 요청 함수 - 디렉터리에서 제거된 뒤 호출 (이후 새 명령이 들어오지 않음)
+void room_actor_destroy(Room *room) {
+    RoomCmd *cmd = calloc(1, sizeof(*cmd));
+    if (!cmd) {
+        // 명령을 만들 수 없으면 해제하지 않고 남겨둠 (워커가 아직 참조 중일 수 있음)
+        perror("calloc for room command failed");
+        return;
+    }
+    cmd->type = ROOM_CMD_DESTROY;
+    cmd->room = room;
+    room_actor_post(room, cmd);
+}
@@ -0,0 +1,60 @@
+#ifndef ROOM_ACTOR_H
+#define ROOM_ACTOR_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include "chat_server.h"
+
+// ================== 대화방 액터 설정 ===================
+#define MAX_ROOM_ACTORS         64      // 최대 대화방 워커 수
+
+// 워커에게 보내는 명령 종류
+typedef enum {
+    ROOM_CMD_JOIN,                      // 멤버 추가 (동기)
+    ROOM_CMD_LEAVE,                     // 멤버 제거 및 안내 전송 (동기)
+    ROOM_CMD_FRAME,                     // 순번 부여 후 멤버에게 프레임 전송 (비동기)
+    ROOM_CMD_DESTROY                    // 앞서 받은 명령을 모두 처리한 뒤 대화방 해제 (비동기)
+} RoomCmdType;
+
+// 워커 명령 - MPSC 큐에 침습적으로 연결 (동기 명령은 호출자 스택에 위치)
+typedef struct RoomCmd {
+    struct RoomCmd *next;               // 큐 내 다음 명령
+    RoomCmdType type;                   // 명령 종류
+    Room *room;                         // 대상 대화방
+    User *user;                         // JOIN/LEAVE 대상 사용자
+    User *sender;                       // 전송에서 제외할 사용자
+    SharedFrame *frame;                 // 전송할 프레임 (참조 1개 보유, NULL 가능)
+    sem_t *done;                        // 동기 명령의 완료 통지 (비동기면 NULL, 워커가 명령 해제)
+    int result;                         // 처리 결과 (JOIN: 0/-1, LEAVE: 남은 멤버 수)
+} RoomCmd;
+
+// 워커별 다중 생산자/단일 소비자 큐 (잠금 없음, 생산자는 head 교환만 수행)
+typedef struct {
+    RoomCmd *head;                      // 마지막으로 넣은 명령 (생산자끼리 원자적 교환)
+    RoomCmd *tail;                      // 다음에 꺼낼 명령 (워커 전용)
+    RoomCmd stub;                       // 빈 큐 표시용 더미 노드
+} RoomCmdQueue;
+
+// 대화방 워커 - 배정된 대화방의 멤버 변경과 전송을 혼자 처리 (대화방 번호로 배정)
+typedef struct RoomWorker {
+    int index;                          // 워커 번호
+    pthread_t thread;                   // 워커 스레드
+    int wake_fd;                        // 깨우기용 eventfd
+    int sleeping;                       // 큐가 비어 대기 중인지 여부 (생산자가 깨울지 결정)
+    RoomCmdQueue queue;                 // 명령 큐
+    unsigned long processed;            // 처리한 명령 수
+} RoomWorker;
+
+// ================== 전역 변수 ===================
+extern int g_room_actor_count;          // 대화방 워커 수 (0: 액터 모드 비활성)
+
+// ================== 함수 프로토타입 ===================
+int room_actor_init(int worker_count);  // 워커 생성 및 스레드 시작 - 실패 시 -1 반환
+void room_actor_attach(Room *room);     // 새 대화방에 소유 워커 배정 (디렉터리 등록 전 호출)
+int room_actor_join(Room *room, User *user); // 멤버 추가 요청 후 완료 대기 - 0: 성공, -1: 실패
+int room_actor_leave(Room *room, User *user, User *sender, SharedFrame *notice); // 멤버 제거 및 안내 요청 후 완료 대기 - 남은 멤버 수 반환
+void room_actor_post_frame(Room *room, User *sender, SharedFrame *frame); // 프레임 전송 요청 (참조 추가, 바로 반환)
+void room_actor_destroy(Room *room);    // 대화방 해제 요청 (디렉터리에서 제거된 뒤 호출)
+
+#endif // ROOM_ACTOR_H
@@ -0,0 +1,331 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/mman.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <linux/memfd.h>
+#include "chat_server.h"
+#include "shm_tap.h"
+
+#define SHM_TAP_LISTEN_TAG  UINT64_MAX  // 접속 소켓 epoll 태그 (사이드카는 슬롯 번호 * 2 + 0: 제어 소켓, 1: rx eventfd)
+
+// ================== 전역 변수 초기화 ===================
+int g_shm_tap_count = 0;                // 붙어있는 사이드카 수
+static ShmTap g_taps[SHM_TAP_MAX];      // 사이드카 슬롯 (슬롯 할당/해제는 탭 스레드만 수행)
+static unsigned char *g_tap_tx_data[SHM_TAP_MAX]; // 슬롯별 tx 링 데이터 (영역 헤더의 값은 사이드카가 바꿀 수 있으므로 서버가 따로 보관)
+static unsigned char *g_tap_rx_data[SHM_TAP_MAX]; // 슬롯별 rx 링 데이터
+static uint32_t g_tap_ring_size = SHM_TAP_DEFAULT_RING_SIZE; // 방향별 링 크기
+static int g_tap_listen = -1;           // 사이드카 접속 소켓
+static int g_tap_epfd = -1;             // 탭 스레드 epoll 디스크립터
+static unsigned char g_tap_rx_buf[sizeof(PacketHeader) + UINT16_MAX + 1]; // rx 레코드 복사 버퍼 (탭 스레드 전용, 최대 패킷 크기)
+
+// ================== 슬롯 관리 ===================
+// 사이드카 연결 해제 함수 - 생산자가 더 쓰지 않도록 비활성화한 뒤 링과 디스크립터 정리
+static void shm_tap_release(int slot) {
+    ShmTap *t = &g_taps[slot];
+
+    pthread_mutex_lock(&t->tx_mutex);
+    int was_active = t->active;
+    t->active = 0;
+    pthread_mutex_unlock(&t->tx_mutex);
+    if (was_active) {
+        __sync_fetch_and_sub(&g_shm_tap_count, 1);
+        printf("[INFO] Shm tap %d detached (published=%lu, received=%lu, dropped=%llu).\n",
+               slot, t->published, t->received, (unsigned long long)t->region->tx.dropped);
+        fflush(stdout);
+    }
+
+    if (t->ctl_sock >= 0) {
+        epoll_ctl(g_tap_epfd, EPOLL_CTL_DEL, t->ctl_sock, NULL);
+        close(t->ctl_sock);
+    }
+    if (t->rx_efd >= 0) {
+        epoll_ctl(g_tap_epfd, EPOLL_CTL_DEL, t->rx_efd, NULL);
+        close(t->rx_efd);
+    }
+    if (t->tx_efd >= 0) close(t->tx_efd);
+    if (t->memfd >= 0) close(t->memfd);
+    if (t->region) munmap(t->region, t->region_size);
+
+    t->ctl_sock = t->memfd = t->tx_efd = t->rx_efd = -1;
+    t->region = NULL;
+    g_tap_tx_data[slot] = g_tap_rx_data[slot] = NULL;
+}
+
+// 공유 메모리 파일 생성 함수 - 실패 시 -1 반환
+static int shm_tap_memfd(size_t size) {
+    int fd = (int)syscall(__NR_memfd_create, "chat_shm_tap", MFD_CLOEXEC);
+    if (fd < 0) {
+        perror("memfd_create");
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)size) < 0) {
+        perror("ftruncate (shm tap)");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 제어 소켓으로 디스크립터 전달 함수 (SCM_RIGHTS) - memfd, tx eventfd, rx eventfd 순서, 데이터는 링 크기
+static int shm_tap_send_fds(int sock, const int fds[3], uint32_t ring_size) {
+    char ctrl[CMSG_SPACE(sizeof(int) * 3)];
+    struct iovec iov = { .iov_base = &ring_size, .iov_len = sizeof(ring_size) };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    memset(ctrl, 0, sizeof(ctrl));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = ctrl;
+    msg.msg_controllen = sizeof(ctrl);
+
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * 3);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * 3);
+
+    if (sendmsg(sock, &msg, MSG_NOSIGNAL) < 0) {
+        perror("sendmsg (shm tap)");
+        return -1;
+    }
+    return 0;
+}
+
+// epoll 등록 함수
+static int shm_tap_watch(int fd, uint64_t tag) {
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLRDHUP;
+    ev.data.u64 = tag;
+    if (epoll_ctl(g_tap_epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        perror("epoll_ctl (shm tap)");
+        return -1;
+    }
+    return 0;
+}
+
+// 사이드카 접속 처리 함수 - 공유 메모리 링 한 쌍과 eventfd 두 개를 만들어 넘김
+static void shm_tap_accept(void) {
+    int sock = accept(g_tap_listen, NULL, NULL);
+    if (sock < 0) {
+        if (errno != EAGAIN && errno != EINTR) perror("accept (shm tap)");
+        return;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < SHM_TAP_MAX; i++) {
+        if (!g_taps[i].region && g_taps[i].ctl_sock < 0) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) {
+        fprintf(stderr, "[ERROR] Shm tap refused: too many sidecars (max %d).\n", SHM_TAP_MAX);
+        close(sock);
+        return;
+    }
+
+    ShmTap *t = &g_taps[slot];
+    t->ctl_sock = sock;
+    t->published = t->received = 0;
+    t->region_size = shm_region_size(g_tap_ring_size);
+    t->memfd = shm_tap_memfd(t->region_size);
+    if (t->memfd < 0) goto fail;
+
+    void *map = mmap(NULL, t->region_size, PROT_READ | PROT_WRITE, MAP_SHARED, t->memfd, 0);
+    if (map == MAP_FAILED) {
+        perror("mmap (shm tap)");
+        goto fail;
+    }
+    t->region = (ShmRegion *)map;
+    shm_region_init(t->region, g_tap_ring_size);
+    g_tap_tx_data[slot] = shm_ring_data(t->region, 0);
+    g_tap_rx_data[slot] = shm_ring_data(t->region, 1);
+    shm_ring_prepare_wait(&t->region->rx); // 서버는 rx 링이 비어있는 상태로 대기 시작
+
+    t->tx_efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    t->rx_efd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (t->tx_efd < 0 || t->rx_efd < 0) {
+        perror("eventfd (shm tap)");
+        goto fail;
+    }
+
+    int fds[3] = { t->memfd, t->tx_efd, t->rx_efd };
+    if (shm_tap_send_fds(sock, fds, g_tap_ring_size) < 0) goto fail;
+    if (shm_tap_watch(sock, (uint64_t)slot * 2) < 0) goto fail;
+    if (shm_tap_watch(t->rx_efd, (uint64_t)slot * 2 + 1) < 0) goto fail;
+
+    pthread_mutex_lock(&t->tx_mutex);
+    t->active = 1;
+    pthread_mutex_unlock(&t->tx_mutex);
+    __sync_fetch_and_add(&g_shm_tap_count, 1);
+
+    printf("[INFO] Shm tap %d attached (ring %u bytes x 2).\n", slot, g_tap_ring_size);
+    fflush(stdout);
+    return;
+
+fail:
+    shm_tap_release(slot);
+}
+
+// ================== rx 처리 ===================
+// 대화방에 사이드카 메시지 전송 (관리/중재용 안내)
+static void shm_tap_post_to_room(unsigned int room_no, const char *text) {
+    char msg[BUFFER_SIZE];
+    snprintf(msg, sizeof(msg), "[sidecar] %s\n", text);
+
+    pthread_rwlock_rdlock(&g_rooms_lock);
+    Room *room = find_room_by_no_unlocked(room_no);
+    if (room) broadcast_server_message_to_room(room, NULL, msg);
+    pthread_rwlock_unlock(&g_rooms_lock);
+}
+
+// rx 레코드 처리 함수 - 요청 패킷 형식과 체크섬을 확인한 뒤 처리 (현재는 MESSAGE만 지원)
+static void shm_tap_handle_record(ShmTap *t, const ShmRecordHdr *rec, unsigned char *packet) {
+    PacketHeader hdr;
+    if (rec->len < sizeof(PacketHeader) + 1) return;
+    memcpy(&hdr, packet, sizeof(hdr));
+    hdr.magic = ntohs(hdr.magic);
+    hdr.data_len = ntohs(hdr.data_len);
+    if (hdr.magic != REQ_MAGIC || sizeof(PacketHeader) + hdr.data_len + 1 != rec->len) return;
+    if (calculate_checksum(packet, rec->len - 1) != packet[rec->len - 1]) return;
+    t->received++;
+
+    unsigned char *data = packet + sizeof(PacketHeader);
+    data[hdr.data_len] = '\0'; // 확인이 끝난 체크섬 자리에 NUL 종료
+
+    switch (hdr.type) {
+        case PACKET_TYPE_MESSAGE:
+            if (hdr.data_len > 0) shm_tap_post_to_room(rec->room_no, (const char *)data);
+            break;
+        default:
+            break; // 그 밖의 요청은 무시
+    }
+}
+
+// rx 링 처리 함수 - 배치 한도까지 읽고, 비면 대기 표시 후 반환
+static void shm_tap_drain_rx(int slot) {
+    ShmTap *t = &g_taps[slot];
+    ShmRingCtl *rx = &t->region->rx;
+    ShmRecordHdr rec;
+    uint64_t val;
+
+    if (read(t->rx_efd, &val, sizeof(val)) < 0 && errno != EAGAIN) {
+        perror("read (shm tap eventfd)");
+    }
+
+    for (int n = 0; n < SHM_TAP_RX_BATCH; n++) {
+        int r = shm_ring_read(rx, g_tap_rx_data[slot], g_tap_ring_size, &rec, g_tap_rx_buf, sizeof(g_tap_rx_buf));
+        if (r > 0) {
+            shm_tap_handle_record(t, &rec, g_tap_rx_buf);
+        } else if (r == 0) {
+            if (shm_ring_prepare_wait(rx)) continue; // 대기 표시 전에 들어온 레코드가 있음
+            return;
+        }
+    }
+    // 배치 한도 도달: 대기 표시 없이 스스로 다시 알림 (다음 epoll_wait에서 이어서 처리)
+    val = 1;
+    if (write(t->rx_efd, &val, sizeof(val)) < 0) {
+        perror("write (shm tap eventfd)");
+    }
+}
+
+// ================== 탭 스레드 ===================
+static void *shm_tap_thread(void *arg) {
+    (void)arg;
+    struct epoll_event events[SHM_TAP_MAX * 2 + 1];
+    char discard[64];
+
+    while (1) {
+        int n = epoll_wait(g_tap_epfd, events, SHM_TAP_MAX * 2 + 1, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait (shm tap)");
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            uint64_t tag = events[i].data.u64;
+            if (tag == SHM_TAP_LISTEN_TAG) {
+                shm_tap_accept();
+                continue;
+            }
+            int slot = (int)(tag >> 1);
+            if (!g_taps[slot].region) continue; // 같은 배치에서 이미 해제됨
+
+            if (tag & 1) {
+                shm_tap_drain_rx(slot);
+                continue;
+            }
+            // 제어 소켓: 연결 종료 확인용 (받은 데이터는 버림)
+            ssize_t r = recv(g_taps[slot].ctl_sock, discard, sizeof(discard), MSG_DONTWAIT);
+            if (r == 0 || (r < 0 && errno != EAGAIN && errno != EINTR)) {
+                shm_tap_release(slot);
+            }
+        }
+    }
+    return NULL;
+}
+
+// ================== 외부 인터페이스 ===================
+// 사이드카 접속 소켓 생성 및 탭 스레드 시작 함수 - 성공 시 0, 실패 시 -1 반환
+int shm_tap_init(const char *path, uint32_t ring_size) {
+    // 링 크기를 2의 거듭제곱으로 올림 (위치 계산을 마스크로 처리)
+    if (ring_size < SHM_RING_MIN_SIZE) ring_size = SHM_RING_MIN_SIZE;
+    if (ring_size > SHM_TAP_MAX_RING_SIZE) ring_size = SHM_TAP_MAX_RING_SIZE;
+    g_tap_ring_size = SHM_RING_MIN_SIZE;
+    while (g_tap_ring_size < ring_size) g_tap_ring_size <<= 1;
+
+    for (int i = 0; i < SHM_TAP_MAX; i++) {
+        ShmTap *t = &g_taps[i];
+        memset(t, 0, sizeof(*t));
+        t->ctl_sock = t->memfd = t->tx_efd = t->rx_efd = -1;
+        pthread_mutex_init(&t->tx_mutex, NULL);
+    }
+
+    g_tap_listen = open_unix_listen_socket(path);
+    if (g_tap_listen < 0) return -1;
+    g_tap_epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_tap_epfd < 0) {
+        perror("epoll_create1 (shm tap)");
+        return -1;
+    }
+    if (shm_tap_watch(g_tap_listen, SHM_TAP_LISTEN_TAG) < 0) return -1;
+
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, shm_tap_thread, NULL) != 0) {
+        perror("pthread_create (shm tap)");
+        return -1;
+    }
+    pthread_detach(thread); // 리소스 자동 회수
+    return 0;
+}
+
+// 대화방 브로드캐스트 프레임 기록 함수 - 링이 가득 찬 사이드카는 이 프레임을 놓침 (서버는 기다리지 않음)
+void shm_tap_publish(unsigned int room_no, const SharedFrame *frame) {
+    for (int i = 0; i < SHM_TAP_MAX; i++) {
+        ShmTap *t = &g_taps[i];
+        if (!__atomic_load_n(&t->active, __ATOMIC_RELAXED)) continue;
+
+        pthread_mutex_lock(&t->tx_mutex);
+        if (t->active) {
+            int r = shm_ring_write(&t->region->tx, g_tap_tx_data[i], g_tap_ring_size, room_no, frame->data, (uint32_t)frame->len);
+            if (r >= 0) t->published++;
+            if (r > 0) {
+                uint64_t one = 1;
+                if (write(t->tx_efd, &one, sizeof(one)) < 0) {
+                    perror("write (shm tap eventfd)");
+                }
+            }
+        }
+        pthread_mutex_unlock(&t->tx_mutex);
+    }
+}
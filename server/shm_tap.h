@@ -0,0 +1,38 @@
+#ifndef SHM_TAP_H
+#define SHM_TAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include "chat_server.h"
+#include "../common/chat_shm.h"
+
+// ================== 공유 메모리 탭 설정 ===================
+#define SHM_TAP_MAX                 16          // 동시에 붙을 수 있는 사이드카 수
+#define SHM_TAP_DEFAULT_RING_SIZE   (4u << 20)  // 방향별 기본 링 크기 (CHAT_SHM_RING_SIZE로 변경, 2의 거듭제곱으로 올림)
+#define SHM_TAP_MAX_RING_SIZE       (1u << 30)  // 방향별 최대 링 크기
+#define SHM_TAP_RX_BATCH            1024        // rx 알림 한 번에 처리할 최대 레코드 수 (다른 사이드카가 밀리지 않도록)
+
+// 사이드카 연결 - 제어 소켓 하나와 공유 메모리 링 한 쌍
+// 제어 소켓으로 memfd/eventfd를 넘긴 뒤에는 연결 유지 확인용으로만 사용 (끊기면 링 해제)
+typedef struct ShmTap {
+    int active;                         // 사용 중 여부 (tx_mutex 보유 상태에서 변경)
+    int ctl_sock;                       // 제어 소켓 (유닉스 도메인)
+    int memfd;                          // 공유 메모리 파일
+    int tx_efd;                         // 서버 -> 사이드카 알림 eventfd
+    int rx_efd;                         // 사이드카 -> 서버 알림 eventfd
+    ShmRegion *region;                  // 매핑된 공유 메모리 영역
+    size_t region_size;                 // 매핑 크기
+    pthread_mutex_t tx_mutex;           // tx 링 생산자 직렬화 (여러 I/O 스레드가 브로드캐스트)
+    unsigned long published;            // tx 링에 기록한 프레임 수
+    unsigned long received;             // rx 링에서 처리한 프레임 수
+} ShmTap;
+
+// ================== 전역 변수 ===================
+extern int g_shm_tap_count;             // 붙어있는 사이드카 수 (0이면 브로드캐스트 경로에서 바로 건너뜀)
+
+// ================== 함수 프로토타입 ===================
+int shm_tap_init(const char *path, uint32_t ring_size); // 사이드카 접속 소켓 생성 및 탭 스레드 시작 - 실패 시 -1 반환
+void shm_tap_publish(unsigned int room_no, const SharedFrame *frame); // 대화방 브로드캐스트 프레임을 모든 사이드카 tx 링에 기록
+
+#endif // SHM_TAP_H
@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "timer_wheel.h"
+
+// 슬롯 리스트 헤드 - 빈 슬롯은 자기 자신을 가리킴
+typedef struct {
+    TimerEntry head;                    // 더미 항목 (next/prev만 사용)
+} TimerSlot;
+
+// ================== 전역 변수 ===================
+static TimerSlot g_wheel[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS]; // 단계별 슬롯
+static uint64_t g_timer_now = 0;        // 현재 틱 (휠 뮤텍스 보유 상태에서 증가)
+static int g_timer_fd = -1;             // 틱 주기 timerfd
+static pthread_mutex_t g_timer_mutex = PTHREAD_MUTEX_INITIALIZER; // 휠 보호용 뮤텍스 (콜백 실행 중에도 보유)
+
+// ================== 슬롯 리스트 ===================
+static void timer_slot_init(TimerSlot *s) {
+    s->head.next = s->head.prev = &s->head;
+}
+
+static void timer_unlink(TimerEntry *t) {
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    t->next = t->prev = NULL;
+    t->pending = 0;
+}
+
+// 만료 틱에 맞는 단계/슬롯에 추가 - 남은 틱이 64^(단계+1)보다 작은 가장 낮은 단계에 배치
+static void timer_insert_unlocked(TimerEntry *t) {
+    uint64_t delta = t->expires - g_timer_now;
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= ((uint64_t)1 << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    int slot = (int)((t->expires >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+
+    TimerEntry *head = &g_wheel[level][slot].head;
+    t->next = head;
+    t->prev = head->prev;
+    head->prev->next = t;
+    head->prev = t;
+    t->pending = 1;
+}
+
+// 상위 단계 슬롯을 비우고 항목을 아래 단계로 다시 배치
+static void timer_cascade_unlocked(int level) {
+    int slot = (int)((g_timer_now >> (TIMER_WHEEL_BITS * level)) & (TIMER_WHEEL_SLOTS - 1));
+    TimerEntry *head = &g_wheel[level][slot].head;
+    TimerEntry *t = head->next;
+
+    timer_slot_init(&g_wheel[level][slot]);
+    while (t != head) {
+        TimerEntry *next = t->next;
+        timer_insert_unlocked(t);
+        t = next;
+    }
+}
+
+// 한 틱 진행 - 필요하면 상위 단계를 먼저 내려보낸 뒤 0단계 현재 슬롯의 항목 실행
+static void timer_tick_unlocked(void) {
+    __atomic_store_n(&g_timer_now, g_timer_now + 1, __ATOMIC_RELAXED);
+
+    for (int level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+        if ((g_timer_now & (((uint64_t)1 << (TIMER_WHEEL_BITS * level)) - 1)) != 0) break;
+        timer_cascade_unlocked(level);
+    }
+
+    TimerEntry *head = &g_wheel[0][g_timer_now & (TIMER_WHEEL_SLOTS - 1)].head;
+    while (head->next != head) {
+        TimerEntry *t = head->next;
+        timer_unlink(t);
+        t->fn(t->arg); // 콜백이 같은 슬롯에 다시 설정해도 다음 바퀴(64틱 뒤) 이후이므로 이 루프에서 다시 실행되지 않음
+    }
+}
+
+// ================== 외부 인터페이스 ===================
+// 타이머 휠 초기화 함수 - 성공 시 timerfd, 실패 시 -1 반환
+int timer_wheel_init(void) {
+    for (int l = 0; l < TIMER_WHEEL_LEVELS; l++) {
+        for (int s = 0; s < TIMER_WHEEL_SLOTS; s++) {
+            timer_slot_init(&g_wheel[l][s]);
+        }
+    }
+
+    g_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (g_timer_fd < 0) {
+        perror("timerfd_create");
+        return -1;
+    }
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_interval.tv_sec = TIMER_TICK_MS / 1000;
+    its.it_interval.tv_nsec = (long)(TIMER_TICK_MS % 1000) * 1000000L;
+    its.it_value = its.it_interval;
+    if (timerfd_settime(g_timer_fd, 0, &its, NULL) < 0) {
+        perror("timerfd_settime");
+        close(g_timer_fd);
+        g_timer_fd = -1;
+        return -1;
+    }
+    return g_timer_fd;
+}
+
+// 틱 처리 함수 - timerfd가 알려준 만료 횟수만큼 진행 (처리가 늦어져도 틱을 건너뛰지 않음)
+void timer_wheel_expire(void) {
+    uint64_t ticks;
+    if (read(g_timer_fd, &ticks, sizeof(ticks)) != sizeof(ticks)) {
+        if (errno != EAGAIN && errno != EINTR) perror("read (timerfd)");
+        return;
+    }
+
+    pthread_mutex_lock(&g_timer_mutex);
+    while (ticks-- > 0) {
+        timer_tick_unlocked();
+    }
+    pthread_mutex_unlock(&g_timer_mutex);
+}
+
+// 현재 틱 반환 함수
+uint64_t timer_now(void) {
+    return __atomic_load_n(&g_timer_now, __ATOMIC_RELAXED);
+}
+
+// 밀리초 -> 틱 변환 함수 (올림)
+uint64_t timer_ms_to_ticks(unsigned long ms) {
+    return (ms + TIMER_TICK_MS - 1) / TIMER_TICK_MS;
+}
+
+// 타이머 항목 초기화 함수
+void timer_init(TimerEntry *t, TimerFn fn, void *arg) {
+    memset(t, 0, sizeof(*t));
+    t->fn = fn;
+    t->arg = arg;
+}
+
+// 타이머 설정 함수 (휠 뮤텍스 보유 상태 또는 타이머 콜백 안에서 호출)
+void timer_arm_unlocked(TimerEntry *t, uint64_t ticks) {
+    uint64_t max = ((uint64_t)1 << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1;
+    if (ticks == 0) ticks = 1; // 현재 슬롯은 이미 지나갔으므로 최소 1틱 뒤
+    if (ticks > max) ticks = max;
+    if (t->pending) timer_unlink(t);
+    t->expires = g_timer_now + ticks;
+    timer_insert_unlocked(t);
+}
+
+// 타이머 설정 함수
+void timer_arm(TimerEntry *t, uint64_t ticks) {
+    pthread_mutex_lock(&g_timer_mutex);
+    timer_arm_unlocked(t, ticks);
+    pthread_mutex_unlock(&g_timer_mutex);
+}
+
+// 타이머 취소 함수 - 콜백이 휠 뮤텍스 안에서 실행되므로 반환 후에는 콜백과 겹치지 않음
+void timer_cancel(TimerEntry *t) {
+    pthread_mutex_lock(&g_timer_mutex);
+    if (t->pending) timer_unlink(t);
+    pthread_mutex_unlock(&g_timer_mutex);
+}
@@ -0,0 +1,36 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <pthread.h>
+
+// ================== 타이머 휠 설정 ===================
+#define TIMER_TICK_MS           100     // 틱 간격 (timerfd 주기, 타이머 해상도)
+#define TIMER_WHEEL_BITS        6       // 단계별 슬롯 수 = 2^6 = 64
+#define TIMER_WHEEL_SLOTS       (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS      4       // 단계 수 (64^4 틱 = 약 19일까지 표현, 넘으면 최대값으로 제한)
+
+// 타이머 콜백 - 휠 뮤텍스를 보유한 채 호출되므로 타이머 재설정은 _unlocked 함수 사용
+typedef void (*TimerFn)(void *arg);
+
+// 타이머 항목 - 소유 구조체에 내장 (슬롯의 이중 연결 리스트에 직접 연결되어 설정/취소 O(1))
+typedef struct TimerEntry {
+    struct TimerEntry *next;            // 같은 슬롯의 다음 항목
+    struct TimerEntry *prev;            // 같은 슬롯의 이전 항목
+    uint64_t expires;                   // 만료 틱
+    TimerFn fn;                         // 만료 시 호출할 함수
+    void *arg;                          // 함수 인자
+    int pending;                        // 휠에 등록되어 있는지 여부
+} TimerEntry;
+
+// ================== 함수 프로토타입 ===================
+int timer_wheel_init(void);             // 타이머 휠 및 timerfd 생성 - timerfd 반환 (호출자의 epoll에 등록), 실패 시 -1
+void timer_wheel_expire(void);          // timerfd 읽기 가능 시 호출 - 지난 틱만큼 진행하며 만료된 타이머 실행
+uint64_t timer_now(void);               // 현재 틱 (잠금 없이 읽기)
+uint64_t timer_ms_to_ticks(unsigned long ms); // 밀리초를 틱 수로 변환 (올림)
+void timer_init(TimerEntry *t, TimerFn fn, void *arg); // 타이머 항목 초기화
+void timer_arm(TimerEntry *t, uint64_t ticks);          // ticks 뒤 만료되도록 설정 (이미 설정되어 있으면 다시 설정)
+void timer_arm_unlocked(TimerEntry *t, uint64_t ticks); // 타이머 콜백 안에서 호출
+void timer_cancel(TimerEntry *t);       // 설정 취소 - 반환 후에는 콜백이 실행 중이거나 실행되지 않음
+
+#endif // TIMER_WHEEL_H
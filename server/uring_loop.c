@@ -0,0 +1,590 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <linux/io_uring.h>
+#include "chat_server.h"
+#include "event_loop.h"
+#include "uring_loop.h"
+#include "out_queue.h"
+
+// liburing 없이 시스템 콜을 직접 사용하는 io_uring 백엔드
+// - multishot accept: SQE 하나로 모든 신규 연결 수락
+// - 제공 버퍼(provided buffer ring) recv: 연결별 수신 버퍼 없이 커널이 버퍼 선택
+// - 사용자 송신 큐의 패킷을 연결별 IOSQE_IO_LINK 체인으로 묶어 io_uring_enter 한 번에 여러 소켓 일괄 제출
+
+// ================== 내부 구조체 ===================
+enum { URING_OP_ACCEPT = 1, URING_OP_RECV, URING_OP_SEND, URING_OP_WAKE };
+
+// CQE 식별용 태그 (user_data가 가리키는 구조체의 첫 멤버)
+typedef struct UringTag {
+    int kind;                           // URING_OP_*
+    struct UringConn *conn;             // 소속 연결 (send)
+} UringTag;
+
+typedef struct UringConn {
+    int kind;                           // URING_OP_RECV
+    User *user;                         // 연결된 사용자
+    int fd;                             // 소켓 디스크립터
+    int recv_armed;                     // recv SQE 제출 여부
+    int inflight;                       // 제출된 send SQE 수
+    int chain_cut;                      // 현재 send 체인이 부분 전송/취소로 끊김
+    int dirty;                          // 제출 대기 목록 등록 여부
+    int busy;                           // 핸들러 실행 중 (해제 보류)
+    int closing;                        // 종료 진행 여부 (남은 송신 후 소켓 종료)
+    int shut;                           // shutdown() 호출 여부
+    int broken;                         // 송신 실패로 남은 데이터 폐기
+    UringTag send_tag;                  // send CQE 식별용 태그
+    struct UringConn *dirty_next;       // 제출 대기 연결 목록
+} UringConn;
+
+typedef struct {
+    int ring_fd;                        // io_uring 디스크립터
+    int listen_sock;                    // 리스닝 소켓
+    int unix_sock;                      // 유닉스 도메인 리스닝 소켓 (없으면 -1)
+    pthread_t thread;                   // 루프 스레드
+
+    // SQ 링
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    struct io_uring_sqe *sqes;
+    unsigned sq_entries;
+    unsigned sq_local_tail;             // 아직 커널에 공개하지 않은 tail
+    unsigned to_submit;                 // 제출 대기 SQE 수
+
+    // CQ 링
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+
+    // 제공 버퍼 링
+    struct io_uring_buf_ring *buf_ring;
+    unsigned char *buf_base;
+    unsigned short buf_tail;
+
+    UringConn **conns;                  // fd -> 연결 매핑
+    int conn_cap;                       // conns 배열 크기
+    UringConn *dirty_head;              // 송신 제출이 필요한 연결 목록
+
+    // 다른 스레드에서 송신 큐에 넣은 경우 링 스레드 깨우기
+    int wake_fd;                        // eventfd
+    uint64_t wake_val;                  // eventfd read 버퍼
+    pthread_mutex_t wake_mutex;         // wake_fds 보호용 뮤텍스
+    int *wake_fds;                      // 송신 제출이 필요한 소켓 목록
+    int wake_count;                     // wake_fds 개수
+    int wake_cap;                       // wake_fds 용량
+} UringLoop;
+
+static UringLoop g_uring;                       // io_uring 루프 (단일 스레드)
+static int g_accept_tag = URING_OP_ACCEPT;      // accept CQE 식별용 태그
+static int g_unix_accept_tag = URING_OP_ACCEPT; // 유닉스 도메인 accept CQE 식별용 태그 (주소로 리스너 구분)
+static int g_wake_tag = URING_OP_WAKE;          // eventfd read CQE 식별용 태그
+
+// ================== 시스템 콜 래퍼 ===================
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+// ================== SQ/CQ 조작 ===================
+// 빈 SQE 하나를 가져오는 함수 - SQ가 가득 차면 먼저 제출 후 재시도
+static struct io_uring_sqe *uring_get_sqe(UringLoop *u) {
+    unsigned head = __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE);
+    if (u->sq_local_tail - head >= u->sq_entries) {
+        // SQ 가득 참: 지금까지 쌓인 SQE 제출
+        __atomic_store_n(u->sq_tail, u->sq_local_tail, __ATOMIC_RELEASE);
+        sys_io_uring_enter(u->ring_fd, u->to_submit, 0, 0);
+        u->to_submit = 0;
+        head = __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE);
+        if (u->sq_local_tail - head >= u->sq_entries) return NULL;
+    }
+    unsigned idx = u->sq_local_tail & *u->sq_mask;
+    struct io_uring_sqe *sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    u->sq_array[idx] = idx;
+    u->sq_local_tail++;
+    u->to_submit++;
+    return sqe;
+}
+
+// 멀티샷 accept 요청 제출 (tag: 리스너별 태그)
+static void uring_arm_accept(UringLoop *u, int *tag) {
+    struct io_uring_sqe *sqe = uring_get_sqe(u);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = tag == &g_unix_accept_tag ? u->unix_sock : u->listen_sock;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = (unsigned long long)(uintptr_t)tag;
+}
+
+// 제공 버퍼 선택 recv 요청 제출
+static void uring_arm_recv(UringLoop *u, UringConn *conn) {
+    struct io_uring_sqe *sqe = uring_get_sqe(u);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn->fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUF_GROUP;
+    sqe->len = URING_BUF_SIZE;
+    sqe->user_data = (unsigned long long)(uintptr_t)conn;
+    conn->recv_armed = 1;
+}
+
+// 깨우기용 eventfd read 요청 제출
+static void uring_arm_wake(UringLoop *u) {
+    struct io_uring_sqe *sqe = uring_get_sqe(u);
+    if (!sqe) return;
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = u->wake_fd;
+    sqe->addr = (unsigned long long)(uintptr_t)&u->wake_val;
+    sqe->len = sizeof(u->wake_val);
+    sqe->user_data = (unsigned long long)(uintptr_t)&g_wake_tag;
+}
+
+// 사용한 제공 버퍼를 커널에 반납
+static void uring_recycle_buffer(UringLoop *u, unsigned short bid) {
+    struct io_uring_buf *buf = &u->buf_ring->bufs[u->buf_tail & (URING_BUF_COUNT - 1)];
+    buf->addr = (unsigned long long)(uintptr_t)(u->buf_base + (size_t)bid * URING_BUF_SIZE);
+    buf->len = URING_BUF_SIZE;
+    buf->bid = bid;
+    u->buf_tail++;
+    __atomic_store_n(&u->buf_ring->tail, u->buf_tail, __ATOMIC_RELEASE);
+}
+
+// ================== 연결 관리 ===================
+static UringConn *uring_find_conn(UringLoop *u, int fd) {
+    if (fd < 0 || fd >= u->conn_cap) return NULL;
+    return u->conns[fd];
+}
+
+static int uring_register_conn(UringLoop *u, UringConn *conn) {
+    if (conn->fd >= u->conn_cap) {
+        int new_cap = u->conn_cap ? u->conn_cap : 1024;
+        while (new_cap <= conn->fd) new_cap *= 2;
+        UringConn **new_conns = realloc(u->conns, sizeof(UringConn *) * (size_t)new_cap);
+        if (!new_conns) return -1;
+        memset(new_conns + u->conn_cap, 0, sizeof(UringConn *) * (size_t)(new_cap - u->conn_cap));
+        u->conns = new_conns;
+        u->conn_cap = new_cap;
+    }
+    u->conns[conn->fd] = conn;
+    return 0;
+}
+
+// 제출 대기 목록에 연결 등록
+static void uring_mark_dirty(UringLoop *u, UringConn *conn) {
+    if (conn->dirty) return;
+    conn->dirty = 1;
+    conn->dirty_next = u->dirty_head;
+    u->dirty_head = conn;
+}
+
+// 남은 송신이 끝나면 소켓을 종료하고, 진행 중인 SQE가 없으면 연결 자원을 최종 해제
+static void uring_try_release(UringLoop *u, UringConn *conn) {
+    if (!conn->closing || conn->busy) return;
+
+    OutQueue *q = &conn->user->outq;
+    pthread_mutex_lock(&q->mutex);
+    if (conn->broken && conn->inflight == 0) out_queue_clear_unlocked(q);
+    int has_output = q->head != NULL;
+    pthread_mutex_unlock(&q->mutex);
+    if (conn->inflight > 0 || has_output || conn->dirty) return; // 아직 보낼 데이터가 있음
+
+    if (!conn->shut) {
+        conn->shut = 1;
+        shutdown(conn->fd, SHUT_RDWR); // 대기 중인 recv가 완료되도록 소켓 종료
+    }
+    if (conn->recv_armed) return;
+
+    if (u->conns[conn->fd] == conn) u->conns[conn->fd] = NULL;
+
+    User *user = conn->user;
+    printf("[INFO] Closing connection for user %s (sock=%d, io_uring).\n", user->id, user->sock);
+    fflush(stdout);
+
+    close(conn->fd);
+    user->sock = -1;
+    destroy_client_session(user);
+    free(conn);
+}
+
+// 연결 종료 시작 - 세션 정리 후 남은 송신과 진행 중인 요청이 끝나면 해제
+static void uring_close_conn(UringLoop *u, UringConn *conn) {
+    if (!conn->closing) {
+        conn->closing = 1; // cleanup_client_session에서 다시 호출되어도 중복 처리되지 않도록 먼저 설정
+        cleanup_client_session(conn->user); // 이미 정리된 세션이면 바로 반환
+    }
+    uring_try_release(u, conn);
+}
+
+// 다른 세션(강퇴 등)에서 요청한 연결 종료 - 이미 큐에 쌓인 안내 패킷을 보낸 뒤 종료
+void uring_loop_close_user(User *user) {
+    UringConn *conn = NULL;
+    if (pthread_equal(pthread_self(), g_uring.thread)) conn = uring_find_conn(&g_uring, user->sock);
+    if (!conn || conn->user != user) {
+        // 링 스레드 밖에서 호출된 경우: 수신 방향만 닫아 recv 완료(EOF)를 유도하여 링 스레드가 정리
+        // (송신 방향은 열어 두어 링 스레드가 큐에 남은 안내 패킷을 보낸 뒤 종료)
+        if (user->sock >= 0) shutdown(user->sock, SHUT_RD);
+        return;
+    }
+    if (!conn->closing) uring_close_conn(&g_uring, conn);
+}
+
+// 송신 큐에 패킷이 추가되었음을 링 스레드에 알리는 함수 - 다른 스레드에서 호출되면 eventfd로 깨움
+void uring_loop_notify(User *user) {
+    UringLoop *u = &g_uring;
+    if (pthread_equal(pthread_self(), u->thread)) {
+        UringConn *conn = uring_find_conn(u, user->sock);
+        if (conn && conn->user == user) uring_mark_dirty(u, conn);
+        return;
+    }
+
+    pthread_mutex_lock(&u->wake_mutex);
+    if (u->wake_count == u->wake_cap) {
+        int new_cap = u->wake_cap ? u->wake_cap * 2 : 64;
+        int *new_fds = realloc(u->wake_fds, sizeof(int) * (size_t)new_cap);
+        if (!new_fds) {
+            pthread_mutex_unlock(&u->wake_mutex);
+            perror("realloc for wake_fds failed");
+            return;
+        }
+        u->wake_fds = new_fds;
+        u->wake_cap = new_cap;
+    }
+    u->wake_fds[u->wake_count++] = user->sock;
+    pthread_mutex_unlock(&u->wake_mutex);
+
+    uint64_t one = 1;
+    if (write(u->wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        perror("write (io_uring wake)");
+    }
+}
+
+// 송신 큐 맨 앞부터 최대 URING_SEND_BATCH개 패킷을 IOSQE_IO_LINK 체인으로 SQ에 적재
+static void uring_submit_chain(UringLoop *u, UringConn *conn) {
+    OutQueue *q = &conn->user->outq;
+    struct io_uring_sqe *prev = NULL;
+    int count = 0;
+
+    pthread_mutex_lock(&q->mutex);
+    for (OutChunk *chunk = q->head; chunk && count < URING_SEND_BATCH; chunk = chunk->next) {
+        struct io_uring_sqe *sqe = uring_get_sqe(u);
+        if (!sqe) break; // SQ 확보 실패: 나머지는 체인 완료 후 제출
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = conn->fd;
+        sqe->addr = (unsigned long long)(uintptr_t)(chunk->buf + chunk->off);
+        sqe->len = (unsigned)(chunk->len - chunk->off);
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        sqe->user_data = (unsigned long long)(uintptr_t)&conn->send_tag;
+        if (prev) prev->flags |= IOSQE_IO_LINK; // 이전 send와 연결 (순서 보장)
+        prev = sqe;
+        count++;
+    }
+    q->pinned = count; // 완료될 때까지 버퍼 유지
+    pthread_mutex_unlock(&q->mutex);
+
+    conn->inflight = count;
+    conn->chain_cut = 0;
+}
+
+// 제출 대기 연결들의 송신 큐를 연결별 send 체인으로 SQ에 적재
+static void uring_flush_sends(UringLoop *u) {
+    UringConn *conn = u->dirty_head;
+    u->dirty_head = NULL;
+
+    while (conn) {
+        UringConn *next = conn->dirty_next;
+        conn->dirty = 0;
+        conn->dirty_next = NULL;
+
+        if (!conn->broken && conn->inflight == 0) {
+            // 같은 소켓의 순서를 지키기 위해 이전 체인이 끝난 뒤에만 다음 체인 제출
+            uring_submit_chain(u, conn);
+        }
+        if (conn->inflight == 0) uring_try_release(u, conn);
+        conn = next;
+    }
+}
+
+// ================== CQE 처리 ===================
+static void uring_handle_accept(UringLoop *u, struct io_uring_cqe *cqe) {
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        uring_arm_accept(u, (int *)(uintptr_t)cqe->user_data); // 멀티샷 accept가 종료된 경우 다시 등록
+    }
+    if (cqe->res < 0) {
+        fprintf(stderr, "[ERROR] io_uring accept: %s\n", strerror(-cqe->res));
+        return;
+    }
+
+    int ns = cqe->res;
+    User *user = create_client_session(ns);
+    if (!user) return; // 접속 거부 또는 할당 실패
+
+    UringConn *conn = calloc(1, sizeof(*conn));
+    if (!conn || uring_register_conn(u, (conn->fd = ns, conn)) < 0) {
+        free(conn);
+        destroy_client_session(user);
+        close(ns);
+        return;
+    }
+    conn->kind = URING_OP_RECV;
+    conn->user = user;
+    conn->send_tag.kind = URING_OP_SEND;
+    conn->send_tag.conn = conn;
+
+    send_id_prompt(user); // 송신 큐에 들어가 이번 배치에 함께 제출됨
+    uring_arm_recv(u, conn);
+
+    printf("[INFO] sock=%d accepted by io_uring loop.\n", ns);
+    fflush(stdout);
+}
+
+static void uring_handle_recv(UringLoop *u, UringConn *conn, struct io_uring_cqe *cqe) {
+    conn->recv_armed = 0;
+
+    if (cqe->res == -ENOBUFS && !conn->closing) {
+        // 제공 버퍼 고갈: 다음 배치에서 재시도
+        uring_arm_recv(u, conn);
+        return;
+    }
+    if (cqe->res <= 0 || conn->closing) {
+        // 연결 종료, 에러 또는 종료 진행 중: 수신 데이터는 버림
+        if (cqe->flags & IORING_CQE_F_BUFFER) {
+            uring_recycle_buffer(u, (unsigned short)(cqe->flags >> IORING_CQE_BUFFER_SHIFT));
+        }
+        uring_close_conn(u, conn);
+        return;
+    }
+
+    unsigned short bid = (unsigned short)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+    unsigned char *data = u->buf_base + (size_t)bid * URING_BUF_SIZE;
+    conn->busy = 1; // 핸들러 실행 중에는 연결 해제 보류
+    int status = event_loop_feed(conn->user, data, (size_t)cqe->res);
+    conn->busy = 0;
+    uring_recycle_buffer(u, bid);
+
+    if (status == CLIENT_CLOSED || conn->closing) {
+        uring_close_conn(u, conn);
+        return;
+    }
+    uring_arm_recv(u, conn);
+}
+
+static void uring_handle_send(UringLoop *u, UringConn *conn, struct io_uring_cqe *cqe) {
+    OutQueue *q = &conn->user->outq;
+    int failed = 0;
+    conn->inflight--;
+
+    pthread_mutex_lock(&q->mutex);
+    if (cqe->res > 0 && !conn->chain_cut && q->head) {
+        // 체인은 순서대로 완료되므로 완료된 send는 항상 큐의 맨 앞 패킷
+        OutChunk *chunk = q->head;
+        chunk->off += (size_t)cqe->res;
+        q->bytes -= (size_t)cqe->res;
+        if (chunk->off == chunk->len) {
+            out_queue_pop_unlocked(q);
+            q->pinned--;
+        } else {
+            conn->chain_cut = 1; // 부분 전송: 뒤따르는 send는 취소됨, 남은 부분은 다음 체인에서 전송
+        }
+    } else if (cqe->res >= 0 || cqe->res == -ECANCELED || cqe->res == -EAGAIN || cqe->res == -EINTR) {
+        conn->chain_cut = 1; // 링크 끊김으로 취소: 다음 체인에서 다시 제출
+    } else {
+        failed = 1;
+    }
+    if (conn->inflight == 0) q->pinned = 0;
+    int has_output = q->head != NULL;
+    pthread_mutex_unlock(&q->mutex);
+
+    if (failed) {
+        // 전송 실패 (연결 끊김 등): 남은 데이터는 폐기하고 종료 처리 유도
+        conn->broken = 1;
+        if (!conn->shut) {
+            conn->shut = 1;
+            shutdown(conn->fd, SHUT_RDWR); // recv 완료로 종료 처리 유도
+        }
+    }
+
+    if (!conn->broken && conn->inflight == 0 && has_output) {
+        uring_mark_dirty(u, conn); // 남은 패킷은 다음 체인으로 제출 (종료 중이어도 모두 보낸 뒤 해제)
+    } else if (conn->closing || conn->broken) {
+        uring_try_release(u, conn);
+    }
+}
+
+// 다른 스레드가 요청한 송신 제출 처리 (eventfd read 완료)
+static void uring_handle_wake(UringLoop *u) {
+    pthread_mutex_lock(&u->wake_mutex);
+    for (int i = 0; i < u->wake_count; i++) {
+        UringConn *conn = uring_find_conn(u, u->wake_fds[i]);
+        if (conn) uring_mark_dirty(u, conn);
+    }
+    u->wake_count = 0;
+    pthread_mutex_unlock(&u->wake_mutex);
+    uring_arm_wake(u);
+}
+
+// io_uring 루프 스레드 함수
+static void *uring_loop_thread(void *args) {
+    UringLoop *u = (UringLoop *)args;
+    u->thread = pthread_self(); // 링 스레드 판별용 (pthread_create 반환 전에 이벤트가 올 수 있음)
+
+    uring_arm_accept(u, &g_accept_tag);
+    if (u->unix_sock >= 0) uring_arm_accept(u, &g_unix_accept_tag);
+    uring_arm_wake(u);
+
+    while (1) {
+        // 핸들러가 쌓은 송신 요청을 SQ에 적재하고 한 번의 시스템 콜로 제출 + 완료 대기
+        uring_flush_sends(u);
+        __atomic_store_n(u->sq_tail, u->sq_local_tail, __ATOMIC_RELEASE);
+        int ret = sys_io_uring_enter(u->ring_fd, u->to_submit, 1, IORING_ENTER_GETEVENTS);
+        if (ret < 0 && errno != EINTR && errno != EBUSY) {
+            perror("io_uring_enter");
+            break;
+        }
+        if (ret > 0) u->to_submit -= (unsigned)ret < u->to_submit ? (unsigned)ret : u->to_submit;
+
+        unsigned head = *u->cq_head;
+        unsigned tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            struct io_uring_cqe *cqe = &u->cqes[head & *u->cq_mask];
+            int kind = *(int *)(uintptr_t)cqe->user_data;
+
+            if (kind == URING_OP_ACCEPT) {
+                uring_handle_accept(u, cqe);
+            } else if (kind == URING_OP_RECV) {
+                uring_handle_recv(u, (UringConn *)(uintptr_t)cqe->user_data, cqe);
+            } else if (kind == URING_OP_SEND) {
+                uring_handle_send(u, ((UringTag *)(uintptr_t)cqe->user_data)->conn, cqe);
+            } else if (kind == URING_OP_WAKE) {
+                uring_handle_wake(u);
+            }
+            head++;
+            __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+            tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+        }
+    }
+    return NULL;
+}
+
+// ================== 초기화 ===================
+// 제공 버퍼 링 생성 및 등록 (실패 시 이미 만든 링/버퍼는 호출자가 해제)
+static int uring_setup_buffers(UringLoop *u) {
+    size_t ring_size = sizeof(struct io_uring_buf) * URING_BUF_COUNT;
+    void *ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ring == MAP_FAILED) return -1;
+    u->buf_ring = (struct io_uring_buf_ring *)ring;
+
+    u->buf_base = malloc((size_t)URING_BUF_COUNT * URING_BUF_SIZE);
+    if (!u->buf_base) return -1;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (unsigned long long)(uintptr_t)ring;
+    reg.ring_entries = URING_BUF_COUNT;
+    reg.bgid = URING_BUF_GROUP;
+    if (sys_io_uring_register(u->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        return -1; // 5.19 미만 커널: 제공 버퍼 링/멀티샷 accept 미지원
+    }
+
+    u->buf_tail = 0;
+    for (unsigned short bid = 0; bid < URING_BUF_COUNT; bid++) {
+        uring_recycle_buffer(u, bid);
+    }
+    return 0;
+}
+
+// io_uring 루프 생성 및 스레드 시작 함수 - 성공 시 0, 실패 시 -1 반환
+int uring_loop_init(int listen_sock, int unix_sock) {
+    UringLoop *u = &g_uring;
+    memset(u, 0, sizeof(*u));
+    u->listen_sock = listen_sock;
+    u->unix_sock = unix_sock;
+    u->wake_fd = -1;
+    u->sqes = MAP_FAILED;
+    unsigned char *ring = MAP_FAILED; // SQ/CQ 링 매핑 (실패 시 해제용)
+    size_t ring_size = 0;
+    int wake_mutex_ready = 0;
+
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    u->ring_fd = sys_io_uring_setup(URING_QUEUE_DEPTH, &p);
+    if (u->ring_fd < 0) {
+        perror("io_uring_setup");
+        return -1;
+    }
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        fprintf(stderr, "[ERROR] io_uring: kernel too old (no IORING_FEAT_SINGLE_MMAP).\n");
+        goto fail;
+    }
+
+    // SQ/CQ 링 매핑 (단일 mmap)
+    size_t sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    ring_size = sq_size > cq_size ? sq_size : cq_size;
+    ring = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED) {
+        perror("mmap (io_uring ring)");
+        goto fail;
+    }
+    u->sq_head = (unsigned *)(ring + p.sq_off.head);
+    u->sq_tail = (unsigned *)(ring + p.sq_off.tail);
+    u->sq_mask = (unsigned *)(ring + p.sq_off.ring_mask);
+    u->sq_array = (unsigned *)(ring + p.sq_off.array);
+    u->sq_entries = p.sq_entries;
+    u->sq_local_tail = *u->sq_tail;
+    u->cq_head = (unsigned *)(ring + p.cq_off.head);
+    u->cq_tail = (unsigned *)(ring + p.cq_off.tail);
+    u->cq_mask = (unsigned *)(ring + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *)(ring + p.cq_off.cqes);
+
+    u->sqes = mmap(NULL, p.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, u->ring_fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) {
+        perror("mmap (io_uring sqes)");
+        goto fail;
+    }
+
+    u->wake_fd = eventfd(0, EFD_CLOEXEC); // 논블로킹이면 링의 read가 EAGAIN으로 끝나므로 블로킹 fd 사용
+    if (u->wake_fd < 0) {
+        perror("eventfd (io_uring wake)");
+        goto fail;
+    }
+    pthread_mutex_init(&u->wake_mutex, NULL);
+    wake_mutex_ready = 1;
+
+    if (uring_setup_buffers(u) < 0) {
+        fprintf(stderr, "[ERROR] io_uring: provided buffer ring not supported.\n");
+        goto fail;
+    }
+
+    if (pthread_create(&u->thread, NULL, uring_loop_thread, u) != 0) {
+        perror("pthread_create (io_uring loop)");
+        goto fail;
+    }
+    pthread_detach(u->thread); // 리소스 자동 회수
+    return 0;
+
+fail:
+    // 지금까지 얻은 자원을 역순으로 해제 - 실패하면 epoll 모드로 계속 실행하므로 남겨 두지 않음
+    free(u->buf_base);
+    if (u->buf_ring) munmap(u->buf_ring, sizeof(struct io_uring_buf) * URING_BUF_COUNT);
+    if (wake_mutex_ready) pthread_mutex_destroy(&u->wake_mutex);
+    if (u->wake_fd >= 0) close(u->wake_fd);
+    if (u->sqes != MAP_FAILED) munmap(u->sqes, p.sq_entries * sizeof(struct io_uring_sqe));
+    if (ring != MAP_FAILED) munmap(ring, ring_size);
+    close(u->ring_fd); // 제공 버퍼 링 등록도 함께 해제됨
+    memset(u, 0, sizeof(*u));
+    return -1;
+}
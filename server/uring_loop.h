@@ -0,0 +1,19 @@
+#ifndef URING_LOOP_H
+#define URING_LOOP_H
+
+#include "chat_server.h"
+
+// ================== io_uring 백엔드 설정 ===================
+#define URING_QUEUE_DEPTH       1024    // SQ 엔트리 수
+#define URING_BUF_COUNT         1024    // 수신용 제공 버퍼 수 (2의 거듭제곱)
+#define URING_BUF_SIZE          4096    // 수신용 제공 버퍼 크기
+#define URING_BUF_GROUP         0       // 제공 버퍼 그룹 ID
+#define URING_SEND_BATCH        64      // 연결별 send 체인 최대 길이
+
+// ================== 함수 프로토타입 ===================
+// io_uring 루프 생성 및 스레드 시작 (listen_sock/unix_sock의 accept/recv/send 전담, unix_sock은 없으면 -1) - 커널 미지원 시 -1 반환
+int uring_loop_init(int listen_sock, int unix_sock);
+void uring_loop_close_user(User *user); // 다른 세션에서 요청한 연결 종료 (남은 송신 후 종료)
+void uring_loop_notify(User *user);     // 송신 큐에 패킷이 추가되었음을 링 스레드에 알림
+
+#endif // URING_LOOP_H
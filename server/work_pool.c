@@ -0,0 +1,297 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "chat_server.h"
+#include "work_pool.h"
+
+// 작업 스레드
+typedef struct WorkWorker {
+    int index;                          // 작업 스레드 번호
+    pthread_t thread;                   // 스레드
+    WorkDeque deque;                    // 실행 대기 스트랜드 덱
+} WorkWorker;
+
+// ================== 전역 변수 초기화 ===================
+int g_work_pool_count = 0;              // 작업 스레드 수 (0: 비활성)
+static WorkWorker *g_workers = NULL;    // 작업 스레드 배열
+static unsigned int g_next_worker = 0;  // 외부 스레드가 스트랜드를 넣을 다음 덱 (라운드 로빈)
+static unsigned long g_work_queued = 0; // 덱에 들어있는 스트랜드 수 (대기 판단용)
+static pthread_mutex_t g_work_mutex = PTHREAD_MUTEX_INITIALIZER; // 유휴 대기 보호용 뮤텍스
+static pthread_cond_t g_work_cond = PTHREAD_COND_INITIALIZER;    // 새 스트랜드 알림
+static WorkStrand g_persist_strand;     // 채팅 메시지 저장 전용 스트랜드 (전역 저장 순서 유지)
+static __thread WorkWorker *t_worker = NULL; // 현재 스레드의 작업 스레드 정보 (작업 스레드가 아니면 NULL)
+static __thread WorkStrand *t_strand = NULL; // 현재 스레드가 실행 중인 작업의 스트랜드 (없으면 NULL)
+
+// ================== 덱 ===================
+static int work_deque_init(WorkDeque *dq) {
+    pthread_mutex_init(&dq->mutex, NULL);
+    dq->items = malloc(WORK_DEQUE_INIT_CAP * sizeof(*dq->items));
+    if (!dq->items) return -1;
+    dq->cap = WORK_DEQUE_INIT_CAP;
+    dq->top = dq->bottom = 0;
+    return 0;
+}
+
+// 아래쪽에 추가 (가득 차면 두 배로 확장)
+static int work_deque_push(WorkDeque *dq, WorkStrand *strand) {
+    pthread_mutex_lock(&dq->mutex);
+    if (dq->bottom - dq->top == dq->cap) {
+        WorkStrand **items = malloc(dq->cap * 2 * sizeof(*items));
+        if (!items) {
+            pthread_mutex_unlock(&dq->mutex);
+            perror("malloc for work deque failed");
+            return -1;
+        }
+        for (size_t i = dq->top; i < dq->bottom; i++) {
+            items[i & (dq->cap * 2 - 1)] = dq->items[i & (dq->cap - 1)];
+        }
+        free(dq->items);
+        dq->items = items;
+        dq->cap *= 2;
+    }
+    dq->items[dq->bottom & (dq->cap - 1)] = strand;
+    dq->bottom++;
+    pthread_mutex_unlock(&dq->mutex);
+    return 0;
+}
+
+// 아래쪽에서 꺼내기 (소유 스레드 - 최근에 넣은 스트랜드, 캐시 지역성)
+static WorkStrand *work_deque_pop(WorkDeque *dq) {
+    WorkStrand *strand = NULL;
+    pthread_mutex_lock(&dq->mutex);
+    if (dq->bottom != dq->top) {
+        dq->bottom--;
+        strand = dq->items[dq->bottom & (dq->cap - 1)];
+    }
+    pthread_mutex_unlock(&dq->mutex);
+    return strand;
+}
+
+// 위쪽에서 훔치기 (다른 스레드 - 가장 오래 기다린 스트랜드, 잠금 경합 시 건너뜀)
+static WorkStrand *work_deque_steal(WorkDeque *dq) {
+    WorkStrand *strand = NULL;
+    if (pthread_mutex_trylock(&dq->mutex) != 0) return NULL;
+    if (dq->bottom != dq->top) {
+        strand = dq->items[dq->top & (dq->cap - 1)];
+        dq->top++;
+    }
+    pthread_mutex_unlock(&dq->mutex);
+    return strand;
+}
+
+// ================== 스케줄링 ===================
+// 스트랜드를 덱에 넣고 유휴 작업 스레드를 깨움 (작업 스레드면 자기 덱, 아니면 라운드 로빈)
+static int work_pool_schedule(WorkStrand *strand) {
+    WorkWorker *w = t_worker;
+    if (!w) {
+        unsigned int idx = __sync_fetch_and_add(&g_next_worker, 1) % (unsigned int)g_work_pool_count;
+        w = &g_workers[idx];
+    }
+    if (work_deque_push(&w->deque, strand) < 0) return -1;
+
+    pthread_mutex_lock(&g_work_mutex);
+    g_work_queued++;
+    pthread_cond_signal(&g_work_cond);
+    pthread_mutex_unlock(&g_work_mutex);
+    return 0;
+}
+
+// 실행할 스트랜드 찾기 - 자기 덱을 먼저 보고, 비었으면 다른 작업 스레드의 덱에서 훔침
+static WorkStrand *work_pool_take(WorkWorker *w) {
+    WorkStrand *strand = work_deque_pop(&w->deque);
+    for (int i = 1; !strand && i < g_work_pool_count; i++) {
+        strand = work_deque_steal(&g_workers[(w->index + i) % g_work_pool_count].deque);
+    }
+    if (strand) __sync_fetch_and_sub(&g_work_queued, 1);
+    return strand;
+}
+
+// 스트랜드의 맨 앞 작업 하나 실행 - 작업이 남으면 다시 스케줄, 비면 해제 요청 처리
+static void work_pool_run(WorkStrand *strand) {
+    pthread_mutex_lock(&strand->mutex);
+    WorkJob *job;
+    while ((job = strand->head) != NULL) {
+        strand->head = job->next;
+        if (!strand->head) strand->tail = NULL;
+        strand->running = 1;
+        pthread_mutex_unlock(&strand->mutex);
+
+        WorkStrand *outer = t_strand; // 스케줄 실패로 호출 스레드에서 바로 실행하는 경우 중첩될 수 있음
+        t_strand = strand;
+        job->fn(job->arg);
+        t_strand = outer;
+        free(job);
+
+        pthread_mutex_lock(&strand->mutex);
+        strand->running = 0;
+        pthread_cond_broadcast(&strand->idle);
+        if (!strand->head) break;
+
+        // 남은 작업은 다른 스트랜드 뒤로 다시 스케줄 (한 연결이 작업 스레드를 독점하지 않도록)
+        pthread_mutex_unlock(&strand->mutex);
+        if (work_pool_schedule(strand) == 0) return;
+        pthread_mutex_lock(&strand->mutex); // 스케줄 실패 시 이 스레드에서 계속 처리
+    }
+    strand->scheduled = 0;
+    int release = strand->release && strand->holds == 0; // 참조 중이면 마지막 참조 해제 시 해제
+    pthread_mutex_unlock(&strand->mutex);
+
+    if (release) destroy_client_session(strand->user); // 세션이 닫히는 동안 남아있던 작업이 모두 끝남
+}
+
+// 작업 스레드 함수
+static void *work_pool_thread(void *arg) {
+    WorkWorker *w = (WorkWorker *)arg;
+    t_worker = w;
+
+    for (;;) {
+        WorkStrand *strand = work_pool_take(w);
+        if (strand) {
+            work_pool_run(strand);
+            continue;
+        }
+        pthread_mutex_lock(&g_work_mutex);
+        while (g_work_queued == 0) {
+            pthread_cond_wait(&g_work_cond, &g_work_mutex);
+        }
+        pthread_mutex_unlock(&g_work_mutex);
+    }
+    return NULL;
+}
+
+// ================== 외부 인터페이스 ===================
+// 작업 스레드 생성 함수 - 실패 시 -1 반환
+int work_pool_init(int worker_count) {
+    if (worker_count <= 0) return 0;
+    if (worker_count > WORK_POOL_MAX_WORKERS) worker_count = WORK_POOL_MAX_WORKERS;
+
+    g_workers = calloc((size_t)worker_count, sizeof(WorkWorker));
+    if (!g_workers) {
+        perror("calloc for work pool failed");
+        return -1;
+    }
+    work_strand_init(&g_persist_strand, NULL);
+
+    for (int i = 0; i < worker_count; i++) {
+        WorkWorker *w = &g_workers[i];
+        w->index = i;
+        if (work_deque_init(&w->deque) < 0) {
+            perror("malloc for work deque failed");
+            return -1;
+        }
+    }
+    // 덱을 모두 준비한 뒤 스레드 시작 (훔치기가 초기화되지 않은 덱을 보지 않도록)
+    g_work_pool_count = worker_count;
+    for (int i = 0; i < worker_count; i++) {
+        if (pthread_create(&g_workers[i].thread, NULL, work_pool_thread, &g_workers[i]) != 0) {
+            perror("pthread_create (work pool)");
+            return -1;
+        }
+        pthread_detach(g_workers[i].thread); // 리소스 자동 회수
+    }
+    return 0;
+}
+
+// 스트랜드 초기화 함수
+void work_strand_init(WorkStrand *strand, struct User *user) {
+    pthread_mutex_init(&strand->mutex, NULL);
+    pthread_cond_init(&strand->idle, NULL);
+    strand->head = strand->tail = NULL;
+    strand->scheduled = 0;
+    strand->running = 0;
+    strand->release = 0;
+    strand->holds = 0;
+    strand->user = user;
+}
+
+// 스트랜드 정리 함수
+void work_strand_destroy(WorkStrand *strand) {
+    pthread_cond_destroy(&strand->idle);
+    pthread_mutex_destroy(&strand->mutex);
+}
+
+// 스트랜드에 작업 추가 함수 - 스트랜드가 쉬고 있으면 작업 스레드 덱에 넣음
+int work_pool_submit(WorkStrand *strand, WorkFn fn, void *arg) {
+    WorkJob *job = malloc(sizeof(*job));
+    if (!job) {
+        perror("malloc for work job failed");
+        return -1;
+    }
+    job->next = NULL;
+    job->fn = fn;
+    job->arg = arg;
+
+    pthread_mutex_lock(&strand->mutex);
+    if (strand->tail) strand->tail->next = job;
+    else strand->head = job;
+    strand->tail = job;
+    int schedule = !strand->scheduled;
+    strand->scheduled = 1;
+    pthread_mutex_unlock(&strand->mutex);
+
+    if (schedule && work_pool_schedule(strand) < 0) {
+        // 덱에 넣지 못하면 호출 스레드에서 바로 실행 (순서는 유지됨 - 이 스트랜드는 스케줄되지 않았으므로 혼자 실행)
+        work_pool_run(strand);
+    }
+    return 0;
+}
+
+// 대기/실행 중인 작업이 있는지 확인하는 함수 - 있으면 이후 패킷도 같은 스트랜드로 보내야 순서가 유지됨
+int work_pool_strand_busy(WorkStrand *strand) {
+    pthread_mutex_lock(&strand->mutex);
+    int busy = strand->scheduled;
+    pthread_mutex_unlock(&strand->mutex);
+    return busy;
+}
+
+// 실행 중인 작업이 끝날 때까지 대기하는 함수
+// 같은 스트랜드의 작업 안에서 호출하면(자기 세션 종료) 자기 자신을 기다리는 교착이므로 바로 반환
+// 다른 사용자의 작업 안에서 호출하면(강퇴 등) 대상의 실행 중인 작업(입장/생성 등)이 끝날 때까지 대기
+void work_pool_wait_idle(WorkStrand *strand) {
+    if (t_strand == strand || g_work_pool_count == 0) return;
+    pthread_mutex_lock(&strand->mutex);
+    while (strand->running) {
+        pthread_cond_wait(&strand->idle, &strand->mutex);
+    }
+    pthread_mutex_unlock(&strand->mutex);
+}
+
+// 세션 해제 요청 함수 - 스트랜드가 스케줄 중이거나 다른 명령이 참조 중이면 나중에 해제하도록 표시하고 1 반환
+int work_pool_detach(WorkStrand *strand) {
+    pthread_mutex_lock(&strand->mutex);
+    int deferred = strand->scheduled || strand->holds > 0;
+    if (deferred) strand->release = 1;
+    pthread_mutex_unlock(&strand->mutex);
+    return deferred;
+}
+
+// 세션 참조 시작 함수 - 다른 사용자의 명령이 대상 세션을 다루는 동안 소유 스레드(루프)가 해제하지 않도록 함
+// 해제는 사용자 목록에서 제거된 뒤에만 일어나므로, 사용자 목록 뮤텍스 안에서 찾은 사용자에 호출하면 안전
+void work_pool_hold(WorkStrand *strand) {
+    pthread_mutex_lock(&strand->mutex);
+    strand->holds++;
+    pthread_mutex_unlock(&strand->mutex);
+}
+
+// 세션 참조 끝 함수 - 참조 중에 해제 요청이 있었고 남은 작업도 없으면 여기서 해제
+void work_pool_unhold(WorkStrand *strand) {
+    pthread_mutex_lock(&strand->mutex);
+    strand->holds--;
+    int release = strand->release && strand->holds == 0 && !strand->scheduled;
+    pthread_mutex_unlock(&strand->mutex);
+
+    if (release) destroy_client_session(strand->user);
+}
+
+// 현재 스레드가 작업 스레드인지 확인하는 함수
+int work_pool_in_worker(void) {
+    return t_worker != NULL;
+}
+
+// 전역 저장 스트랜드에 작업 추가 함수 - 실패 시 호출 스레드에서 바로 실행
+void work_pool_persist(WorkFn fn, void *arg) {
+    if (g_work_pool_count == 0 || work_pool_submit(&g_persist_strand, fn, arg) < 0) {
+        fn(arg);
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef WORK_POOL_H
+#define WORK_POOL_H
+
+#include <pthread.h>
+
+// ================== 작업 풀 설정 ===================
+#define WORK_POOL_DEFAULT_WORKERS   4   // 이벤트 루프 모드의 기본 작업 스레드 수 (CHAT_WORK_THREADS로 변경, 0이면 비활성)
+#define WORK_POOL_MAX_WORKERS       64  // 최대 작업 스레드 수
+#define WORK_DEQUE_INIT_CAP         64  // 작업 스레드별 덱 초기 용량
+
+struct User;
+
+// 작업 함수 - 작업 스레드에서 실행, arg 해제는 작업 함수 담당
+typedef void (*WorkFn)(void *arg);
+
+// 작업 항목
+typedef struct WorkJob {
+    struct WorkJob *next;               // 같은 스트랜드의 다음 작업
+    WorkFn fn;                          // 실행할 함수
+    void *arg;                          // 함수 인자
+} WorkJob;
+
+// 스트랜드 - 작업을 넣은 순서대로 한 번에 하나씩 실행 (연결별 패킷 순서 보장)
+typedef struct WorkStrand {
+    pthread_mutex_t mutex;              // 스트랜드 보호용 뮤텍스
+    pthread_cond_t idle;                // 실행 중인 작업이 끝났음을 알림
+    WorkJob *head;                      // 가장 오래된 대기 작업
+    WorkJob *tail;                      // 가장 최근 대기 작업
+    int scheduled;                      // 작업 스레드 덱에 들어있거나 실행 중인지 여부
+    int running;                        // 작업 실행 중 여부
+    int release;                        // 스케줄 중 세션이 해제 요청됨 (마지막 작업 후 작업 스레드가 해제)
+    int holds;                          // 다른 사용자의 명령(강퇴 등)이 세션을 참조 중인 수 (0이 될 때까지 해제 보류)
+    struct User *user;                  // 소유 사용자 (전역 스트랜드면 NULL)
+} WorkStrand;
+
+// 작업 스레드별 덱 - 소유 스레드는 아래쪽에서, 다른 스레드는 위쪽에서 훔쳐감
+typedef struct WorkDeque {
+    pthread_mutex_t mutex;              // 덱 보호용 뮤텍스
+    WorkStrand **items;                 // 원형 배열
+    size_t cap;                         // 용량 (2의 거듭제곱)
+    size_t top;                         // 훔쳐갈 위치
+    size_t bottom;                      // 소유 스레드가 넣고 꺼내는 위치
+} WorkDeque;
+
+// ================== 전역 변수 ===================
+extern int g_work_pool_count;           // 작업 스레드 수 (0: 비활성, 모든 처리를 I/O 스레드에서 수행)
+
+// ================== 함수 프로토타입 ===================
+int work_pool_init(int worker_count);                   // 작업 스레드 생성 - 실패 시 -1 반환
+void work_strand_init(WorkStrand *strand, struct User *user); // 스트랜드 초기화
+void work_strand_destroy(WorkStrand *strand);           // 스트랜드 정리 (대기 작업이 없을 때 호출)
+int work_pool_submit(WorkStrand *strand, WorkFn fn, void *arg); // 스트랜드에 작업 추가 - 실패 시 -1 반환
+int work_pool_strand_busy(WorkStrand *strand);          // 대기/실행 중인 작업이 있는지 여부
+void work_pool_wait_idle(WorkStrand *strand);           // 실행 중인 작업이 끝날 때까지 대기 (같은 스트랜드의 작업 안에서는 바로 반환)
+int work_pool_detach(WorkStrand *strand);               // 세션 해제 요청 - 스케줄 중이거나 참조 중이면 1 (나중에 해제), 아니면 0
+void work_pool_hold(WorkStrand *strand);                // 세션 참조 시작 - 사용자 목록 뮤텍스 안에서 찾은 사용자에 호출
+void work_pool_unhold(WorkStrand *strand);              // 세션 참조 끝 - 그 사이 해제 요청이 있었으면 여기서 해제
+int work_pool_in_worker(void);                          // 현재 스레드가 작업 스레드인지 여부
+void work_pool_persist(WorkFn fn, void *arg);           // 전역 저장 스트랜드에 작업 추가 (채팅 메시지 저장 순서 유지)
+
+#endif // WORK_POOL_H